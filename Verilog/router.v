@@ -24,7 +24,9 @@ module router #(
     parameter ROUTING_TABLE_FILE = "fpga_config_routing.hex",  // hex格式文件
     parameter MAX_ENTRIES = 64,
     parameter MY_SWITCH_ID = 1,  // 本交换机ID
-    parameter MEM_SIZE = 1024    // ROM大小（字数）
+    parameter MEM_SIZE = 1024,   // ROM大小（字数）
+    parameter MASKED_MATCH = 0,  // 1 = 使用 router_searcher_masked（路由表由 --compress 生成）
+    parameter HASH_BUCKETS = 0   // 非0 = 使用 router_searcher_hash，须与 --hash-buckets 相同（2的幂），此时忽略 MAX_ENTRIES
 )(
     input  wire         clk,
     input  wire         rst_n,
@@ -51,18 +53,44 @@ module router #(
     output wire         init_error
 );
 
+// 哈希查找表固定 2*HASH_BUCKETS+1 条；条目地址位宽随表大小加宽（至少6位）
+localparam TABLE_ENTRIES = HASH_BUCKETS ? 2 * HASH_BUCKETS + 1 : MAX_ENTRIES;
+localparam ADDR_WIDTH    = (TABLE_ENTRIES > 64) ? $clog2(TABLE_ENTRIES) : 6;
+localparam BUCKET_BITS   = (HASH_BUCKETS > 1) ? $clog2(HASH_BUCKETS) : 1;
+
 // ============ ROM模块（存储二进制文件） ============
 reg [31:0] routing_table_rom [0:MEM_SIZE-1];
 
 // 使用$readmemh加载二进制文件（hex格式）
+// 仿真时可用 +routing_table=<文件> 和 +switch_id=<ID> 覆盖参数，
+// 同一个编译好的模型（如 make sim）可以加载任意生成的镜像、扮演任意交换机；综合时只用参数
 integer rom_i;
+`ifdef SYNTHESIS
+wire [3:0]      target_switch_id = MY_SWITCH_ID[3:0];
+`else
+reg [3:0]       target_switch_id;
+reg [8*256-1:0] rom_file;
+integer         plusarg_switch_id;
+`endif
 initial begin
     // 初始化ROM为0（防止X/Z）
     for (rom_i = 0; rom_i < MEM_SIZE; rom_i = rom_i + 1) begin
         routing_table_rom[rom_i] = 32'h0;
     end
 
+`ifdef SYNTHESIS
     $readmemh(ROUTING_TABLE_FILE, routing_table_rom);
+`else
+    rom_file = ROUTING_TABLE_FILE;
+    target_switch_id = MY_SWITCH_ID[3:0];
+    if ($value$plusargs("routing_table=%s", rom_file)) begin
+        $display("[ROM] 路由表文件: %0s", rom_file);
+    end
+    if ($value$plusargs("switch_id=%d", plusarg_switch_id)) begin
+        target_switch_id = plusarg_switch_id[3:0];
+    end
+    $readmemh(rom_file, routing_table_rom);
+`endif
 end
 
 // Memory读取接口
@@ -105,12 +133,12 @@ reg        start_read;
 wire        reader_done;
 wire        reader_error;
 wire [255:0] reader_entry_data;
-wire [5:0]   reader_entry_addr;
+wire [ADDR_WIDTH-1:0] reader_entry_addr;
 wire         reader_entry_valid;
 
 // Routing engine初始化信号
 reg [255:0] engine_init_data;
-reg [5:0]   engine_init_addr;
+reg [ADDR_WIDTH-1:0] engine_init_addr;
 reg         engine_init_wr;
 
 // 初始化延迟计数器
@@ -189,7 +217,8 @@ end
 
 // ============ 实例化Table Reader ============
 router_reader #(
-    .MAX_ENTRIES(MAX_ENTRIES)
+    .MAX_ENTRIES(TABLE_ENTRIES),
+    .ADDR_WIDTH(ADDR_WIDTH)
 ) table_reader_inst (
     .clk(clk),
     .rst_n(rst_n),
@@ -200,7 +229,7 @@ router_reader #(
 
     // 控制接口
     .start_read(start_read),
-    .target_switch_id(MY_SWITCH_ID[3:0]),
+    .target_switch_id(target_switch_id),
     .read_done(reader_done),
     .read_error(reader_error),
 
@@ -211,36 +240,109 @@ router_reader #(
 );
 
 // ============ 实例化Routing Engine ============
-router_searcher #(
-    .MAX_ENTRIES(MAX_ENTRIES),
-    .ENTRY_WIDTH(256),
-    .IP_WIDTH(32)
-) routing_engine_inst (
-    .clk(clk),
-    .rst_n(rst_n),
-
-    // 初始化接口
-    .init_mode(init_mode),
-    .init_entry_data(engine_init_data),
-    .init_entry_addr(engine_init_addr),
-    .init_entry_wr(engine_init_wr),
-
-    // 查找接口
-    .lookup_valid(lookup_valid),
-    .lookup_dst_ip(lookup_dst_ip),
-
-    // 响应接口
-    .resp_valid(resp_valid),
-    .resp_found(resp_found),
-    .resp_out_port(resp_out_port),
-    .resp_out_qp(resp_out_qp),
-    .resp_next_hop_ip(resp_next_hop_ip),
-    .resp_next_hop_port(resp_next_hop_port),
-    .resp_next_hop_qp(resp_next_hop_qp),
-    .resp_next_hop_mac(resp_next_hop_mac),
-    .resp_is_direct_host(resp_is_direct_host),
-    .resp_is_broadcast(resp_is_broadcast),
-    .resp_is_default_route(resp_is_default_route)  // 新增
-);
+// MASKED_MATCH=1 时按 (ip & mask) 匹配前缀聚合后的条目
+// HASH_BUCKETS 非0时按两路哈希在BRAM中查找，不使用CAM
+generate
+if (HASH_BUCKETS) begin: hash_engine
+    router_searcher_hash #(
+        .BUCKET_BITS(BUCKET_BITS),
+        .ENTRY_WIDTH(256),
+        .IP_WIDTH(32),
+        .ADDR_WIDTH(ADDR_WIDTH)
+    ) routing_engine_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+
+        // 初始化接口
+        .init_mode(init_mode),
+        .init_entry_data(engine_init_data),
+        .init_entry_addr(engine_init_addr),
+        .init_entry_wr(engine_init_wr),
+
+        // 查找接口
+        .lookup_valid(lookup_valid),
+        .lookup_dst_ip(lookup_dst_ip),
+
+        // 响应接口
+        .resp_valid(resp_valid),
+        .resp_found(resp_found),
+        .resp_out_port(resp_out_port),
+        .resp_out_qp(resp_out_qp),
+        .resp_next_hop_ip(resp_next_hop_ip),
+        .resp_next_hop_port(resp_next_hop_port),
+        .resp_next_hop_qp(resp_next_hop_qp),
+        .resp_next_hop_mac(resp_next_hop_mac),
+        .resp_is_direct_host(resp_is_direct_host),
+        .resp_is_broadcast(resp_is_broadcast),
+        .resp_is_default_route(resp_is_default_route)
+    );
+end else if (MASKED_MATCH) begin: masked_engine
+    router_searcher_masked #(
+        .MAX_ENTRIES(MAX_ENTRIES),
+        .ENTRY_WIDTH(256),
+        .IP_WIDTH(32),
+        .ADDR_WIDTH(ADDR_WIDTH)
+    ) routing_engine_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+
+        // 初始化接口
+        .init_mode(init_mode),
+        .init_entry_data(engine_init_data),
+        .init_entry_addr(engine_init_addr),
+        .init_entry_wr(engine_init_wr),
+
+        // 查找接口
+        .lookup_valid(lookup_valid),
+        .lookup_dst_ip(lookup_dst_ip),
+
+        // 响应接口
+        .resp_valid(resp_valid),
+        .resp_found(resp_found),
+        .resp_out_port(resp_out_port),
+        .resp_out_qp(resp_out_qp),
+        .resp_next_hop_ip(resp_next_hop_ip),
+        .resp_next_hop_port(resp_next_hop_port),
+        .resp_next_hop_qp(resp_next_hop_qp),
+        .resp_next_hop_mac(resp_next_hop_mac),
+        .resp_is_direct_host(resp_is_direct_host),
+        .resp_is_broadcast(resp_is_broadcast),
+        .resp_is_default_route(resp_is_default_route)  // 新增
+    );
+end else begin: exact_engine
+    router_searcher #(
+        .MAX_ENTRIES(MAX_ENTRIES),
+        .ENTRY_WIDTH(256),
+        .IP_WIDTH(32),
+        .ADDR_WIDTH(ADDR_WIDTH)
+    ) routing_engine_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+
+        // 初始化接口
+        .init_mode(init_mode),
+        .init_entry_data(engine_init_data),
+        .init_entry_addr(engine_init_addr),
+        .init_entry_wr(engine_init_wr),
+
+        // 查找接口
+        .lookup_valid(lookup_valid),
+        .lookup_dst_ip(lookup_dst_ip),
+
+        // 响应接口
+        .resp_valid(resp_valid),
+        .resp_found(resp_found),
+        .resp_out_port(resp_out_port),
+        .resp_out_qp(resp_out_qp),
+        .resp_next_hop_ip(resp_next_hop_ip),
+        .resp_next_hop_port(resp_next_hop_port),
+        .resp_next_hop_qp(resp_next_hop_qp),
+        .resp_next_hop_mac(resp_next_hop_mac),
+        .resp_is_direct_host(resp_is_direct_host),
+        .resp_is_broadcast(resp_is_broadcast),
+        .resp_is_default_route(resp_is_default_route)  // 新增
+    );
+end
+endgenerate
 
 endmodule
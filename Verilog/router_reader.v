@@ -21,7 +21,8 @@
 
 
 module router_reader #(
-    parameter MAX_ENTRIES = 64
+    parameter MAX_ENTRIES = 64,
+    parameter ADDR_WIDTH = 6           // 条目地址位宽，需满足 2^ADDR_WIDTH >= MAX_ENTRIES
 )(
     input  wire         clk,
     input  wire         rst_n,
@@ -38,10 +39,17 @@ module router_reader #(
 
     // 输出到routing engine的初始化接口
     output reg [255:0]  entry_data,
-    output reg [5:0]    entry_addr,
+    output reg [ADDR_WIDTH-1:0] entry_addr,
     output reg          entry_valid
 );
 
+// 镜像格式
+// v1: 连续的 DEST 表（表头 + 条目），按顺序扫描并跳过非目标表
+// v2: 文件开头为镜像头(magic "DIX2") + 目录记录(switch_id, offset, entry_count, crc32)，
+//     只扫描目录，然后直接跳转到目标表，并校验条目区CRC32
+localparam DEST_MAGIC       = 32'h44455354;  // "DEST"
+localparam IMAGE_MAGIC      = 32'h32584944;  // "DIX2"
+
 // 状态机
 localparam IDLE             = 4'd0;
 localparam READ_HEADER      = 4'd1;
@@ -53,6 +61,9 @@ localparam PARSE_ENTRY      = 4'd6;
 localparam SKIP_TABLE       = 4'd7;
 localparam DONE             = 4'd8;
 localparam ERROR            = 4'd9;
+localparam READ_DIR         = 4'd10;
+localparam WAIT_DIR         = 4'd11;
+localparam CHECK_DIR        = 4'd12;
 
 reg [3:0] state;
 
@@ -66,7 +77,7 @@ reg [31:0] reserved;
 reg [31:0] entry_buffer [0:7];
 
 // 计数器
-reg [5:0]  entry_idx;      // 当前处理的entry索引
+reg [ADDR_WIDTH:0] entry_idx;  // 当前处理的entry索引（多1位，MAX_ENTRIES = 2^ADDR_WIDTH 时不回绕）
 reg [3:0]  word_idx;       // Entry内的字索引（0-8，需要能表示8）
 reg [31:0] skip_count;     // 跳过计数
 
@@ -76,6 +87,36 @@ reg target_found;
 // Header读取字计数（Header = 16字节 = 4个字）
 reg [1:0] header_word_idx;
 
+// v2目录
+reg        at_image_start;  // 当前Header位于镜像起始处（用于识别v2镜像头）
+reg [31:0] dir_remaining;   // 剩余未检查的目录记录数
+reg [1:0]  dir_word_idx;
+reg [31:0] rec_switch_id;
+reg [31:0] rec_offset;
+reg [31:0] rec_entry_count;
+reg [31:0] rec_crc;
+
+// 条目区CRC32校验（仅v2）
+reg        crc_check_en;
+reg [31:0] crc_expected;
+reg [31:0] crc_acc;
+
+// CRC32（反射多项式0xEDB88320），按小端字节序逐位处理一个32位字
+// 与C端 crc32_update 对同一字节流的结果一致
+function [31:0] crc32_word;
+    input [31:0] crc;
+    input [31:0] data;
+    integer b;
+    reg [31:0] c;
+    begin
+        c = crc;
+        for (b = 0; b < 32; b = b + 1) begin
+            c = (c[0] ^ data[b]) ? ((c >> 1) ^ 32'hEDB88320) : (c >> 1);
+        end
+        crc32_word = c;
+    end
+endfunction
+
 // 初始化
 initial begin
     state = IDLE;
@@ -94,11 +135,17 @@ always @(posedge clk or negedge rst_n) begin
         read_error <= 1'b0;
         entry_valid <= 1'b0;
         target_found <= 1'b0;
-        entry_idx <= 6'd0;
+        entry_idx <= {(ADDR_WIDTH+1){1'b0}};
         word_idx <= 4'd0;
         header_word_idx <= 2'd0;
         mem_addr <= 32'h0;
         skip_count <= 32'd0;
+        at_image_start <= 1'b0;
+        dir_remaining <= 32'd0;
+        dir_word_idx <= 2'd0;
+        crc_check_en <= 1'b0;
+        crc_expected <= 32'h0;
+        crc_acc <= 32'hFFFFFFFF;
     end else begin
         case (state)
             IDLE: begin
@@ -108,6 +155,8 @@ always @(posedge clk or negedge rst_n) begin
                     mem_addr <= 32'h0;
                     header_word_idx <= 2'd0;
                     target_found <= 1'b0;
+                    at_image_start <= 1'b1;
+                    crc_check_en <= 1'b0;
                 end
             end
 
@@ -142,8 +191,22 @@ always @(posedge clk or negedge rst_n) begin
             end
 
             CHECK_HEADER: begin
+                at_image_start <= 1'b0;
+
                 // 检查Magic
-                if (magic != 32'h44455354) begin  // "DEST"
+                if (at_image_start && magic == IMAGE_MAGIC) begin
+                    // v2镜像头: entry_count=版本, switch_id=目录记录数, reserved=目录CRC
+                    // mem_addr 已指向第一条目录记录
+                    if (switch_id == 32'd0) begin
+                        $display("[ERROR] v2镜像目录为空!");
+                        state <= ERROR;
+                        read_error <= 1'b1;
+                    end else begin
+                        dir_remaining <= switch_id;
+                        dir_word_idx <= 2'd0;
+                        state <= READ_DIR;
+                    end
+                end else if (magic != DEST_MAGIC) begin
                     if (target_found) begin
                         // 已找到目标表，当前表无效Magic，说明已读完
                         state <= DONE;
@@ -155,9 +218,15 @@ always @(posedge clk or negedge rst_n) begin
                 end else if (switch_id == target_switch_id) begin
                     // 找到目标Switch的表
                     target_found <= 1'b1;
-                    entry_idx <= 6'd0;
+                    entry_idx <= {(ADDR_WIDTH+1){1'b0}};
                     word_idx <= 4'd0;
+                    crc_acc <= 32'hFFFFFFFF;
                     state <= READ_ENTRY;
+                end else if (crc_check_en) begin
+                    // v2目录指向的表ID不符，镜像损坏
+                    $display("[ERROR] 目录偏移处的表ID不匹配!");
+                    state <= ERROR;
+                    read_error <= 1'b1;
                 end else begin
                     // 跳过此表
                     skip_count <= entry_count * 8;  // 每个Entry 8个字
@@ -178,13 +247,21 @@ always @(posedge clk or negedge rst_n) begin
                         // ROM同步读：跳过第一个周期（word_idx=0时ROM还没准备好数据）
                         if (word_idx > 0) begin
                             entry_buffer[word_idx-1] <= mem_data;
+                            crc_acc <= crc32_word(crc_acc, mem_data);
                         end
                     end else begin
                         // 读取最后一个字（word_idx=8时读取word[7]的数据）
                         // 此时mem_addr已经指向下一个Entry的起始位置，不再推进
                         entry_buffer[7] <= mem_data;
+                        crc_acc <= crc32_word(crc_acc, mem_data);
                         state <= PARSE_ENTRY;
                     end
+                end else if (crc_check_en && entry_count <= MAX_ENTRIES &&
+                             (crc_acc ^ 32'hFFFFFFFF) != crc_expected) begin
+                    // v2: 完整读取的表CRC不符
+                    $display("[ERROR] 路由表CRC校验失败!");
+                    state <= ERROR;
+                    read_error <= 1'b1;
                 end else begin
                     // 所有Entry加载完成
                     state <= DONE;
@@ -213,7 +290,7 @@ always @(posedge clk or negedge rst_n) begin
                     entry_buffer[1],  // [63:32]
                     entry_buffer[0]   // [31:0]
                 };
-                entry_addr <= entry_idx;
+                entry_addr <= entry_idx[ADDR_WIDTH-1:0];
                 entry_valid <= 1'b1;
 
                 entry_idx <= entry_idx + 1;
@@ -234,6 +311,42 @@ always @(posedge clk or negedge rst_n) begin
                 end
             end
 
+            READ_DIR: begin
+                // 发出目录记录字地址，等待下一周期数据有效
+                state <= WAIT_DIR;
+            end
+
+            WAIT_DIR: begin
+                mem_addr <= mem_addr + 4;
+                dir_word_idx <= dir_word_idx + 1;
+                case (dir_word_idx)
+                    2'd0: begin rec_switch_id   <= mem_data; state <= READ_DIR; end
+                    2'd1: begin rec_offset      <= mem_data; state <= READ_DIR; end
+                    2'd2: begin rec_entry_count <= mem_data; state <= READ_DIR; end
+                    2'd3: begin rec_crc         <= mem_data; state <= CHECK_DIR; end
+                endcase
+            end
+
+            CHECK_DIR: begin
+                if (rec_switch_id == target_switch_id) begin
+                    // 直接跳转到目标表的DEST表头
+                    mem_addr <= rec_offset;
+                    header_word_idx <= 2'd0;
+                    crc_check_en <= 1'b1;
+                    crc_expected <= rec_crc;
+                    state <= READ_HEADER;
+                end else if (dir_remaining == 32'd1) begin
+                    $display("[ERROR] v2镜像目录中没有目标Switch!");
+                    state <= ERROR;
+                    read_error <= 1'b1;
+                end else begin
+                    // 检查下一条记录（mem_addr 已指向其起始位置）
+                    dir_remaining <= dir_remaining - 1;
+                    dir_word_idx <= 2'd0;
+                    state <= READ_DIR;
+                end
+            end
+
             DONE: begin
                 entry_valid <= 1'b0;
                 read_done <= 1'b1;
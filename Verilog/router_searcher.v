@@ -23,7 +23,8 @@
 module router_searcher #(
     parameter MAX_ENTRIES = 64,        // 最大路由表条目数
     parameter ENTRY_WIDTH = 256,       // Entry宽度（32字节=256位）
-    parameter IP_WIDTH = 32            // IP地址宽度
+    parameter IP_WIDTH = 32,           // IP地址宽度
+    parameter ADDR_WIDTH = 6           // 条目地址位宽，需满足 2^ADDR_WIDTH >= MAX_ENTRIES
 )(
     input  wire                     clk,
     input  wire                     rst_n,
@@ -31,7 +32,7 @@ module router_searcher #(
     // 初始化接口
     input  wire                     init_mode,
     input  wire [ENTRY_WIDTH-1:0]   init_entry_data,
-    input  wire [5:0]               init_entry_addr,
+    input  wire [ADDR_WIDTH-1:0]    init_entry_addr,
     input  wire                     init_entry_wr,
 
     // 查找接口
@@ -55,7 +56,7 @@ module router_searcher #(
 // ============ 存储模块 ============
 
 // 默认路由支持
-reg [5:0]  default_route_addr;  // 默认路由条目地址
+reg [ADDR_WIDTH-1:0] default_route_addr;  // 默认路由条目地址
 reg        default_route_valid; // 是否存在默认路由
 
 // IP键数组
@@ -72,7 +73,7 @@ integer i;
 always @(posedge clk or negedge rst_n) begin
     if (!rst_n) begin
         default_route_valid <= 1'b0;
-        default_route_addr <= 6'd0;
+        default_route_addr <= {ADDR_WIDTH{1'b0}};
         for (i = 0; i < MAX_ENTRIES; i = i + 1) begin
             key_valid[i] <= 1'b0;
             ip_keys[i] <= 32'h0;
@@ -89,7 +90,11 @@ always @(posedge clk or negedge rst_n) begin
             key_valid[init_entry_addr] <= 1'b0;
             ip_keys[init_entry_addr] <= 32'h0;
         end else begin
-            // 正常条目：写入IP键和完整Entry
+            // 正常条目（或增量更新的失效写）：写入IP键和完整Entry
+            // 覆盖了默认路由所在地址时，默认路由随之失效
+            if (default_route_valid && init_entry_addr == default_route_addr) begin
+                default_route_valid <= 1'b0;
+            end
             ip_keys[init_entry_addr] <= init_entry_data[31:0];  // dst_ip在[31:0]
             key_valid[init_entry_addr] <= init_entry_data[32];  // valid位在[32]
             dest_table[init_entry_addr] <= init_entry_data;
@@ -109,31 +114,31 @@ generate
 endgenerate
 
 // 优先编码器（One-hot → Binary index）
-reg [5:0] match_idx;
+reg [ADDR_WIDTH-1:0] match_idx;
 reg       match_found;
 integer j;
 always @(*) begin
     match_found = 1'b0;
-    match_idx = 6'd0;
+    match_idx = {ADDR_WIDTH{1'b0}};
 
     for (j = 0; j < MAX_ENTRIES; j = j + 1) begin
         if (match_vector[j]) begin
             match_found = 1'b1;
-            match_idx = j[5:0];
+            match_idx = j[ADDR_WIDTH-1:0];
         end
     end
 end
 
 // Stage 1寄存器
 reg        lookup_valid_s1;
-reg [5:0]  match_idx_s1;
+reg [ADDR_WIDTH-1:0] match_idx_s1;
 reg        match_found_s1;
 reg        use_default_route_s1;  // 新增：是否使用默认路由
 
 always @(posedge clk or negedge rst_n) begin
     if (!rst_n) begin
         lookup_valid_s1 <= 1'b0;
-        match_idx_s1 <= 6'd0;
+        match_idx_s1 <= {ADDR_WIDTH{1'b0}};
         match_found_s1 <= 1'b0;
         use_default_route_s1 <= 1'b0;
     end else begin
@@ -151,7 +156,7 @@ always @(posedge clk or negedge rst_n) begin
             match_found_s1 <= 1'b1;
             use_default_route_s1 <= 1'b1;
         end else begin
-            match_idx_s1 <= 6'd0;
+            match_idx_s1 <= {ADDR_WIDTH{1'b0}};
             match_found_s1 <= 1'b0;
             use_default_route_s1 <= 1'b0;
         end
@@ -0,0 +1,234 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date: 2026/10/16 14:05:21
+// Design Name:
+// Module Name: router_searcher_hash
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: 两路cuckoo哈希查找引擎（yaml2fpga --hash-buckets 生成的路由表）
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   与 router_searcher 接口和3周期延迟相同，但不使用CAM：条目按桶存放在两块BRAM中，
+//   每次查询两路各读一个桶，LUT用量与条目数无关。
+//   表地址布局（由生成器离线排布）：
+//     [0, BUCKETS)            第0路，地址 = 桶号
+//     [BUCKETS, 2*BUCKETS)    第1路，地址 = BUCKETS + 桶号
+//     2*BUCKETS               默认路由
+//   桶号 = (dst_ip * 乘数) 的高 BUCKET_BITS 位，乘数与C端 HASH_MULT_WAY0/1 一致
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module router_searcher_hash #(
+    parameter BUCKET_BITS = 10,            // 每路 2^BUCKET_BITS 个桶（对应 --hash-buckets）
+    parameter ENTRY_WIDTH = 256,           // Entry宽度（32字节=256位）
+    parameter IP_WIDTH = 32,               // IP地址宽度
+    parameter ADDR_WIDTH = BUCKET_BITS + 2 // 条目地址位宽（表共 2*2^BUCKET_BITS+1 条）
+)(
+    input  wire                     clk,
+    input  wire                     rst_n,
+
+    // 初始化接口
+    input  wire                     init_mode,
+    input  wire [ENTRY_WIDTH-1:0]   init_entry_data,
+    input  wire [ADDR_WIDTH-1:0]    init_entry_addr,
+    input  wire                     init_entry_wr,
+
+    // 查找接口
+    input  wire                     lookup_valid,
+    input  wire [IP_WIDTH-1:0]      lookup_dst_ip,
+
+    // 响应接口
+    output reg                      resp_valid,
+    output reg                      resp_found,
+    output reg [15:0]               resp_out_port,
+    output reg [15:0]               resp_out_qp,
+    output reg [31:0]               resp_next_hop_ip,
+    output reg [15:0]               resp_next_hop_port,
+    output reg [15:0]               resp_next_hop_qp,
+    output reg [47:0]               resp_next_hop_mac,
+    output reg                      resp_is_direct_host,
+    output reg                      resp_is_broadcast,
+    output reg                      resp_is_default_route
+);
+
+localparam BUCKETS        = 1 << BUCKET_BITS;
+localparam HASH_MULT_WAY0 = 32'h9E3779B1;
+localparam HASH_MULT_WAY1 = 32'h85EBCA77;
+
+// 桶号：乘积的高位（常数乘法，综合时映射到DSP或移位加法）
+function [BUCKET_BITS-1:0] hash_bucket;
+    input [31:0] ip;
+    input [31:0] mult;
+    reg   [31:0] product;
+    begin
+        product = ip * mult;
+        hash_bucket = product[31 -: BUCKET_BITS];
+    end
+endfunction
+
+// ============ 存储模块 ============
+
+// 两路桶，每桶一个完整Entry
+(* ram_style = "block" *)
+reg [ENTRY_WIDTH-1:0] way0_table [0:BUCKETS-1];
+(* ram_style = "block" *)
+reg [ENTRY_WIDTH-1:0] way1_table [0:BUCKETS-1];
+
+// 默认路由不占用桶，单独保存
+reg [ENTRY_WIDTH-1:0] default_entry;
+reg [ADDR_WIDTH-1:0]  default_route_addr;
+reg                   default_route_valid;
+
+// BRAM上电内容为0（空桶），初始化时由reader逐条覆盖
+integer i;
+initial begin
+    for (i = 0; i < BUCKETS; i = i + 1) begin
+        way0_table[i] = {ENTRY_WIDTH{1'b0}};
+        way1_table[i] = {ENTRY_WIDTH{1'b0}};
+    end
+end
+
+// 检查是否为默认路由（dst_ip = 0xFFFFFFFF, is_default_route = 1）
+wire init_is_default = (init_entry_data[31:0] == 32'hFFFFFFFF) && init_entry_data[56];
+wire [ADDR_WIDTH-BUCKET_BITS-1:0] init_way = init_entry_addr[ADDR_WIDTH-1:BUCKET_BITS];
+wire [BUCKET_BITS-1:0]            init_bucket = init_entry_addr[BUCKET_BITS-1:0];
+
+// 桶写入（BRAM写端口不带复位）：默认路由条目写到桶地址时按空桶处理，与CAM中不加入比较一致
+always @(posedge clk) begin
+    if (init_mode && init_entry_wr) begin
+        if (init_way == 0) begin
+            way0_table[init_bucket] <= init_is_default ? {ENTRY_WIDTH{1'b0}} : init_entry_data;
+        end else if (init_way == 1) begin
+            way1_table[init_bucket] <= init_is_default ? {ENTRY_WIDTH{1'b0}} : init_entry_data;
+        end
+    end
+end
+
+// 默认路由寄存器
+always @(posedge clk or negedge rst_n) begin
+    if (!rst_n) begin
+        default_route_valid <= 1'b0;
+        default_route_addr <= {ADDR_WIDTH{1'b0}};
+        default_entry <= {ENTRY_WIDTH{1'b0}};
+    end else if (init_mode && init_entry_wr) begin
+        if (init_is_default) begin
+            default_route_valid <= 1'b1;
+            default_route_addr <= init_entry_addr;
+            default_entry <= init_entry_data;
+        end else if (default_route_valid && init_entry_addr == default_route_addr) begin
+            // 覆盖了默认路由所在地址时，默认路由随之失效
+            default_route_valid <= 1'b0;
+        end
+    end
+end
+
+// ============ Stage 1: 计算两路桶号 ============
+
+reg                    lookup_valid_s1;
+reg [IP_WIDTH-1:0]     lookup_ip_s1;
+reg [BUCKET_BITS-1:0]  bucket0_s1;
+reg [BUCKET_BITS-1:0]  bucket1_s1;
+
+always @(posedge clk or negedge rst_n) begin
+    if (!rst_n) begin
+        lookup_valid_s1 <= 1'b0;
+        lookup_ip_s1 <= {IP_WIDTH{1'b0}};
+        bucket0_s1 <= {BUCKET_BITS{1'b0}};
+        bucket1_s1 <= {BUCKET_BITS{1'b0}};
+    end else begin
+        // 只在非初始化模式时接受新查询
+        lookup_valid_s1 <= (!init_mode) ? lookup_valid : 1'b0;
+        lookup_ip_s1 <= lookup_dst_ip;
+        bucket0_s1 <= hash_bucket(lookup_dst_ip, HASH_MULT_WAY0);
+        bucket1_s1 <= hash_bucket(lookup_dst_ip, HASH_MULT_WAY1);
+    end
+end
+
+// ============ Stage 2: 两路BRAM并行读取 ============
+
+reg [ENTRY_WIDTH-1:0] way0_data_s2;
+reg [ENTRY_WIDTH-1:0] way1_data_s2;
+
+always @(posedge clk) begin
+    way0_data_s2 <= way0_table[bucket0_s1];
+    way1_data_s2 <= way1_table[bucket1_s1];
+end
+
+// Stage 2 流水线寄存器
+reg                lookup_valid_s2;
+reg [IP_WIDTH-1:0] lookup_ip_s2;
+
+always @(posedge clk or negedge rst_n) begin
+    if (!rst_n) begin
+        lookup_valid_s2 <= 1'b0;
+        lookup_ip_s2 <= {IP_WIDTH{1'b0}};
+    end else begin
+        // 流水线传递，不受init_mode影响
+        lookup_valid_s2 <= lookup_valid_s1;
+        lookup_ip_s2 <= lookup_ip_s1;
+    end
+end
+
+// ============ Stage 3: 比较键、选择并输出 ============
+
+// valid位在[32]，dst_ip在[31:0]；生成器保证同一键只在一个桶中出现，
+// 两路同时命中（手工构造的表）时取第1路，即地址较大者，与优先编码器一致
+wire way0_hit = way0_data_s2[32] && (way0_data_s2[31:0] == lookup_ip_s2);
+wire way1_hit = way1_data_s2[32] && (way1_data_s2[31:0] == lookup_ip_s2);
+wire [ENTRY_WIDTH-1:0] hit_entry = way1_hit ? way1_data_s2 :
+                                   way0_hit ? way0_data_s2 : default_entry;
+wire use_default_route = !way0_hit && !way1_hit;
+wire match_found = way0_hit || way1_hit || default_route_valid;
+
+always @(posedge clk or negedge rst_n) begin
+    if (!rst_n) begin
+        resp_valid <= 1'b0;
+        resp_found <= 1'b0;
+        resp_out_port <= 16'h0;
+        resp_out_qp <= 16'h0;
+        resp_next_hop_ip <= 32'h0;
+        resp_next_hop_port <= 16'h0;
+        resp_next_hop_qp <= 16'h0;
+        resp_next_hop_mac <= 48'h0;
+        resp_is_direct_host <= 1'b0;
+        resp_is_broadcast <= 1'b0;
+        resp_is_default_route <= 1'b0;
+    end else begin
+        // 只在非初始化模式时输出有效结果
+        resp_valid <= lookup_valid_s2 && !init_mode;
+        resp_found <= match_found;
+
+        if (match_found) begin
+            // 解析Entry字段（根据fpga_dest_entry_t结构，小端序）
+            resp_out_port       <= hit_entry[79:64];
+            resp_out_qp         <= hit_entry[95:80];
+            resp_next_hop_ip    <= hit_entry[127:96];
+            resp_next_hop_port  <= hit_entry[143:128];
+            resp_next_hop_qp    <= hit_entry[159:144];
+            resp_next_hop_mac   <= hit_entry[207:160];
+            resp_is_direct_host <= hit_entry[40];
+            resp_is_broadcast   <= hit_entry[48];
+            resp_is_default_route <= use_default_route;
+        end else begin
+            resp_out_port       <= 16'h0;
+            resp_out_qp         <= 16'h0;
+            resp_next_hop_ip    <= 32'h0;
+            resp_next_hop_port  <= 16'h0;
+            resp_next_hop_qp    <= 16'h0;
+            resp_next_hop_mac   <= 48'h0;
+            resp_is_direct_host <= 1'b0;
+            resp_is_broadcast   <= 1'b0;
+            resp_is_default_route <= 1'b0;
+        end
+    end
+end
+
+endmodule
@@ -0,0 +1,350 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: tb_router_delta
+// Description: 增量更新流（--delta）的在线打补丁测试
+//
+//   1. 从旧镜像中取出 TEST_SWITCH_ID 的路由表，经 init 写端口写入 router_searcher
+//   2. 按增量更新流中该交换机的写记录逐条打补丁（每条记录一个写周期）
+//   3. 用新镜像中的路由表校验查找结果：新表中的每个目的地都应命中对应条目，
+//      旧表中已删除的目的地应回落到默认路由（无默认路由时查找失败）
+//
+// 生成测试文件（--prev-image 需为二进制镜像，v1/v2均可）:
+//   ./bin/yaml2fpga old.yaml old.bin
+//   ./bin/yaml2fpga --format=hex old.yaml fpga_routing_old.hex
+//   ./bin/yaml2fpga --format=hex --prev-image old.bin --delta fpga_routing.delta.hex \
+//                   new.yaml fpga_routing_new.hex
+// make vtest 用 tests/delta.sh 生成这些文件，并对根、中间层和叶交换机各运行一次
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module tb_router_delta;
+
+parameter TEST_SWITCH_ID = 2;
+parameter MAX_ENTRIES = 64;
+parameter MEM_SIZE = 4096;                          // 每个文件最多读取的字数
+parameter BASE_FILE = "fpga_routing_old.hex";
+parameter NEW_FILE = "fpga_routing_new.hex";
+parameter DELTA_FILE = "fpga_routing.delta.hex";
+
+localparam DEST_MAGIC  = 32'h44455354;               // "DEST"
+localparam IMAGE_MAGIC = 32'h32584944;               // "DIX2"
+localparam DELTA_MAGIC = 32'h41544C44;               // "DLTA"
+localparam DELTA_INVALIDATE = 32'h1;
+
+// 时钟和复位
+reg clk;
+reg rst_n;
+
+parameter CLK_PERIOD = 10;
+initial begin
+    clk = 0;
+    forever #(CLK_PERIOD/2) clk = ~clk;
+end
+
+// searcher 接口
+reg          init_mode;
+reg  [255:0] init_entry_data;
+reg  [5:0]   init_entry_addr;
+reg          init_entry_wr;
+reg          lookup_valid;
+reg  [31:0]  lookup_dst_ip;
+
+wire         resp_valid;
+wire         resp_found;
+wire [15:0]  resp_out_port;
+wire [15:0]  resp_out_qp;
+wire [31:0]  resp_next_hop_ip;
+wire [15:0]  resp_next_hop_port;
+wire [15:0]  resp_next_hop_qp;
+wire [47:0]  resp_next_hop_mac;
+wire         resp_is_direct_host;
+wire         resp_is_broadcast;
+wire         resp_is_default_route;
+
+router_searcher #(
+    .MAX_ENTRIES(MAX_ENTRIES)
+) dut (
+    .clk(clk),
+    .rst_n(rst_n),
+    .init_mode(init_mode),
+    .init_entry_data(init_entry_data),
+    .init_entry_addr(init_entry_addr),
+    .init_entry_wr(init_entry_wr),
+    .lookup_valid(lookup_valid),
+    .lookup_dst_ip(lookup_dst_ip),
+    .resp_valid(resp_valid),
+    .resp_found(resp_found),
+    .resp_out_port(resp_out_port),
+    .resp_out_qp(resp_out_qp),
+    .resp_next_hop_ip(resp_next_hop_ip),
+    .resp_next_hop_port(resp_next_hop_port),
+    .resp_next_hop_qp(resp_next_hop_qp),
+    .resp_next_hop_mac(resp_next_hop_mac),
+    .resp_is_direct_host(resp_is_direct_host),
+    .resp_is_broadcast(resp_is_broadcast),
+    .resp_is_default_route(resp_is_default_route)
+);
+
+// ============ 测试文件 ============
+
+reg [31:0] base_mem  [0:MEM_SIZE-1];
+reg [31:0] new_mem   [0:MEM_SIZE-1];
+reg [31:0] delta_mem [0:MEM_SIZE-1];
+
+integer base_table, base_count;                     // DEST表头的字下标和条目数
+integer new_table, new_count;
+integer errors = 0;
+integer write_cycles = 0;
+
+// 在镜像中查找 TEST_SWITCH_ID 的 DEST 表（v1连续表或v2目录）
+// 使用 base_mem/new_mem 的哪一个由 which 选择：0=旧镜像, 1=新镜像
+task find_table;
+    input  integer which;
+    output integer table_word;
+    output integer entry_count;
+    integer pos, k, count;
+    reg [31:0] w0, w1, w2;
+    begin
+        table_word = -1;
+        entry_count = 0;
+        w0 = which ? new_mem[0] : base_mem[0];
+        if (w0 === IMAGE_MAGIC) begin
+            count = which ? new_mem[2] : base_mem[2];
+            for (k = 0; k < count; k = k + 1) begin
+                w1 = which ? new_mem[4 + k*4] : base_mem[4 + k*4];
+                w2 = which ? new_mem[4 + k*4 + 1] : base_mem[4 + k*4 + 1];
+                if (w1 == TEST_SWITCH_ID) begin
+                    table_word = w2 / 4;
+                end
+            end
+        end else begin
+            pos = 0;
+            while (table_word < 0 && pos + 4 <= MEM_SIZE &&
+                   (which ? new_mem[pos] : base_mem[pos]) === DEST_MAGIC) begin
+                w1 = which ? new_mem[pos + 1] : base_mem[pos + 1];
+                w2 = which ? new_mem[pos + 2] : base_mem[pos + 2];
+                if (w2 == TEST_SWITCH_ID) begin
+                    table_word = pos;
+                end else begin
+                    pos = pos + 4 + w1 * 8;
+                end
+            end
+        end
+        if (table_word >= 0) begin
+            entry_count = which ? new_mem[table_word + 1] : base_mem[table_word + 1];
+        end
+    end
+endtask
+
+// 读取第 idx 条目（8个小端字拼成256位，与 router_reader 一致）
+function [255:0] table_entry;
+    input integer which;
+    input integer table_word;
+    input integer idx;
+    integer w, base;
+    begin
+        base = table_word + 4 + idx * 8;
+        for (w = 0; w < 8; w = w + 1) begin
+            table_entry[w*32 +: 32] = which ? new_mem[base + w] : base_mem[base + w];
+        end
+    end
+endfunction
+
+function [255:0] delta_entry;
+    input integer word;
+    integer w;
+    begin
+        for (w = 0; w < 8; w = w + 1) begin
+            delta_entry[w*32 +: 32] = delta_mem[word + w];
+        end
+    end
+endfunction
+
+// ============ 激励 ============
+
+task write_entry;
+    input [5:0]   addr;
+    input [255:0] data;
+    begin
+        @(posedge clk);
+        init_mode <= 1'b1;
+        init_entry_wr <= 1'b1;
+        init_entry_addr <= addr;
+        init_entry_data <= data;
+        @(posedge clk);
+        init_entry_wr <= 1'b0;
+        init_mode <= 1'b0;
+    end
+endtask
+
+// 发起一次查找并等待响应
+task lookup;
+    input [31:0] dst_ip;
+    integer wait_cycles;
+    begin
+        @(posedge clk);
+        lookup_valid <= 1'b1;
+        lookup_dst_ip <= dst_ip;
+        @(posedge clk);
+        lookup_valid <= 1'b0;
+        wait_cycles = 0;
+        while (!resp_valid && wait_cycles < 8) begin
+            @(posedge clk);
+            wait_cycles = wait_cycles + 1;
+        end
+        if (!resp_valid) begin
+            $display("[ERROR] 查找 %h 无响应", dst_ip);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+// 期望命中 expected（is_default 表示经默认路由命中）
+task check_hit;
+    input [31:0]  dst_ip;
+    input [255:0] expected;
+    input         is_default;
+    begin
+        lookup(dst_ip);
+        if (!resp_found || resp_is_default_route != is_default ||
+            resp_out_port != expected[79:64] || resp_out_qp != expected[95:80] ||
+            resp_next_hop_ip != expected[127:96] || resp_next_hop_port != expected[143:128] ||
+            resp_next_hop_qp != expected[159:144] || resp_next_hop_mac != expected[207:160] ||
+            resp_is_direct_host != expected[40] || resp_is_broadcast != expected[48]) begin
+            $display("[ERROR] 查找 %h: found=%b default=%b port=%0d, 期望 default=%b port=%0d",
+                     dst_ip, resp_found, resp_is_default_route, resp_out_port,
+                     is_default, expected[79:64]);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+task check_miss;
+    input [31:0] dst_ip;
+    begin
+        lookup(dst_ip);
+        if (resp_found) begin
+            $display("[ERROR] 查找 %h: 期望查找失败，实际命中端口 %0d", dst_ip, resp_out_port);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+// ============ 主测试流程 ============
+
+integer k, m, pos, seg, sections, writes, seg_found;
+integer default_idx;
+reg [255:0] entry;
+reg [31:0]  addr, flags;
+reg         still_present;
+
+initial begin
+    rst_n = 0;
+    init_mode = 0;
+    init_entry_wr = 0;
+    init_entry_addr = 0;
+    init_entry_data = 0;
+    lookup_valid = 0;
+    lookup_dst_ip = 0;
+
+    $readmemh(BASE_FILE, base_mem);
+    $readmemh(NEW_FILE, new_mem);
+    $readmemh(DELTA_FILE, delta_mem);
+
+    find_table(0, base_table, base_count);
+    find_table(1, new_table, new_count);
+    if (base_table < 0 || new_table < 0) begin
+        $display("[FATAL] 镜像中没有 Switch %0d 的路由表", TEST_SWITCH_ID);
+        $finish;
+    end
+    if (delta_mem[0] !== DELTA_MAGIC) begin
+        $display("[FATAL] %s 不是增量更新流", DELTA_FILE);
+        $finish;
+    end
+
+    #(CLK_PERIOD * 5);
+    rst_n = 1;
+    repeat(2) @(posedge clk);
+
+    // 步骤1: 写入旧路由表（与 router_reader 一样按条目下标写入，空洞也写）
+    for (k = 0; k < base_count && k < MAX_ENTRIES; k = k + 1) begin
+        write_entry(k, table_entry(0, base_table, k));
+    end
+    $display("旧路由表已加载: Switch %0d, %0d 条目", TEST_SWITCH_ID, base_count);
+
+    // 步骤2: 找到本交换机的增量段并逐条打补丁
+    sections = delta_mem[2];
+    pos = 4;
+    seg_found = 0;
+    for (seg = 0; seg < sections; seg = seg + 1) begin
+        writes = delta_mem[pos + 1];
+        if (delta_mem[pos] == TEST_SWITCH_ID) begin
+            seg_found = 1;
+            if (delta_mem[pos + 2] != new_count) begin
+                $display("[ERROR] 增量段条目数 %0d 与新镜像 %0d 不一致", delta_mem[pos + 2], new_count);
+                errors = errors + 1;
+            end
+            for (m = 0; m < writes; m = m + 1) begin
+                addr = delta_mem[pos + 4 + m*10];
+                flags = delta_mem[pos + 4 + m*10 + 1];
+                entry = delta_entry(pos + 4 + m*10 + 2);
+                if ((flags & DELTA_INVALIDATE) && entry != 256'h0) begin
+                    $display("[ERROR] 失效写记录 %0d 的条目不为全0", m);
+                    errors = errors + 1;
+                end
+                write_entry(addr[5:0], entry);
+                write_cycles = write_cycles + 1;
+            end
+        end
+        pos = pos + 4 + writes * 10;
+    end
+    $display("增量更新: %0d 次写入 (完整重载需要 %0d 次)%s", write_cycles, new_count,
+             seg_found ? "" : ", 本交换机无变化");
+
+    // 步骤3: 校验新路由表中的全部目的地
+    default_idx = -1;
+    for (k = 0; k < new_count; k = k + 1) begin
+        entry = table_entry(1, new_table, k);
+        if (entry[32] && entry[31:0] == 32'hFFFFFFFF && entry[56]) begin
+            default_idx = k;
+        end
+    end
+    repeat(2) @(posedge clk);
+
+    for (k = 0; k < new_count; k = k + 1) begin
+        entry = table_entry(1, new_table, k);
+        if (entry[32] && !(entry[31:0] == 32'hFFFFFFFF && entry[56])) begin
+            check_hit(entry[31:0], entry, 1'b0);
+        end
+    end
+
+    // 旧表中已删除的目的地应回落到默认路由
+    for (k = 0; k < base_count; k = k + 1) begin
+        entry = table_entry(0, base_table, k);
+        if (entry[32] && !entry[56]) begin
+            still_present = 1'b0;
+            for (m = 0; m < new_count; m = m + 1) begin
+                if (new_mem[new_table + 4 + m*8 + 1][0] &&
+                    new_mem[new_table + 4 + m*8] == entry[31:0]) begin
+                    still_present = 1'b1;
+                end
+            end
+            if (!still_present) begin
+                if (default_idx >= 0) begin
+                    check_hit(entry[31:0], table_entry(1, new_table, default_idx), 1'b1);
+                end else begin
+                    check_miss(entry[31:0]);
+                end
+            end
+        end
+    end
+
+    if (errors == 0) begin
+        $display("[PASS] Switch %0d 增量更新后查找结果与新镜像一致", TEST_SWITCH_ID);
+    end else begin
+        $display("[FAIL] %0d 处不一致", errors);
+    end
+    $finish;
+end
+
+endmodule
@@ -0,0 +1,271 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: tb_router_hash
+// Description: 哈希查找表（--hash-buckets）的 router_searcher_hash 测试
+//
+//   1. 从哈希镜像中取出 TEST_SWITCH_ID 的路由表（2*BUCKETS+1 条），经 init 写端口写入
+//   2. 按期望文件逐条查找：命中、未命中和回落到默认路由的结果都与C端普通镜像的
+//      y2f_lookup 结果比较
+//   3. 每次查找后比较 DUT 第1级算出的两路桶号与C端 route_hash_bucket 的结果，
+//      确认RTL的 hash_bucket 与生成器排布时使用的哈希一致
+//
+// 生成测试文件（make vtest 自动完成，桶数与 BUCKET_BITS 对应）:
+//   ./bin/test_hash -o 目录
+//   产生 fpga_routing_hash.hex（3层、扇出4、每叶4个Host，--hash-buckets 128）
+//   和 hash_expect_<交换机ID>.hex（Switch 1/4/21），格式见 tests/test_hash.c
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module tb_router_hash;
+
+parameter TEST_SWITCH_ID = 1;
+parameter BUCKET_BITS = 7;                          // 与 test_hash 的 FIXTURE_BUCKETS 对应
+parameter MEM_SIZE = 65536;                         // 镜像文件最多读取的字数
+parameter EXPECT_SIZE = 8192;                       // 期望文件最多读取的字数
+parameter IMAGE_FILE = "fpga_routing_hash.hex";
+
+localparam BUCKETS       = 1 << BUCKET_BITS;
+localparam TABLE_ENTRIES = 2 * BUCKETS + 1;
+localparam ADDR_WIDTH    = BUCKET_BITS + 2;
+localparam DEST_MAGIC    = 32'h44455354;            // "DEST"
+
+// 时钟和复位
+reg clk;
+reg rst_n;
+
+parameter CLK_PERIOD = 10;
+initial begin
+    clk = 0;
+    forever #(CLK_PERIOD/2) clk = ~clk;
+end
+
+// searcher 接口
+reg                   init_mode;
+reg  [255:0]          init_entry_data;
+reg  [ADDR_WIDTH-1:0] init_entry_addr;
+reg                   init_entry_wr;
+reg                   lookup_valid;
+reg  [31:0]           lookup_dst_ip;
+
+wire         resp_valid;
+wire         resp_found;
+wire [15:0]  resp_out_port;
+wire [15:0]  resp_out_qp;
+wire [31:0]  resp_next_hop_ip;
+wire [15:0]  resp_next_hop_port;
+wire [15:0]  resp_next_hop_qp;
+wire [47:0]  resp_next_hop_mac;
+wire         resp_is_direct_host;
+wire         resp_is_broadcast;
+wire         resp_is_default_route;
+
+router_searcher_hash #(
+    .BUCKET_BITS(BUCKET_BITS)
+) dut (
+    .clk(clk),
+    .rst_n(rst_n),
+    .init_mode(init_mode),
+    .init_entry_data(init_entry_data),
+    .init_entry_addr(init_entry_addr),
+    .init_entry_wr(init_entry_wr),
+    .lookup_valid(lookup_valid),
+    .lookup_dst_ip(lookup_dst_ip),
+    .resp_valid(resp_valid),
+    .resp_found(resp_found),
+    .resp_out_port(resp_out_port),
+    .resp_out_qp(resp_out_qp),
+    .resp_next_hop_ip(resp_next_hop_ip),
+    .resp_next_hop_port(resp_next_hop_port),
+    .resp_next_hop_qp(resp_next_hop_qp),
+    .resp_next_hop_mac(resp_next_hop_mac),
+    .resp_is_direct_host(resp_is_direct_host),
+    .resp_is_broadcast(resp_is_broadcast),
+    .resp_is_default_route(resp_is_default_route)
+);
+
+// ============ 测试文件 ============
+
+reg [31:0] image_mem  [0:MEM_SIZE-1];
+reg [31:0] expect_mem [0:EXPECT_SIZE-1];
+reg [8*64-1:0] expect_file;
+
+integer table_word, entry_count;
+integer errors = 0;
+integer hits = 0, defaults = 0, misses = 0;
+
+// 在v1镜像（连续DEST表）中查找 TEST_SWITCH_ID 的表
+task find_table;
+    integer pos;
+    begin
+        table_word = -1;
+        entry_count = 0;
+        pos = 0;
+        while (table_word < 0 && pos + 4 <= MEM_SIZE && image_mem[pos] === DEST_MAGIC) begin
+            if (image_mem[pos + 2] == TEST_SWITCH_ID) begin
+                table_word = pos;
+                entry_count = image_mem[pos + 1];
+            end else begin
+                pos = pos + 4 + image_mem[pos + 1] * 8;
+            end
+        end
+    end
+endtask
+
+// 读取第 idx 条目（8个小端字拼成256位，与 router_reader 一致）
+function [255:0] table_entry;
+    input integer idx;
+    integer w;
+    begin
+        for (w = 0; w < 8; w = w + 1) begin
+            table_entry[w*32 +: 32] = image_mem[table_word + 4 + idx * 8 + w];
+        end
+    end
+endfunction
+
+// ============ 激励 ============
+
+task write_entry;
+    input [ADDR_WIDTH-1:0] addr;
+    input [255:0]          data;
+    begin
+        @(posedge clk);
+        init_mode <= 1'b1;
+        init_entry_wr <= 1'b1;
+        init_entry_addr <= addr;
+        init_entry_data <= data;
+        @(posedge clk);
+        init_entry_wr <= 1'b0;
+        init_mode <= 1'b0;
+    end
+endtask
+
+// 发起一次查找并等待响应；lookup_dst_ip 保持不变，第1级的桶号寄存器随后仍对应本次查询
+task lookup;
+    input [31:0] dst_ip;
+    integer wait_cycles;
+    begin
+        @(posedge clk);
+        lookup_valid <= 1'b1;
+        lookup_dst_ip <= dst_ip;
+        @(posedge clk);
+        lookup_valid <= 1'b0;
+        wait_cycles = 0;
+        while (!resp_valid && wait_cycles < 8) begin
+            @(posedge clk);
+            wait_cycles = wait_cycles + 1;
+        end
+        if (!resp_valid) begin
+            $display("[ERROR] 查找 %h 无响应", dst_ip);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+// 比较期望文件中第 q 条查询（8个字，见 tests/test_hash.c）
+task check_query;
+    input integer q;
+    integer base;
+    reg [31:0] dst_ip, flags, port_qp, next_ip, next_port_qp, mac_lo, mac_hi, buckets;
+    begin
+        base = 1 + q * 8;
+        dst_ip       = expect_mem[base];
+        flags        = expect_mem[base + 1];
+        port_qp      = expect_mem[base + 2];
+        next_ip      = expect_mem[base + 3];
+        next_port_qp = expect_mem[base + 4];
+        mac_lo       = expect_mem[base + 5];
+        mac_hi       = expect_mem[base + 6];
+        buckets      = expect_mem[base + 7];
+
+        lookup(dst_ip);
+
+        if (dut.bucket0_s1 != buckets[BUCKET_BITS-1:0] || dut.bucket1_s1 != buckets[16 +: BUCKET_BITS]) begin
+            $display("[ERROR] %h 的桶号: RTL %0d/%0d, C %0d/%0d", dst_ip,
+                     dut.bucket0_s1, dut.bucket1_s1, buckets[BUCKET_BITS-1:0], buckets[16 +: BUCKET_BITS]);
+            errors = errors + 1;
+        end
+
+        if (resp_found != flags[0]) begin
+            $display("[ERROR] 查找 %h: found=%b, 期望 %b", dst_ip, resp_found, flags[0]);
+            errors = errors + 1;
+        end else if (resp_found &&
+                     (resp_is_default_route != flags[1] || resp_is_direct_host != flags[2] ||
+                      resp_is_broadcast != flags[3] ||
+                      resp_out_port != port_qp[15:0] || resp_out_qp != port_qp[31:16] ||
+                      resp_next_hop_ip != next_ip ||
+                      resp_next_hop_port != next_port_qp[15:0] || resp_next_hop_qp != next_port_qp[31:16] ||
+                      resp_next_hop_mac != {mac_hi[15:0], mac_lo})) begin
+            $display("[ERROR] 查找 %h: default=%b port=%0d next_hop=%h, 期望 default=%b port=%0d next_hop=%h",
+                     dst_ip, resp_is_default_route, resp_out_port, resp_next_hop_ip,
+                     flags[1], port_qp[15:0], next_ip);
+            errors = errors + 1;
+        end
+
+        if (!flags[0]) begin
+            misses = misses + 1;
+        end else if (flags[1]) begin
+            defaults = defaults + 1;
+        end else begin
+            hits = hits + 1;
+        end
+    end
+endtask
+
+// ============ 主测试流程 ============
+
+integer k;
+
+initial begin
+    rst_n = 0;
+    init_mode = 0;
+    init_entry_wr = 0;
+    init_entry_addr = 0;
+    init_entry_data = 0;
+    lookup_valid = 0;
+    lookup_dst_ip = 0;
+
+    $sformat(expect_file, "hash_expect_%0d.hex", TEST_SWITCH_ID);
+    $readmemh(IMAGE_FILE, image_mem);
+    $readmemh(expect_file, expect_mem);
+
+    find_table;
+    if (table_word < 0) begin
+        $display("[FATAL] 镜像中没有 Switch %0d 的路由表", TEST_SWITCH_ID);
+        $finish;
+    end
+    if (entry_count != TABLE_ENTRIES) begin
+        $display("[FATAL] Switch %0d 有 %0d 个条目，BUCKET_BITS=%0d 时应为 %0d",
+                 TEST_SWITCH_ID, entry_count, BUCKET_BITS, TABLE_ENTRIES);
+        $finish;
+    end
+
+    #(CLK_PERIOD * 5);
+    rst_n = 1;
+    repeat(2) @(posedge clk);
+
+    // 步骤1: 按地址写入全部桶和默认路由槽位（空桶也写）
+    for (k = 0; k < entry_count; k = k + 1) begin
+        write_entry(k, table_entry(k));
+    end
+    $display("哈希路由表已加载: Switch %0d, 每路 %0d 个桶", TEST_SWITCH_ID, BUCKETS);
+    repeat(2) @(posedge clk);
+
+    // 步骤2、3: 逐条查询
+    for (k = 0; k < expect_mem[0]; k = k + 1) begin
+        check_query(k);
+    end
+    $display("查询 %0d 次: 命中 %0d, 默认路由 %0d, 未命中 %0d", expect_mem[0], hits, defaults, misses);
+
+    if (hits == 0 || defaults + misses == 0) begin
+        $display("[ERROR] 期望文件没有同时覆盖命中和未命中");
+        errors = errors + 1;
+    end
+    if (errors == 0) begin
+        $display("[PASS] Switch %0d 哈希查找结果与C端一致", TEST_SWITCH_ID);
+    end else begin
+        $display("[FAIL] %0d 处不一致", errors);
+    end
+    $finish;
+end
+
+endmodule
@@ -0,0 +1,198 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include "libyaml2fpga.h"
+#include "topology_gen.h"
+#include <time.h>
+#include <unistd.h>
+
+// ============ 性能基准：路由查找（y2f_lookup / y2f_lookup_batch）============
+// 用法: bench_lookup [-n 查询数] [层数 扇出 每叶Host数]...
+// 为合成拓扑生成镜像后，按交换机分批发送查询（3/4 为拓扑中的目的IP，1/4 为随机地址），
+// 分别统计逐条查找和批量查找的吞吐量，并核对两条路径的结果一致
+
+#define LOOKUP_BATCH 256
+
+static const fat_tree_params_t default_sizes[] = {
+    {2, 2, 5},       // 10 Host
+    {2, 10, 10},     // 100 Host
+    {3, 10, 10},     // 1000 Host
+    {3, 20, 25},     // 10000 Host
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// 生成拓扑并序列化为v1镜像，tables 留给调用者挑选查询地址
+static int build_image(const fat_tree_params_t* params, routing_tables_t* tables,
+                       uint8_t** image, size_t* image_size) {
+    char yaml_path[] = "/tmp/yaml2fpga_bench_XXXXXX";
+    int fd = mkstemp(yaml_path);
+    FILE* yaml = fd >= 0 ? fdopen(fd, "w") : NULL;
+    topology_config_t config;
+    generate_options_t options = {0};
+
+    if (!yaml) {
+        fprintf(stderr, "错误: 无法创建临时拓扑文件\n");
+        return -1;
+    }
+    int result = write_fat_tree_yaml(yaml, params);
+    if (fclose(yaml) != 0 || result != 0 || parse_yaml_topology(yaml_path, &config) != SUCCESS) {
+        unlink(yaml_path);
+        return -1;
+    }
+    unlink(yaml_path);
+
+    if (build_topology_index(&config) != 0 || build_all_routing_tables(&config, &options, tables) != 0) {
+        cleanup_topology(&config);
+        return -1;
+    }
+    cleanup_topology(&config);
+
+    *image_size = routing_image_size(tables, 1);
+    *image = malloc(*image_size ? *image_size : 1);
+    if (!*image) {
+        free_routing_tables(tables);
+        return -1;
+    }
+    serialize_routing_image(tables, 1, *image, *image_size);
+    return 0;
+}
+
+static int bench_size(FILE* report, const fat_tree_params_t* params, uint32_t query_count) {
+    routing_tables_t tables;
+    uint8_t* image = NULL;
+    size_t image_size = 0;
+
+    if (build_image(params, &tables, &image, &image_size) != 0) {
+        fprintf(stderr, "错误: 拓扑生成失败 (%u/%u/%u)\n",
+                params->depth, params->fanout, params->hosts_per_leaf);
+        return -1;
+    }
+
+    // 每批查询属于同一交换机
+    uint32_t batch_count = (query_count + LOOKUP_BATCH - 1) / LOOKUP_BATCH;
+    uint32_t* switch_ids = malloc(sizeof(uint32_t) * batch_count);
+    uint32_t* dst_ips = malloc(sizeof(uint32_t) * batch_count * LOOKUP_BATCH);
+    int32_t* single = malloc(sizeof(int32_t) * batch_count * LOOKUP_BATCH);
+    int32_t* batched = malloc(sizeof(int32_t) * batch_count * LOOKUP_BATCH);
+    y2f_lookup_t* lookup = NULL;
+    y2f_error_t error;
+    int status = 0;
+
+    if (!switch_ids || !dst_ips || !single || !batched ||
+        y2f_lookup_open_buffer(image, image_size, &lookup, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: 查找结构建立失败\n");
+        status = -1;
+    }
+
+    if (status == 0) {
+        const switch_table_t* root = &tables.tables[0];
+        uint64_t seed = 1;
+        for (uint32_t b = 0; b < batch_count; b++) {
+            switch_ids[b] = tables.tables[synth_random(&seed) % tables.table_count].switch_id;
+            for (uint32_t q = 0; q < LOOKUP_BATCH; q++) {
+                uint64_t r = synth_random(&seed);
+                dst_ips[b * LOOKUP_BATCH + q] = (r & 3) != 0
+                    ? root->dst_ip[(r >> 2) % root->entry_count]
+                    : (uint32_t)(r >> 32);
+            }
+        }
+
+        double t0 = now_seconds();
+        for (uint32_t b = 0; b < batch_count; b++) {
+            for (uint32_t q = 0; q < LOOKUP_BATCH; q++) {
+                y2f_route_t route;
+                y2f_lookup(lookup, switch_ids[b], dst_ips[b * LOOKUP_BATCH + q], &route);
+                single[b * LOOKUP_BATCH + q] = route.found ? (int32_t)route.entry_addr : Y2F_NO_ROUTE;
+            }
+        }
+        double t1 = now_seconds();
+        for (uint32_t b = 0; b < batch_count; b++) {
+            y2f_lookup_batch(lookup, switch_ids[b], dst_ips + b * LOOKUP_BATCH, LOOKUP_BATCH,
+                             batched + b * LOOKUP_BATCH);
+        }
+        double t2 = now_seconds();
+
+        uint64_t total = (uint64_t)batch_count * LOOKUP_BATCH;
+        uint64_t mismatches = 0;
+        for (uint64_t i = 0; i < total; i++) {
+            mismatches += single[i] != batched[i];
+        }
+
+        fprintf(report, "%7u %6u %8u %11.2f %11.2f %10llu\n",
+                fat_tree_host_count(params), tables.table_count, tables.tables[0].entry_count,
+                t1 > t0 ? (double)total / (t1 - t0) / 1e6 : 0.0,
+                t2 > t1 ? (double)total / (t2 - t1) / 1e6 : 0.0,
+                (unsigned long long)mismatches);
+        fflush(report);
+        status = mismatches == 0 ? 0 : -1;
+    }
+
+    y2f_lookup_close(lookup);
+    free(batched);
+    free(single);
+    free(dst_ips);
+    free(switch_ids);
+    free(image);
+    free_routing_tables(&tables);
+    return status;
+}
+
+static int parse_count(const char* text, uint32_t max, uint32_t* value) {
+    char* end = NULL;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (!end || *end != '\0' || parsed == 0 || parsed > max) {
+        return -1;
+    }
+    *value = (uint32_t)parsed;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t query_count = 1u << 20;
+    int argi = 1;
+
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        if (parse_count(argv[2], 1u << 28, &query_count) != 0) {
+            fprintf(stderr, "错误: 无效的查询数: %s\n", argv[2]);
+            return 1;
+        }
+        argi = 3;
+    }
+
+    if ((argc - argi) % 3 != 0) {
+        fprintf(stderr, "用法: %s [-n 查询数] [层数 扇出 每叶Host数]...\n", argv[0]);
+        return 1;
+    }
+
+    yaml2fpga_log_level = LOG_LEVEL_QUIET;
+    FILE* report = stdout;
+
+    fprintf(report, "查询数: %u (每批%u条，同一交换机)，吞吐量单位: M次/秒\n", query_count, LOOKUP_BATCH);
+    fprintf(report, "%7s %6s %8s %11s %11s %10s\n",
+            "hosts", "sw", "root_ent", "single", "batch", "mismatch");
+
+    int status = 0;
+    if (argi == argc) {
+        for (size_t i = 0; i < sizeof(default_sizes) / sizeof(default_sizes[0]); i++) {
+            status |= bench_size(report, &default_sizes[i], query_count);
+        }
+    } else {
+        for (int i = argi; i < argc; i += 3) {
+            fat_tree_params_t params;
+            if (parse_count(argv[i], 65535, &params.depth) != 0 ||
+                parse_count(argv[i + 1], 65535, &params.fanout) != 0 ||
+                parse_count(argv[i + 2], 65535, &params.hosts_per_leaf) != 0) {
+                fprintf(stderr, "错误: 无效的拓扑参数: %s %s %s\n", argv[i], argv[i + 1], argv[i + 2]);
+                status = -1;
+                continue;
+            }
+            status |= bench_size(report, &params, query_count);
+        }
+    }
+
+    return status == 0 ? 0 : 1;
+}
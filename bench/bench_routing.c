@@ -0,0 +1,227 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include "topology_gen.h"
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// ============ 性能基准：解析 / 索引 / 路由构建 / 序列化 分阶段计时 ============
+// 用法: bench_routing [-r 次数] [层数 扇出 每叶Host数]...
+// 不带拓扑参数时运行 10 ~ 10k Host 的默认规模序列
+// 每个规模在单独的子进程中运行，maxrss_kb 只反映该规模自身的峰值常驻内存
+
+static const fat_tree_params_t default_sizes[] = {
+    {2, 2, 5},       // 10 Host
+    {2, 10, 10},     // 100 Host
+    {3, 10, 10},     // 1000 Host
+    {3, 20, 25},     // 10000 Host
+};
+
+typedef struct {
+    double parse;
+    double index;
+    double route;
+    double serialize;
+} phase_times_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// 运行一次完整流程，返回各阶段耗时与输出规模
+static int run_once(const char* yaml_path, const generate_options_t* options,
+                    phase_times_t* times, uint64_t* entry_count, size_t* image_bytes) {
+    topology_config_t config;
+    routing_tables_t tables;
+    double t0 = now_seconds();
+
+    if (parse_yaml_topology(yaml_path, &config) != SUCCESS) {
+        return -1;
+    }
+    double t1 = now_seconds();
+
+    if (build_topology_index(&config) != 0) {
+        cleanup_topology(&config);
+        return -1;
+    }
+    double t2 = now_seconds();
+
+    if (build_all_routing_tables(&config, options, &tables) != 0) {
+        cleanup_topology(&config);
+        return -1;
+    }
+    double t3 = now_seconds();
+
+    size_t size = routing_image_size(&tables, options->image_version);
+    uint8_t* image = malloc(size ? size : 1);
+    if (!image) {
+        free_routing_tables(&tables);
+        cleanup_topology(&config);
+        return -1;
+    }
+    serialize_routing_image(&tables, options->image_version, image, size);
+    double t4 = now_seconds();
+
+    *entry_count = 0;
+    for (uint32_t i = 0; i < tables.table_count; i++) {
+        *entry_count += tables.tables[i].entry_count;
+    }
+    *image_bytes = size;
+
+    times->parse = t1 - t0;
+    times->index = t2 - t1;
+    times->route = t3 - t2;
+    times->serialize = t4 - t3;
+
+    free(image);
+    free_routing_tables(&tables);
+    cleanup_topology(&config);
+    return 0;
+}
+
+static int bench_size(FILE* report, const fat_tree_params_t* params,
+                      const generate_options_t* options, uint32_t repeat) {
+    char yaml_path[] = "/tmp/yaml2fpga_bench_XXXXXX";
+    int fd = mkstemp(yaml_path);
+    FILE* yaml = fd >= 0 ? fdopen(fd, "w") : NULL;
+
+    if (!yaml) {
+        fprintf(stderr, "错误: 无法创建临时拓扑文件\n");
+        return -1;
+    }
+    int result = write_fat_tree_yaml(yaml, params);
+    if (fclose(yaml) != 0 || result != 0) {
+        fprintf(stderr, "错误: 拓扑生成失败 (%u/%u/%u)\n",
+                params->depth, params->fanout, params->hosts_per_leaf);
+        unlink(yaml_path);
+        return -1;
+    }
+
+    // 多次运行取各阶段最小值
+    phase_times_t best = {0};
+    uint64_t entries = 0;
+    size_t image_bytes = 0;
+    for (uint32_t r = 0; r < repeat; r++) {
+        phase_times_t times;
+        result = run_once(yaml_path, options, &times, &entries, &image_bytes);
+        if (result != 0) {
+            break;
+        }
+        if (r == 0 || times.parse < best.parse) best.parse = times.parse;
+        if (r == 0 || times.index < best.index) best.index = times.index;
+        if (r == 0 || times.route < best.route) best.route = times.route;
+        if (r == 0 || times.serialize < best.serialize) best.serialize = times.serialize;
+    }
+    unlink(yaml_path);
+
+    if (result != 0) {
+        fprintf(stderr, "错误: 基准运行失败 (%u/%u/%u)\n",
+                params->depth, params->fanout, params->hosts_per_leaf);
+        return -1;
+    }
+
+    uint32_t hosts = fat_tree_host_count(params);
+    uint32_t switches = fat_tree_switch_count(params);
+    double total = best.parse + best.index + best.route + best.serialize;
+
+    fprintf(report, "%7u %6u %9.3f %9.3f %9.3f %9.3f %9.3f %11.0f %9.1f %9ld\n",
+            hosts, switches,
+            best.parse * 1e3, best.index * 1e3, best.route * 1e3, best.serialize * 1e3, total * 1e3,
+            total > 0 ? (double)entries / total : 0.0,
+            best.serialize > 0 ? (double)image_bytes / best.serialize / 1e6 : 0.0,
+            peak_rss_kb());
+    fflush(report);
+    return 0;
+}
+
+// 在子进程中运行一个规模（子进程输出该行报告），避免前面规模的内存峰值计入后面的规模
+static int bench_size_isolated(FILE* report, const fat_tree_params_t* params,
+                               const generate_options_t* options, uint32_t repeat) {
+    fflush(report);
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "错误: 无法创建子进程\n");
+        return -1;
+    }
+    if (pid == 0) {
+        int status = bench_size(report, params, options, repeat);
+        fflush(report);
+        _exit(status == 0 ? 0 : 1);
+    }
+
+    int wstatus;
+    if (waitpid(pid, &wstatus, 0) != pid || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_count(const char* text, uint32_t* value) {
+    char* end = NULL;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (!end || *end != '\0' || parsed == 0 || parsed > 65535) {
+        return -1;
+    }
+    *value = (uint32_t)parsed;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    generate_options_t options = {0};
+    options.jobs = 1;
+    options.image_version = 1;
+    uint32_t repeat = 3;
+    int argi = 1;
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        if (parse_count(argv[2], &repeat) != 0) {
+            fprintf(stderr, "错误: 无效的重复次数: %s\n", argv[2]);
+            return 1;
+        }
+        argi = 3;
+    }
+
+    if ((argc - argi) % 3 != 0) {
+        fprintf(stderr, "用法: %s [-r 次数] [层数 扇出 每叶Host数]...\n", argv[0]);
+        return 1;
+    }
+
+    // 关闭转换器日志，只计路由计算本身的耗时
+    yaml2fpga_log_level = LOG_LEVEL_QUIET;
+    FILE* report = stdout;
+
+    fprintf(report, "重复次数: %u (各阶段取最小值)，时间单位: ms\n", repeat);
+    fprintf(report, "%7s %6s %9s %9s %9s %9s %9s %11s %9s %9s\n",
+            "hosts", "sw", "parse", "index", "route", "serial", "total",
+            "entries/s", "MB/s", "maxrss_kb");
+
+    int status = 0;
+    if (argi == argc) {
+        for (size_t i = 0; i < sizeof(default_sizes) / sizeof(default_sizes[0]); i++) {
+            status |= bench_size_isolated(report, &default_sizes[i], &options, repeat);
+        }
+    } else {
+        for (int i = argi; i < argc; i += 3) {
+            fat_tree_params_t params;
+            if (parse_count(argv[i], &params.depth) != 0 ||
+                parse_count(argv[i + 1], &params.fanout) != 0 ||
+                parse_count(argv[i + 2], &params.hosts_per_leaf) != 0) {
+                fprintf(stderr, "错误: 无效的拓扑参数: %s %s %s\n", argv[i], argv[i + 1], argv[i + 2]);
+                status = -1;
+                continue;
+            }
+            status |= bench_size_isolated(report, &params, &options, repeat);
+        }
+    }
+
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#include "topology_gen.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 合成拓扑生成器：gen_topology 层数 扇出 每叶Host数 [输出文件]
+
+static int parse_arg(const char* text, uint32_t* value) {
+    char* end = NULL;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (!end || *end != '\0' || parsed == 0 || parsed > 65535) {
+        return -1;
+    }
+    *value = (uint32_t)parsed;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    fat_tree_params_t params;
+
+    if (argc < 4 || argc > 5 ||
+        parse_arg(argv[1], &params.depth) != 0 ||
+        parse_arg(argv[2], &params.fanout) != 0 ||
+        parse_arg(argv[3], &params.hosts_per_leaf) != 0) {
+        fprintf(stderr, "用法: %s 层数 扇出 每叶Host数 [输出文件]\n", argv[0]);
+        fprintf(stderr, "示例: %s 3 10 10 fat-tree-1000.yaml\n", argv[0]);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc == 5 && !(out = fopen(argv[4], "w"))) {
+        fprintf(stderr, "错误: 无法创建文件 %s\n", argv[4]);
+        return 1;
+    }
+
+    int result = write_fat_tree_yaml(out, &params);
+    if (out != stdout && fclose(out) != 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "错误: 拓扑生成失败\n");
+        return 1;
+    }
+
+    fprintf(stderr, "已生成拓扑: %u个交换机, %u个Host\n",
+            fat_tree_switch_count(&params), fat_tree_host_count(&params));
+    return 0;
+}
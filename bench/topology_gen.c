@@ -0,0 +1,118 @@
+#include "topology_gen.h"
+
+// ============ 合成树形拓扑生成 ============
+// 交换机按层序编号：下标 k 的子交换机为 k*fanout+1 .. k*fanout+fanout，
+// ID = 下标 + 1，最后一层为叶交换机。交换机与Host的IP/MAC由全局序号派生，互不重复。
+
+static uint32_t level_width(const fat_tree_params_t* params, uint32_t level) {
+    uint32_t width = 1;
+    for (uint32_t l = 0; l < level; l++) {
+        width *= params->fanout;
+    }
+    return width;
+}
+
+uint32_t fat_tree_switch_count(const fat_tree_params_t* params) {
+    uint32_t count = 0;
+    for (uint32_t l = 0; l < params->depth; l++) {
+        count += level_width(params, l);
+    }
+    return count;
+}
+
+uint32_t fat_tree_host_count(const fat_tree_params_t* params) {
+    if (params->depth == 0) {
+        return 0;
+    }
+    return level_width(params, params->depth - 1) * params->hosts_per_leaf;
+}
+
+static void format_ip(char* buf, size_t size, uint32_t serial) {
+    snprintf(buf, size, "10.%u.%u.%u", (serial >> 16) & 0xFF, (serial >> 8) & 0xFF, serial & 0xFF);
+}
+
+static void format_mac(char* buf, size_t size, uint32_t serial) {
+    snprintf(buf, size, "52:54:%02x:%02x:%02x:%02x",
+             (serial >> 24) & 0xFF, (serial >> 16) & 0xFF, (serial >> 8) & 0xFF, serial & 0xFF);
+}
+
+static void write_connection(FILE* out, int up, uint32_t host_id,
+                             uint32_t my_serial, uint32_t my_port, uint32_t my_qp,
+                             uint32_t peer_serial) {
+    char my_ip[20], my_mac[20], peer_ip[20], peer_mac[20];
+
+    format_ip(my_ip, sizeof(my_ip), my_serial);
+    format_mac(my_mac, sizeof(my_mac), my_serial);
+    format_ip(peer_ip, sizeof(peer_ip), peer_serial);
+    format_mac(peer_mac, sizeof(peer_mac), peer_serial);
+
+    fprintf(out,
+            "      - up: %s\n"
+            "        host_id: %u\n"
+            "        my_ip: \"%s\"\n"
+            "        my_mac: \"%s\"\n"
+            "        my_port: %u\n"
+            "        my_qp: %u\n"
+            "        peer_ip: \"%s\"\n"
+            "        peer_mac: \"%s\"\n"
+            "        peer_port: 4791\n"
+            "        peer_qp: 17\n",
+            up ? "true" : "false", host_id, my_ip, my_mac, my_port, my_qp, peer_ip, peer_mac);
+}
+
+int write_fat_tree_yaml(FILE* out, const fat_tree_params_t* params) {
+    if (params->depth == 0 || params->fanout == 0) {
+        return -1;
+    }
+
+    uint32_t switch_count = fat_tree_switch_count(params);
+    uint32_t leaf_start = switch_count - level_width(params, params->depth - 1);
+    uint32_t host_serial = switch_count + 1;
+
+    // IP由24位序号派生
+    if ((uint64_t)switch_count + fat_tree_host_count(params) > 0xFFFF00u) {
+        return -1;
+    }
+
+    fprintf(out, "switches:\n");
+    for (uint32_t k = 0; k < switch_count; k++) {
+        uint32_t my_serial = k + 1;
+        uint32_t port = 0;
+
+        fprintf(out, "  - id: %u\n    root: %s\n    connections:\n", k + 1, k == 0 ? "true" : "false");
+
+        if (k < leaf_start) {
+            // 下行链路：子交换机
+            for (uint32_t c = 1; c <= params->fanout; c++) {
+                uint32_t child = k * params->fanout + c;
+                write_connection(out, 0, child + 1, my_serial, 4791 + port, 16 + port, child + 1);
+                port++;
+            }
+        } else {
+            // 下行链路：直连Host
+            for (uint32_t h = 0; h < params->hosts_per_leaf; h++) {
+                write_connection(out, 0, host_serial - switch_count, my_serial,
+                                 4791 + port, 16 + port, host_serial);
+                host_serial++;
+                port++;
+            }
+        }
+
+        // 上行链路：父交换机
+        if (k > 0) {
+            uint32_t parent = (k - 1) / params->fanout;
+            write_connection(out, 1, parent + 1, my_serial, 4791 + port, 16 + port, parent + 1);
+        }
+    }
+
+    return ferror(out) ? -1 : 0;
+}
+
+// ============ 合成查询 ============
+
+uint64_t synth_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,24 @@
+#ifndef TOPOLOGY_GEN_H
+#define TOPOLOGY_GEN_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// 合成树形（fat-tree）拓扑参数
+typedef struct {
+    uint32_t depth;                  // 交换机层数（1 = 只有根交换机）
+    uint32_t fanout;                 // 每个非叶交换机的下级交换机数
+    uint32_t hosts_per_leaf;         // 每个叶交换机直连的Host数
+} fat_tree_params_t;
+
+// 计算拓扑规模
+uint32_t fat_tree_switch_count(const fat_tree_params_t* params);
+uint32_t fat_tree_host_count(const fat_tree_params_t* params);
+
+// 以 parse_yaml_topology 读取的 switches:/connections: 格式写出拓扑
+int write_fat_tree_yaml(FILE* out, const fat_tree_params_t* params);
+
+// 生成查询地址用的伪随机数（splitmix64），同一种子在各测试和基准中得到相同序列
+uint64_t synth_random(uint64_t* state);
+
+#endif // TOPOLOGY_GEN_H
@@ -0,0 +1,152 @@
+#ifndef LIBYAML2FPGA_H
+#define LIBYAML2FPGA_H
+
+// ============ libyaml2fpga：进程内嵌入接口 ============
+// 与 yaml2fpga 命令行使用同一套解析、路由构建和序列化代码，但：
+//   - 拓扑从内存缓冲区解析，镜像序列化到调用者提供的缓冲区，不读写任何文件
+//   - 不向 stdout/stderr 打印任何内容，错误通过 y2f_error_t 返回
+//   - 不使用进程级可变状态：不同线程可同时处理不同的拓扑/路由表对象；
+//     同一对象的只读操作（构建、查询、序列化）也可并发
+// 链接: -lyaml2fpga -lyaml -lm -pthread
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 共享库只导出带 Y2F_API 的符号（其余按 -fvisibility=hidden 编译）
+#if defined(__GNUC__)
+#define Y2F_API __attribute__((visibility("default")))
+#else
+#define Y2F_API
+#endif
+
+// 返回码（与命令行内部错误码一致的部分保持相同数值）
+#define Y2F_OK                 0
+#define Y2F_ERR_PARSE         -2      // YAML语法或字段格式错误
+#define Y2F_ERR_INVALID       -3      // 拓扑不合法（无交换机、根交换机数不为1、链路缺失等）
+#define Y2F_ERR_NOMEM         -4
+#define Y2F_ERR_ARGUMENT      -5      // 参数无效（空指针、不支持的版本/格式、下标越界）
+#define Y2F_ERR_CAPACITY      -6      // 路由表超出 max_entries、哈希桶数或BRAM预算
+#define Y2F_ERR_BUFFER        -7      // 调用者缓冲区不足，所需大小通过 required 返回
+
+#define Y2F_ERROR_MESSAGE_MAX 256
+#define Y2F_ENTRY_SIZE        32      // 单个路由条目（fpga_dest_entry_t）的字节数
+
+typedef struct {
+    int  code;                              // Y2F_OK 或 Y2F_ERR_*
+    char message[Y2F_ERROR_MESSAGE_MAX];    // 首条错误信息（UTF-8，无换行），成功时为空串
+} y2f_error_t;
+
+// 输出格式
+#define Y2F_FORMAT_BIN 0                    // 原始二进制镜像
+#define Y2F_FORMAT_HEX 1                    // Verilog $readmemh
+#define Y2F_FORMAT_COE 2                    // Xilinx Block Memory Generator
+#define Y2F_FORMAT_MIF 3                    // Intel/Altera Memory Initialization File
+
+// 构建与序列化选项，全0即命令行的默认行为
+typedef struct {
+    uint32_t jobs;                          // 并行构建线程数，0/1 为单线程
+    uint32_t image_version;                 // 1=连续DEST表，2=带目录索引，0 按1处理
+    uint32_t format;                        // Y2F_FORMAT_*
+    uint32_t compress;                      // 非0时做前缀聚合（--compress）
+    uint32_t max_entries;                   // 非0时做容量检查（--max-entries）
+    uint32_t bram_kb;                       // 非0时检查BRAM预算（--bram-kb）
+    uint32_t hash_buckets;                  // 非0时按哈希布局排布，每路该数量的桶（--hash-buckets，2的幂）
+} y2f_options_t;
+
+typedef struct y2f_topology y2f_topology_t;
+typedef struct y2f_tables y2f_tables_t;
+
+// 从内存中的YAML文本解析并校验拓扑、建立索引；data 只在调用期间使用
+Y2F_API int y2f_topology_parse(const char* data, size_t len,
+                               y2f_topology_t** topology, y2f_error_t* error);
+Y2F_API void y2f_topology_free(y2f_topology_t* topology);
+
+Y2F_API uint32_t y2f_topology_switch_count(const y2f_topology_t* topology);
+Y2F_API uint32_t y2f_topology_host_count(const y2f_topology_t* topology);
+
+// 为全部交换机构建路由表（按 options 聚合并做容量检查）；tables 与 topology 相互独立，
+// 构建完成后可先释放 topology
+Y2F_API int y2f_tables_build(const y2f_topology_t* topology, const y2f_options_t* options,
+                             y2f_tables_t** tables, y2f_error_t* error);
+Y2F_API void y2f_tables_free(y2f_tables_t* tables);
+
+// 路由表查询：index 为 0..count-1（按交换机ID升序）
+Y2F_API uint32_t y2f_tables_count(const y2f_tables_t* tables);
+Y2F_API int y2f_table_info(const y2f_tables_t* tables, uint32_t index,
+                           uint32_t* switch_id, uint32_t* entry_count);
+
+// 把第 index 张表按硬件条目格式打包到调用者的内存（entry_count * Y2F_ENTRY_SIZE 字节）
+Y2F_API int y2f_table_entries(const y2f_tables_t* tables, uint32_t index,
+                              void* entries, size_t capacity, size_t* required, y2f_error_t* error);
+
+// 把全部路由表序列化为镜像（二进制或按 format 的ROM初始化文本）写入调用者缓冲区
+// buf 为NULL或 capacity 不足时返回 Y2F_ERR_BUFFER，所需字节数写入 required（可先以NULL调用询问大小）
+Y2F_API int y2f_image_serialize(const y2f_tables_t* tables, const y2f_options_t* options,
+                                void* buf, size_t capacity, size_t* required, y2f_error_t* error);
+
+// ============ 路由查找（软件数据面 / 黄金模型）============
+// 加载已生成的镜像（v1 或 v2），按 router_searcher / router_searcher_masked 的语义查找：
+//   - 只有 valid 条目参与匹配，匹配条件为 (dst_ip & mask) == (key & mask)，
+//     mask 由 prefix_wildcard 得出（非 --compress 镜像中恒为精确匹配）
+//   - 多个条目命中时取地址最大者（与优先编码器一致）
+//   - 未命中时落到默认路由条目（dst_ip=0xFFFFFFFF 且 is_default_route=1）
+// 条目本身不复制：结果直接解码自映射的镜像。查找对象只读，可被多个线程同时使用
+
+typedef struct y2f_lookup y2f_lookup_t;
+
+#define Y2F_NO_ROUTE (-1)                   // 批量查找中未命中且无默认路由
+
+// 单次查找结果（解码后的条目字段）
+typedef struct {
+    uint8_t  found;                         // 0 时其余字段为0（resp_found）
+    uint8_t  is_direct_host;
+    uint8_t  is_broadcast;
+    uint8_t  is_default_route;              // 命中的是默认路由
+    uint32_t entry_addr;                    // 命中条目在该交换机表中的地址
+    uint32_t dst_ip;                        // 命中条目的匹配键（默认路由为0xFFFFFFFF）
+    uint8_t  prefix_wildcard;               // 命中条目的通配位数
+    uint16_t out_port;
+    uint16_t out_qp;
+    uint32_t next_hop_ip;
+    uint16_t next_hop_port;
+    uint16_t next_hop_qp;
+    uint8_t  next_hop_mac[6];
+} y2f_route_t;
+
+// 以只读 mmap 打开镜像文件
+Y2F_API int y2f_lookup_open(const char* path, y2f_lookup_t** lookup, y2f_error_t* error);
+// 使用调用者内存中的镜像（不复制，image 须在 y2f_lookup_close 之前保持有效）
+Y2F_API int y2f_lookup_open_buffer(const void* image, size_t size,
+                                   y2f_lookup_t** lookup, y2f_error_t* error);
+Y2F_API void y2f_lookup_close(y2f_lookup_t* lookup);
+
+Y2F_API uint32_t y2f_lookup_switch_count(const y2f_lookup_t* lookup);
+// index 为 0..count-1（按交换机ID升序）
+Y2F_API int y2f_lookup_table_info(const y2f_lookup_t* lookup, uint32_t index,
+                                  uint32_t* switch_id, uint32_t* entry_count);
+
+// 查找一个目的IP；switch_id 不在镜像中时返回 Y2F_ERR_ARGUMENT
+Y2F_API int y2f_lookup(const y2f_lookup_t* lookup, uint32_t switch_id, uint32_t dst_ip,
+                       y2f_route_t* route);
+
+// 批量查找：addrs[i] 为 dst_ips[i] 命中的条目地址（含默认路由）或 Y2F_NO_ROUTE，
+// 条目内容用 y2f_lookup_entry 解码；键比较使用SIMD（x86 SSE2 / 其余平台标量）
+Y2F_API int y2f_lookup_batch(const y2f_lookup_t* lookup, uint32_t switch_id,
+                             const uint32_t* dst_ips, size_t count, int32_t* addrs);
+
+// 解码交换机表中 entry_addr 处的条目（found=1，该地址是默认路由条目时 is_default_route=1）
+Y2F_API int y2f_lookup_entry(const y2f_lookup_t* lookup, uint32_t switch_id, uint32_t entry_addr,
+                             y2f_route_t* route);
+
+// 返回码的简短描述（静态字符串）
+Y2F_API const char* y2f_strerror(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBYAML2FPGA_H
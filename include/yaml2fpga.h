@@ -8,12 +8,12 @@
 #include <string.h>
 #include <yaml.h>
 #include <arpa/inet.h>
+#include <pthread.h>
 
-// Configuration limits
-#define MAX_SWITCHES 64
-#define MAX_CONNECTIONS_PER_SWITCH 32
-#define MAX_IP_ADDR_LEN 16
-#define MAX_MAC_ADDR_LEN 18
+// IPv4地址打印辅助（地址以主机序uint32存储）
+#define IP_FMT "%u.%u.%u.%u"
+#define IP_ARGS(ip) (unsigned)(((ip) >> 24) & 0xFF), (unsigned)(((ip) >> 16) & 0xFF), \
+                    (unsigned)(((ip) >> 8) & 0xFF), (unsigned)((ip) & 0xFF)
 
 // Connection status
 typedef enum {
@@ -22,35 +22,106 @@ typedef enum {
 } connection_status_t;
 
 // Network connection configuration
+// IP/MAC在YAML加载时一次性解码：IP为主机序uint32，MAC按书写顺序存储
 typedef struct {
     connection_status_t up;
     uint32_t host_id;
-    char my_ip[MAX_IP_ADDR_LEN];
-    char my_mac[MAX_MAC_ADDR_LEN];
+    uint32_t my_ip;
+    uint8_t  my_mac[6];
     uint16_t my_port;
     uint16_t my_qp;
-    char peer_ip[MAX_IP_ADDR_LEN];
-    char peer_mac[MAX_MAC_ADDR_LEN];
+    uint32_t peer_ip;
+    uint8_t  peer_mac[6];
     uint16_t peer_port;
     uint16_t peer_qp;
 } network_connection_t;
 
 // Switch configuration
+// 连接存放在 topology_config_t::connections 中，每个交换机占连续一段
 typedef struct {
     uint32_t id;
     bool is_root;
+    uint32_t connection_offset;  // 首个连接在全局连接数组中的下标
     uint32_t connection_count;
-    network_connection_t connections[MAX_CONNECTIONS_PER_SWITCH];
 } switch_config_t;
 
+// ============ 拓扑存储arena ============
+
+// 按块分配的线性内存池，拓扑的全部动态存储都从这里分配，
+// cleanup_topology 时一次性释放
+typedef struct topo_arena_block topo_arena_block_t;
+
+typedef struct {
+    topo_arena_block_t* head;    // 当前块（链表头）
+    size_t total;                // 已申请的总字节数
+} topo_arena_t;
+
+// ============ 拓扑索引 ============
+
+#define TOPO_INDEX_NONE 0xFFFFFFFFu
+
+// 开放寻址哈希表（uint64键 -> uint32值），线性探测
+typedef struct {
+    uint64_t* keys;
+    uint32_t* values;            // TOPO_INDEX_NONE 表示空槽
+    uint32_t  mask;              // 容量-1（容量为2的幂）
+} topo_hash_t;
+
+// 连接引用均为全局连接数组下标
+typedef struct {
+    bool        ready;
+    uint32_t    root;            // 根交换机下标
+    topo_hash_t switch_by_id;    // 交换机ID -> 交换机下标
+    topo_hash_t switch_by_ip;    // 接口IP -> 交换机下标
+    topo_hash_t host_by_ip;      // 下行对端IP -> 连接引用（首个出现者）
+    topo_hash_t downlink;        // (交换机下标, 对端IP) -> 连接引用
+    uint32_t*   uplink;          // 每个交换机的上行连接引用
+    uint32_t*   parent;          // 每个交换机的父交换机下标
+    uint32_t*   owner;           // 每个连接所属的交换机下标
+    uint32_t*   hosts;           // 去重后的Host IP（按发现顺序）
+    uint32_t    host_count;
+} topology_index_t;
+
 // Topology configuration
 typedef struct {
     uint32_t switch_count;
-    switch_config_t switches[MAX_SWITCHES];
+    uint32_t switch_capacity;
+    switch_config_t* switches;
+    uint32_t connection_count;
+    uint32_t connection_capacity;
+    network_connection_t* connections;
+    topology_index_t index;      // 解析后由 build_topology_index 构建
+    topo_arena_t arena;          // switches/connections/index 的存储
+    uint64_t yaml_event_count;   // 解析读取的YAML事件数
+    void* mapping;               // 从快照加载时指向只读映射区（此时上述数组均位于其中）
+    size_t mapping_size;
 } topology_config_t;
 
+// 交换机的第j个连接
+#define SWITCH_CONN(config, sw, j) (&(config)->connections[(sw)->connection_offset + (j)])
+
 // ============ 统一目的地路由表结构 ============
 
+#define FPGA_DEST_MAGIC    0x44455354u   // "DEST"
+#define FPGA_IMAGE_MAGIC   0x32584944u   // "DIX2"（小端存储为 'D','I','X','2'）
+#define FPGA_IMAGE_VERSION 2
+
+// v2镜像头 (16字节)，位于文件开头，其后紧跟 switch_count 条目录记录
+typedef struct {
+    uint32_t magic;              // FPGA_IMAGE_MAGIC
+    uint32_t version;            // FPGA_IMAGE_VERSION
+    uint32_t switch_count;       // 目录记录数
+    uint32_t dir_crc;            // 目录区CRC32
+} __attribute__((packed)) fpga_image_header_t;
+
+// v2目录记录 (16字节)，按交换机ID升序排列
+typedef struct {
+    uint32_t switch_id;
+    uint32_t offset;             // 该交换机 DEST 表头相对文件开头的字节偏移
+    uint32_t entry_count;
+    uint32_t crc32;              // 条目区（不含表头）CRC32
+} __attribute__((packed)) fpga_dir_record_t;
+
 // 目的地路由表头 (16字节)
 typedef struct {
     uint32_t magic;              // 0x44455354 ("DEST")
@@ -79,9 +150,43 @@ typedef struct {
     uint16_t next_hop_qp;        // 下一跳QP
     uint8_t  next_hop_mac[6];    // 下一跳MAC地址
 
-    uint8_t  padding[6];         // 对齐到32字节
+    // 前缀聚合（--compress）：dst_ip 低 prefix_wildcard 位为通配位，0 表示精确匹配
+    // 位于条目位 [215:208]，由 router_searcher_masked 按 (ip & mask) 匹配
+    uint8_t  prefix_wildcard;
+    uint8_t  padding[5];         // 对齐到32字节
 } __attribute__((packed)) fpga_dest_entry_t;
 
+#define PREFIX_WILDCARD_MAX 31   // 最大通配位数（至少保留1位精确匹配）
+
+// ============ 增量更新流（--delta）============
+// 全部字段为32位小端字，可与镜像一样用 --format=hex 输出供 $readmemh 读取：
+// 文件头 + 每个有变化的交换机一段（段头 + write_count 条写记录）
+
+#define FPGA_DELTA_MAGIC   0x41544C44u   // "DLTA"
+#define FPGA_DELTA_VERSION 1
+#define FPGA_DELTA_INVALIDATE 0x1u       // 写记录标志：失效该地址（条目全0）
+
+typedef struct {
+    uint32_t magic;              // FPGA_DELTA_MAGIC
+    uint32_t version;            // FPGA_DELTA_VERSION
+    uint32_t switch_count;       // 其后的交换机段数
+    uint32_t reserved;
+} __attribute__((packed)) fpga_delta_header_t;
+
+typedef struct {
+    uint32_t switch_id;
+    uint32_t write_count;        // 本段写记录数
+    uint32_t entry_count;        // 更新后路由表的条目数（含失效空洞）
+    uint32_t reserved;
+} __attribute__((packed)) fpga_delta_switch_t;
+
+// 写记录 (40字节)：把 entry 写入查找表地址 addr（searcher 的 init 写端口）
+typedef struct {
+    uint32_t addr;
+    uint32_t flags;              // FPGA_DELTA_INVALIDATE
+    fpga_dest_entry_t entry;
+} __attribute__((packed)) fpga_delta_write_t;
+
 // 广播配置表 预留
 typedef struct {
     uint8_t  child_count;        // 子节点数量
@@ -90,6 +195,190 @@ typedef struct {
     uint16_t child_qps[4];       // 子节点QP号
 } __attribute__((packed)) fpga_broadcast_config_t;
 
+// ============ 全拓扑路由规划 ============
+
+// 所有交换机共享的只读路由状态，由 routing_plan_build 一次遍历生成
+typedef struct {
+    const topology_config_t* config;
+    uint32_t  root;                  // 根交换机下标
+    uint32_t  host_count;
+    const uint32_t* host_ips;        // Host IP（发现顺序，指向拓扑索引）
+    uint32_t* host_conn;             // 每个Host的直连连接引用
+    uint32_t* switch_host_start;     // 每个交换机直连Host在 switch_hosts 中的区间 [start[i], start[i+1])
+    uint32_t* switch_hosts;          // 按交换机分组的Host下标
+    uint32_t* subtree;               // 每个交换机所在根子树（根的直接子节点下标）
+    uint32_t* child_link;            // 父交换机到每个交换机的下行连接引用
+    // 从根出发的DFS（欧拉序）区间：交换机 i 的子树恰为 euler[tin[i] .. tout[i])
+    // 根不可达的交换机 tin = tout = TOPO_INDEX_NONE
+    uint32_t* tin;
+    uint32_t* tout;
+    uint32_t* euler;                 // 按 tin 排列的交换机下标
+    uint64_t  lookups;               // 规划阶段的索引查找次数
+} routing_plan_t;
+
+// 交换机 sw 是否位于 ancestor 的子树中（含自身），O(1) 区间判断
+static inline bool routing_plan_in_subtree(const routing_plan_t* plan, uint32_t sw, uint32_t ancestor) {
+    return plan->tin[ancestor] != TOPO_INDEX_NONE && plan->tin[sw] != TOPO_INDEX_NONE &&
+           plan->tin[ancestor] <= plan->tin[sw] && plan->tin[sw] < plan->tout[ancestor];
+}
+
+// 输出文件格式（hex/coe/mif 均为每行一个32位小端字，供ROM初始化使用）
+typedef enum {
+    IMAGE_FORMAT_BIN = 0,            // 原始二进制镜像
+    IMAGE_FORMAT_HEX,                // Verilog $readmemh
+    IMAGE_FORMAT_COE,                // Xilinx Block Memory Generator
+    IMAGE_FORMAT_MIF                 // Intel/Altera Memory Initialization File
+} image_format_t;
+
+// 运行统计（--stats），耗时单位为毫秒
+typedef struct {
+    double   parse_ms;
+    double   index_ms;
+    double   validate_ms;
+    double   route_ms;               // 路由规划 + 全部路由表构建
+    double   serialize_ms;
+    double   write_ms;
+    double   total_ms;
+    uint64_t yaml_events;
+    uint64_t switches;
+    uint64_t connections;
+    uint64_t hosts;
+    uint64_t lookups;                // 路由生成中的索引查找次数
+    uint64_t tables;
+    uint64_t entries;
+    uint64_t bytes_written;
+} run_stats_t;
+
+// 路由表生成选项（NULL 表示全部使用默认值）
+typedef struct {
+    uint32_t jobs;                   // 并行构建线程数（<=1 为单线程）
+    uint32_t image_version;          // 1 = 连续DEST表流, 2 = 带目录的索引镜像（0 视为1）
+    image_format_t format;           // 输出文件格式
+    run_stats_t* stats;              // 非NULL时记录生成阶段的耗时与计数
+    const char* prev_image;          // 上次生成的镜像（增量模式 / 增量更新流的比较基准）
+    const char* delta_file;          // 非NULL时按稳定槽位排布条目并输出增量更新流
+    const char* slot_map;            // 非NULL时按该槽位映射排布条目，生成后写回
+    bool compress;                   // 把转发动作相同的连续地址块聚合为前缀条目
+    uint32_t max_entries;            // 非0时检查每张表是否放得进该容量的查找表（容量规划）
+    uint32_t bram_kb;                // 非0时同时检查查找表的BRAM预算（Kb）
+    uint32_t hash_buckets;           // 非0时按两路cuckoo哈希把条目预先放入桶（router_searcher_hash，2的幂）
+} generate_options_t;
+
+// ============ 路由表工作表示（按列存储）============
+// 生成和各处理阶段（聚合、槽位排布、差分）使用按字段分列的数组，
+// 转发动作按内容去重（同一下一跳的大量Host共用一个动作），
+// 只在序列化或写增量流时才打包为 fpga_dest_entry_t
+
+#define ROUTE_FLAG_VALID     0x01u
+#define ROUTE_FLAG_DIRECT    0x02u
+#define ROUTE_FLAG_BROADCAST 0x04u
+#define ROUTE_FLAG_DEFAULT   0x08u
+
+// 转发动作（与 fpga_dest_entry_t 中 out_port..next_hop_mac 的布局相同，18字节）
+typedef struct {
+    uint16_t out_port;
+    uint16_t out_qp;
+    uint32_t next_hop_ip;
+    uint16_t next_hop_port;
+    uint16_t next_hop_qp;
+    uint8_t  next_hop_mac[6];    // 已按条目字节序反转
+} __attribute__((packed)) route_action_t;
+
+// 单个交换机的已构建路由表，各列数组分配在所属 routing_tables_t 的 arena 中
+// 无效条目（槽位空洞）flags 为0，打包为全0条目
+typedef struct {
+    uint32_t switch_id;
+    uint32_t entry_count;
+    uint32_t* dst_ip;
+    uint32_t* action_id;             // actions 下标
+    uint8_t*  flags;                 // ROUTE_FLAG_*
+    uint8_t*  wildcard;              // 前缀通配位数（见 fpga_dest_entry_t::prefix_wildcard）
+    uint32_t action_count;
+    route_action_t* actions;         // 去重后的转发动作
+    uint64_t lookups;                // 构建本表的索引查找次数（各线程独立计数）
+} switch_table_t;
+
+// 全部交换机的路由表（按交换机ID顺序，tables[i].switch_id == i + 1）
+typedef struct {
+    uint32_t table_count;
+    switch_table_t* tables;
+    uint64_t plan_lookups;           // 路由规划阶段的索引查找次数
+    topo_arena_t arena;              // 全部表的列数组与动作数组，free_routing_tables 时一次释放
+} routing_tables_t;
+
+// 构建路由表的工作线程上下文：表存储的arena与按连接去重动作的临时映射，在各交换机间复用
+typedef struct {
+    topo_arena_t arena;
+    uint32_t* conn_action;           // 连接引用 -> 当前表中的动作下标
+    uint32_t* conn_stamp;            // conn_action 的有效标记（每表递增，免清零）
+    uint32_t  stamp;
+} route_builder_t;
+
+// ============ 路由查找 ============
+
+// 一张交换机表的查找结构：参与匹配的条目按地址顺序存成键/掩码/地址三列（SoA，
+// 16字节对齐并补齐到 LOOKUP_LANES 的倍数，补齐键永不命中），条目本身留在镜像中。
+// 精确匹配条目超过 LOOKUP_HASH_MIN 个时改放开放寻址哈希表，键列只留前缀条目
+#define LOOKUP_LANES    4
+#define LOOKUP_HASH_MIN 64
+
+typedef struct {
+    uint32_t switch_id;
+    uint32_t entry_count;
+    const uint8_t* entries;          // 镜像中的条目区（entry_count * 32字节，不保证对齐）
+    uint32_t key_count;              // 键列长度（含补齐）
+    uint32_t* keys;                  // dst_ip & mask
+    uint32_t* masks;                 // 由 prefix_wildcard 得出，精确匹配为全1
+    uint32_t* addrs;                 // 键对应的条目地址（升序）
+    uint32_t hash_mask;              // 哈希槽数 - 1（没有哈希表时为0）
+    uint32_t* hash_keys;             // 精确匹配的 dst_ip
+    uint32_t* hash_addrs;            // 条目地址 + 1，0 为空槽；键重复时保留最大地址
+    int32_t default_addr;            // 默认路由条目地址，没有时为 -1
+} lookup_table_t;
+
+typedef struct {
+    uint32_t table_count;
+    lookup_table_t* tables;          // 按交换机ID升序
+    void* mapping;                   // route_lookup_open 映射的文件（否则为NULL）
+    size_t mapping_size;
+    topo_arena_t arena;              // 键/掩码/地址列
+} route_lookup_t;
+
+// ============ 日志 ============
+
+// 日志级别（-q / -v），启动时设置一次，之后只读
+typedef enum {
+    LOG_LEVEL_QUIET = 0,             // 只输出错误（stderr）
+    LOG_LEVEL_INFO = 1,              // 阶段进度 + 每表一行摘要（默认）
+    LOG_LEVEL_VERBOSE = 2            // 逐条目详细日志
+} log_level_t;
+
+extern log_level_t yaml2fpga_log_level;
+
+// 错误收集器：库接口（libyaml2fpga.h）调用期间安装在调用线程上（并传给其工作线程），
+// 此时错误只记录首条、不打印，警告和进度日志全部关闭；未安装时错误和警告写到stderr
+#define ERROR_MESSAGE_MAX 256
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t count;                  // 已报告的错误数
+    char message[ERROR_MESSAGE_MAX]; // 首条错误（去掉"错误: "前缀和换行）
+} error_sink_t;
+
+extern __thread error_sink_t* yaml2fpga_error_sink;
+
+void log_error(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// 先判断级别再格式化：级别关闭时参数不会被求值
+#define LOG_ENABLED(level) (!yaml2fpga_error_sink && yaml2fpga_log_level >= (level))
+#define LOG_TO(stream, level, ...) \
+    do { if (LOG_ENABLED(level)) fprintf((stream), __VA_ARGS__); } while (0)
+#define LOG_INFO(...)    LOG_TO(stdout, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_VERBOSE(...) LOG_TO(stdout, LOG_LEVEL_VERBOSE, __VA_ARGS__)
+#define LOG_ERROR(...)   log_error(__VA_ARGS__)
+#define LOG_WARN(...) \
+    do { if (!yaml2fpga_error_sink) fprintf(stderr, __VA_ARGS__); } while (0)
+
 // Error codes
 #define SUCCESS 0
 #define ERR_FILE_NOT_FOUND -1
@@ -98,16 +387,124 @@ typedef struct {
 
 // Function declarations
 int parse_yaml_topology(const char* filename, topology_config_t* config);
+int parse_yaml_topology_buffer(const char* data, size_t len, topology_config_t* config);
+int load_topology_snapshot(const char* filename, topology_config_t* config);
+int save_topology_snapshot(const topology_config_t* config, const char* filename);
 void cleanup_topology(topology_config_t* config);
+int validate_topology(const topology_config_t* config);
 void print_topology_summary(const topology_config_t* config);
 
+// arena函数声明
+void* topo_arena_alloc(topo_arena_t* arena, size_t size);
+void* topo_arena_grow(topo_arena_t* arena, void* ptr, size_t old_size, size_t new_size);
+void topo_arena_free(topo_arena_t* arena);
+void topo_arena_merge(topo_arena_t* into, topo_arena_t* from);
+
+// 拓扑索引函数声明
+int build_topology_index(topology_config_t* config);
+uint32_t topo_hash_get(const topo_hash_t* hash, uint64_t key);
+
 // 统一路由表函数声明
+int routing_plan_build(const topology_config_t* config, routing_plan_t* plan);
+void routing_plan_free(routing_plan_t* plan);
+int routing_plan_emit_table(const routing_plan_t* plan,
+                            uint32_t switch_id,
+                            route_builder_t* builder,
+                            switch_table_t* table,
+                            FILE* log);
 int build_unified_routing_table(const topology_config_t* config,
                                  uint32_t switch_id,
                                  fpga_dest_entry_t** dest_table,
                                  uint32_t* entry_count);
+int build_all_routing_tables(const topology_config_t* config,
+                             const generate_options_t* options,
+                             routing_tables_t* tables);
+void free_routing_tables(routing_tables_t* tables);
+int rebuild_routing_tables(const topology_config_t* old_config,
+                           const topology_config_t* config,
+                           const routing_tables_t* old_tables,
+                           routing_tables_t* tables);
+int generate_incremental_routing_binary(const topology_config_t* old_config,
+                                        const topology_config_t* config,
+                                        const char* prev_image_filename,
+                                        const char* output_filename,
+                                        const generate_options_t* options);
+int write_routing_tables(routing_tables_t* tables,
+                         const char* output_filename,
+                         const generate_options_t* options);
+
+// 路由表列存储函数声明
+int route_builder_init(route_builder_t* builder, const topology_config_t* config);
+void route_builder_free(route_builder_t* builder);
+int route_table_alloc(switch_table_t* table, topo_arena_t* arena,
+                      uint32_t entry_capacity, uint32_t action_capacity);
+int route_table_from_entries(switch_table_t* table, topo_arena_t* arena,
+                             const uint8_t* entries, uint32_t entry_count);
+int route_table_copy(switch_table_t* table, topo_arena_t* arena, const switch_table_t* src);
+void route_table_pack(const switch_table_t* table, uint32_t i, fpga_dest_entry_t* entry);
+bool route_entry_equal(const switch_table_t* a, uint32_t i, const switch_table_t* b, uint32_t j);
+bool route_table_equal(const switch_table_t* a, const switch_table_t* b);
+
+// 容量规划函数声明
+int check_table_capacity(const routing_tables_t* tables, uint32_t max_entries, uint32_t bram_kb);
+int check_hash_capacity(uint32_t buckets, uint32_t bram_kb);
+
+// 哈希查找表排布函数声明（乘数与 router_searcher_hash.v 一致）
+#define HASH_MULT_WAY0   0x9E3779B1u
+#define HASH_MULT_WAY1   0x85EBCA77u
+#define HASH_BUCKETS_MIN 2u
+#define HASH_BUCKETS_MAX (1u << 16)
+#define HASH_MAX_KICKS   512u        // 单次插入最多踢出的条目数，超过即认为放不下
+
+uint32_t route_hash_bucket(uint32_t dst_ip, uint32_t way, uint32_t bucket_bits);
+int place_hash_table(switch_table_t* table, topo_arena_t* arena, uint32_t buckets, uint32_t* kicks);
+int place_hash_tables(routing_tables_t* tables, uint32_t buckets);
+
+// 前缀聚合函数声明
+int compress_routing_table(switch_table_t* table, topo_arena_t* arena, uint32_t* original_count);
+int compress_routing_tables(routing_tables_t* tables);
+
+// 稳定槽位与增量更新流函数声明
+#define SLOT_MAP_MAX_SLOT (1u << 20)     // 槽位映射中允许的最大槽位（防止损坏文件导致巨大分配）
+
+int place_stable_slots(const switch_table_t* old_table, switch_table_t* table, topo_arena_t* arena);
+int place_routing_tables(const routing_tables_t* old_tables, routing_tables_t* tables);
+int load_slot_map(const char* filename, routing_tables_t* map);
+int save_slot_map(const char* filename, const routing_tables_t* tables);
+int build_routing_delta(const routing_tables_t* old_tables, routing_tables_t* tables,
+                        uint8_t** delta, size_t* delta_size);
 int generate_unified_routing_binary(const topology_config_t* config,
-                                     const char* output_filename);
+                                     const char* output_filename,
+                                     const generate_options_t* options);
+
+// 镜像序列化与输出函数声明
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len);
+size_t routing_image_size(const routing_tables_t* tables, uint32_t image_version);
+size_t serialize_routing_image(const routing_tables_t* tables, uint32_t image_version,
+                               uint8_t* buf, size_t capacity);
+int parse_routing_image(const uint8_t* image, size_t size,
+                        routing_tables_t* tables, uint32_t* image_version);
+int read_file_all(const char* path, uint8_t** data, size_t* len);
+int format_image_text(const uint8_t* image, size_t image_size, image_format_t format,
+                      char** text, size_t* text_len);
+int write_file_atomic(const char* path, const void* data, size_t len);
+
+// 路由查找函数声明
+int route_lookup_init(route_lookup_t* lookup, const uint8_t* image, size_t size);
+int route_lookup_open(route_lookup_t* lookup, const char* path);
+void route_lookup_free(route_lookup_t* lookup);
+const lookup_table_t* route_lookup_table(const route_lookup_t* lookup, uint32_t switch_id);
+int32_t route_lookup_match(const lookup_table_t* table, uint32_t dst_ip);
+void route_lookup_batch(const lookup_table_t* table, const uint32_t* dst_ips, size_t count, int32_t* addrs);
+
+// 常驻模式函数声明
+int run_watch_daemon(const char* yaml_file, const char* output_file,
+                     const generate_options_t* options, const char* socket_path,
+                     uint32_t debounce_ms);
+
+// 运行统计函数声明
+double stats_now_ms(void);
+void write_stats_json(FILE* out, const run_stats_t* stats);
 void print_dest_table(const fpga_dest_entry_t* dest_table, uint32_t entry_count, uint32_t switch_id);
 
 #endif // YAML2FPGA_H
\ No newline at end of file
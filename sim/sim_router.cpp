@@ -0,0 +1,729 @@
+// ============ Verilator 协同仿真：router 吞吐量与查找结果核对 ============
+// 用法: sim_router [-n 查询数] [-s 交换机ID] [-b 空闲百分比] [-r 种子] [--compress] <拓扑.yaml | 镜像.bin>
+// YAML 输入先用 libyaml2fpga 生成镜像（与 yaml2fpga 的输出一致），.bin 直接加载。
+// 镜像转成 $readmemh 文件后通过 +routing_table/+switch_id 交给 router，经 router_reader
+// 初始化后逐周期发送随机与对抗性查询并核对每个响应，统计持续吞吐量（查询/周期）、延迟分布和停顿周期。
+// YAML 输入时期望结果直接由解析出的拓扑推导（不经过路由表生成器），仿真前先用它核对镜像的
+// y2f_lookup 结果，镜像不一致的交换机不再仿真；.bin 输入没有拓扑，只能与 y2f_lookup 核对。
+
+#include "Vrouter.h"
+#include "verilated.h"
+#include "libyaml2fpga.h"
+extern "C" {
+#include "yaml2fpga.h"
+}
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+// 与 Makefile 中传给 verilator 的 -G 参数一致
+#ifndef SIM_MEM_WORDS
+#define SIM_MEM_WORDS 1024
+#endif
+#ifndef SIM_MAX_ENTRIES
+#define SIM_MAX_ENTRIES 64
+#endif
+#ifndef SIM_MASKED
+#define SIM_MASKED 0
+#endif
+#ifndef SIM_HASH_BUCKETS
+#define SIM_HASH_BUCKETS 0
+#endif
+
+// 哈希查找引擎的表固定为 2*HASH_BUCKETS+1 条
+#define SIM_TABLE_ENTRIES   (SIM_HASH_BUCKETS ? 2 * SIM_HASH_BUCKETS + 1 : SIM_MAX_ENTRIES)
+
+#define SIM_MAX_SWITCH_ID   15                         // router_reader 的 target_switch_id 为4位
+#define SIM_RESET_CYCLES    5
+#define SIM_INIT_TIMEOUT    ((uint64_t)SIM_MEM_WORDS * 16 + 1000)
+#define SIM_DRAIN_TIMEOUT   1000                       // 停止发送后等待剩余响应的周期数
+#define SIM_REPORT_ERRORS   5
+#define SIM_NONE            0xFFFFFFFFu
+
+typedef struct {
+    uint64_t queries;
+    uint64_t issue_cycles;           // 第一个查询到最后一个查询的周期数
+    uint64_t cycles;                 // 第一个查询到最后一个响应的周期数
+    uint64_t stall_cycles;           // 最早的未完成查询已超过最小延迟，本周期却没有响应
+    uint64_t mismatches;
+    std::map<uint64_t, uint64_t> latency;
+} sim_result_t;
+
+typedef struct {
+    uint32_t dst_ip;
+    uint64_t issue_cycle;
+} pending_query_t;
+
+// 一次查找的转发结果，MAC为 router 输出的48位值
+typedef struct {
+    bool     found;
+    bool     is_direct_host;
+    bool     is_broadcast;
+    bool     is_default_route;
+    uint16_t out_port;
+    uint16_t out_qp;
+    uint32_t next_hop_ip;
+    uint16_t next_hop_port;
+    uint16_t next_hop_qp;
+    uint64_t next_hop_mac;
+} sim_route_t;
+
+// 一个交换机的期望结果：拓扑中的每个目的地各一项，其余地址都是 other
+typedef struct {
+    std::unordered_map<uint32_t, sim_route_t> dests;
+    sim_route_t other;
+} expected_table_t;
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static int read_file(const char* path, std::vector<uint8_t>* data) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法打开文件 %s\n", path);
+        return -1;
+    }
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        data->insert(data->end(), buf, buf + n);
+    }
+    int status = ferror(fp) ? -1 : 0;
+    fclose(fp);
+    return status;
+}
+
+// YAML 拓扑按库的默认选项生成v1镜像（哈希引擎按其桶数排布）
+static int build_image(const char* path, bool compress, std::vector<uint8_t>* image) {
+    std::vector<uint8_t> yaml;
+    y2f_topology_t* topology = NULL;
+    y2f_tables_t* tables = NULL;
+    y2f_options_t options;
+    y2f_error_t error;
+    size_t size = 0;
+
+    memset(&options, 0, sizeof(options));
+    options.compress = compress;
+    options.hash_buckets = SIM_HASH_BUCKETS;
+    if (read_file(path, &yaml) != 0) {
+        return -1;
+    }
+    int code = y2f_topology_parse((const char*)yaml.data(), yaml.size(), &topology, &error);
+    if (code == Y2F_OK) {
+        code = y2f_tables_build(topology, &options, &tables, &error);
+    }
+    y2f_topology_free(topology);
+    if (code == Y2F_OK) {
+        y2f_image_serialize(tables, &options, NULL, 0, &size, &error);
+        image->resize(size);
+        code = y2f_image_serialize(tables, &options, image->data(), size, &size, &error);
+    }
+    y2f_tables_free(tables);
+    if (code != Y2F_OK) {
+        fprintf(stderr, "错误: %s\n", error.message);
+        return -1;
+    }
+    return 0;
+}
+
+// 每行一个32位小端字，与 yaml2fpga --format=hex 相同
+static int write_hex(const std::vector<uint8_t>& image, char* path) {
+    int fd = mkstemp(path);
+    FILE* fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!fp) {
+        fprintf(stderr, "错误: 无法创建临时文件\n");
+        return -1;
+    }
+    for (size_t i = 0; i + 4 <= image.size(); i += 4) {
+        uint32_t word;
+        memcpy(&word, &image[i], sizeof(word));
+        fprintf(fp, "%08x\n", word);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+// ============ 拓扑模型 ============
+
+// 只使用解析出的连接，不经过拓扑索引和路由表生成器：
+//   - 目的地是各下行连接的对端IP，接入交换机为首个以它为对端的下行连接所属的交换机
+//   - 交换机的上行连接是它的首个 up 连接，拥有该连接对端IP的交换机是父交换机
+//   - 从接入交换机沿父交换机上溯，经过本交换机时走通往下一级的下行连接（本交换机即接入交换机时直连），
+//     不经过时非根交换机经上行连接走默认路由，根交换机未命中
+typedef struct {
+    topology_config_t config;
+    std::map<uint32_t, uint32_t> switch_by_id;                   // 交换机ID -> 下标
+    std::vector<const network_connection_t*> uplink;             // 每个交换机的上行连接（根为NULL）
+    std::vector<uint32_t> parent;                                // 父交换机下标（根为 SIM_NONE）
+    std::map<uint32_t, std::pair<uint32_t, const network_connection_t*> > attach;  // 目的IP -> (接入交换机, 连接)
+} topology_model_t;
+
+static int load_topology_model(const char* path, topology_model_t* model) {
+    memset(&model->config, 0, sizeof(model->config));
+    yaml2fpga_log_level = LOG_LEVEL_QUIET;
+    int result = parse_yaml_topology(path, &model->config);
+    if (result != SUCCESS) {
+        fprintf(stderr, "错误: YAML解析失败 (错误码: %d)\n", result);
+        return -1;
+    }
+
+    const topology_config_t* config = &model->config;
+    std::map<uint32_t, uint32_t> switch_by_ip;
+    model->uplink.assign(config->switch_count, NULL);
+    model->parent.assign(config->switch_count, SIM_NONE);
+    for (uint32_t s = 0; s < config->switch_count; s++) {
+        const switch_config_t* sw = &config->switches[s];
+        model->switch_by_id.insert(std::make_pair(sw->id, s));
+        for (uint32_t j = 0; j < sw->connection_count; j++) {
+            const network_connection_t* conn = SWITCH_CONN(config, sw, j);
+            switch_by_ip.insert(std::make_pair(conn->my_ip, s));
+            if (conn->up == CONN_UP) {
+                if (!model->uplink[s]) {
+                    model->uplink[s] = conn;
+                }
+            } else {
+                model->attach.insert(std::make_pair(conn->peer_ip, std::make_pair(s, conn)));
+            }
+        }
+    }
+    for (uint32_t s = 0; s < config->switch_count; s++) {
+        if (!model->uplink[s] || config->switches[s].is_root) {
+            model->uplink[s] = NULL;
+            continue;
+        }
+        std::map<uint32_t, uint32_t>::const_iterator it = switch_by_ip.find(model->uplink[s]->peer_ip);
+        if (it != switch_by_ip.end()) {
+            model->parent[s] = it->second;
+        }
+    }
+    return 0;
+}
+
+static sim_route_t route_via(const network_connection_t* conn, bool direct, bool default_route) {
+    sim_route_t route;
+    memset(&route, 0, sizeof(route));
+    route.found = true;
+    route.is_direct_host = direct;
+    route.is_default_route = default_route;
+    route.out_port = conn->my_port;
+    route.out_qp = conn->my_qp;
+    route.next_hop_ip = conn->peer_ip;
+    route.next_hop_port = conn->peer_port;
+    route.next_hop_qp = conn->peer_qp;
+    for (int i = 0; i < 6; i++) {
+        route.next_hop_mac = (route.next_hop_mac << 8) | conn->peer_mac[i];
+    }
+    return route;
+}
+
+static int expected_for_switch(const topology_model_t* model, uint32_t switch_id, expected_table_t* table) {
+    std::map<uint32_t, uint32_t>::const_iterator self = model->switch_by_id.find(switch_id);
+    if (self == model->switch_by_id.end()) {
+        fprintf(stderr, "错误: 拓扑中没有 Switch %u\n", switch_id);
+        return -1;
+    }
+    const topology_config_t* config = &model->config;
+    uint32_t s = self->second;
+    const network_connection_t* uplink = model->uplink[s];
+
+    memset(&table->other, 0, sizeof(table->other));
+    if (uplink) {
+        table->other = route_via(uplink, false, true);
+    }
+    table->dests.clear();
+    for (const auto& dest : model->attach) {
+        uint32_t at = dest.second.first;
+        if (at == s) {
+            table->dests[dest.first] = route_via(dest.second.second, true, false);
+            continue;
+        }
+        // 上溯到本交换机的直接下级（步数以交换机数为限，防止环）
+        uint32_t child = at;
+        for (uint32_t steps = 0; child != SIM_NONE && model->parent[child] != s && steps < config->switch_count; steps++) {
+            child = model->parent[child];
+        }
+        const network_connection_t* link = NULL;
+        if (child != SIM_NONE && model->parent[child] == s && model->uplink[child]) {
+            const switch_config_t* sw = &config->switches[s];
+            for (uint32_t j = 0; !link && j < sw->connection_count; j++) {
+                const network_connection_t* conn = SWITCH_CONN(config, sw, j);
+                if (conn->up == CONN_DOWN && conn->peer_ip == model->uplink[child]->my_ip) {
+                    link = conn;
+                }
+            }
+        }
+        table->dests[dest.first] = link ? route_via(link, false, false) : table->other;
+    }
+    return 0;
+}
+
+static sim_route_t route_from_lookup(const y2f_route_t* route) {
+    sim_route_t result;
+    memset(&result, 0, sizeof(result));
+    if (!route->found) {
+        return result;
+    }
+    result.found = true;
+    result.is_direct_host = route->is_direct_host;
+    result.is_broadcast = route->is_broadcast;
+    result.is_default_route = route->is_default_route;
+    result.out_port = route->out_port;
+    result.out_qp = route->out_qp;
+    result.next_hop_ip = route->next_hop_ip;
+    result.next_hop_port = route->next_hop_port;
+    result.next_hop_qp = route->next_hop_qp;
+    // 条目中MAC反向存储，router 按小端读出48位
+    for (int i = 5; i >= 0; i--) {
+        result.next_hop_mac = (result.next_hop_mac << 8) | route->next_hop_mac[i];
+    }
+    return result;
+}
+
+static const sim_route_t* expected_route(const expected_table_t* table, uint32_t dst_ip) {
+    std::unordered_map<uint32_t, sim_route_t>::const_iterator it = table->dests.find(dst_ip);
+    return it != table->dests.end() ? &it->second : &table->other;
+}
+
+static bool same_sim_route(const sim_route_t* a, const sim_route_t* b) {
+    if (a->found != b->found) {
+        return false;
+    }
+    return !a->found ||
+           (a->is_direct_host == b->is_direct_host && a->is_broadcast == b->is_broadcast &&
+            a->is_default_route == b->is_default_route &&
+            a->out_port == b->out_port && a->out_qp == b->out_qp && a->next_hop_ip == b->next_hop_ip &&
+            a->next_hop_port == b->next_hop_port && a->next_hop_qp == b->next_hop_qp &&
+            a->next_hop_mac == b->next_hop_mac);
+}
+
+// ============ 查询生成 ============
+
+// 命中键、拓扑中的目的地、随机地址，以及容易出错的地址：默认路由键 0xFFFFFFFF、全0（失效条目的键）、
+// 键的相邻地址、最高位翻转，前缀条目块的首尾和块外的第一个地址
+typedef struct {
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> adversarial;
+} query_pool_t;
+
+static void build_query_pool(const y2f_lookup_t* lookup, uint32_t switch_id, uint32_t entry_count,
+                             const expected_table_t* expected, query_pool_t* pool) {
+    pool->adversarial.push_back(0xFFFFFFFFu);
+    pool->adversarial.push_back(0);
+    for (uint32_t addr = 0; addr < entry_count; addr++) {
+        y2f_route_t route;
+        y2f_lookup_entry(lookup, switch_id, addr, &route);
+        if (route.is_default_route || route.dst_ip == 0) {
+            continue;
+        }
+        uint32_t span = route.prefix_wildcard >= 32 ? 0xFFFFFFFFu : (1u << route.prefix_wildcard) - 1;
+        uint32_t base = route.dst_ip & ~span;
+        pool->keys.push_back(route.dst_ip);
+        pool->adversarial.push_back(base - 1);
+        pool->adversarial.push_back(base | span);
+        pool->adversarial.push_back((base | span) + 1);
+        pool->adversarial.push_back(route.dst_ip ^ 0x80000000u);
+    }
+    if (expected) {
+        for (const auto& dest : expected->dests) {
+            pool->keys.push_back(dest.first);
+        }
+    }
+    if (pool->keys.empty()) {
+        pool->keys.push_back(0xFFFFFFFFu);
+    }
+}
+
+static uint32_t next_query(const query_pool_t* pool, uint64_t* seed, uint32_t previous) {
+    uint64_t r = next_random(seed);
+    uint32_t pick = (uint32_t)(r >> 32);
+    switch (r % 20) {
+        case 0:  return previous;                                   // 连续相同地址
+        case 1: case 2: case 3: case 4:
+            return pool->adversarial[pick % pool->adversarial.size()];
+        case 5: case 6: case 7: case 8:
+            return pick;                                            // 随机地址（多为未命中）
+        default:
+            return pool->keys[pick % pool->keys.size()];
+    }
+}
+
+// ============ 仿真 ============
+
+static void tick(VerilatedContext* context, Vrouter* top) {
+    top->clk = 0;
+    top->eval();
+    context->timeInc(1);
+    top->clk = 1;
+    top->eval();
+    context->timeInc(1);
+}
+
+static sim_route_t route_from_response(const Vrouter* top) {
+    sim_route_t route;
+    route.found = top->resp_found;
+    route.is_direct_host = top->resp_is_direct_host;
+    route.is_broadcast = top->resp_is_broadcast;
+    route.is_default_route = top->resp_is_default_route;
+    route.out_port = top->resp_out_port;
+    route.out_qp = top->resp_out_qp;
+    route.next_hop_ip = top->resp_next_hop_ip;
+    route.next_hop_port = top->resp_next_hop_port;
+    route.next_hop_qp = top->resp_next_hop_qp;
+    route.next_hop_mac = top->resp_next_hop_mac;
+    return route;
+}
+
+// 仿真前用拓扑模型核对镜像：拓扑中的每个目的地和查询池中的全部地址，返回不一致的次数
+static uint64_t check_image(const y2f_lookup_t* lookup, uint32_t switch_id, const expected_table_t* expected,
+                            const query_pool_t* pool) {
+    std::vector<uint32_t> addresses(pool->keys);
+    addresses.insert(addresses.end(), pool->adversarial.begin(), pool->adversarial.end());
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+    uint64_t mismatches = 0;
+    for (uint32_t dst_ip : addresses) {
+        y2f_route_t route;
+        y2f_lookup(lookup, switch_id, dst_ip, &route);
+        sim_route_t image = route_from_lookup(&route);
+        const sim_route_t* topology = expected_route(expected, dst_ip);
+        if (!same_sim_route(&image, topology)) {
+            if (mismatches < SIM_REPORT_ERRORS) {
+                fprintf(stderr, "镜像与拓扑不一致: Switch %u 查询 0x%08X: 镜像 found=%u port=%u next_hop=0x%08X "
+                                "default=%u (条目%u)，拓扑 found=%u port=%u next_hop=0x%08X default=%u\n",
+                        switch_id, dst_ip, image.found, image.out_port, image.next_hop_ip,
+                        image.is_default_route, route.entry_addr, topology->found, topology->out_port,
+                        topology->next_hop_ip, topology->is_default_route);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// expected 为 NULL 时（.bin 输入）响应与同一镜像上的 y2f_lookup 核对
+static int simulate_switch(const char* hex_file, const y2f_lookup_t* lookup, uint32_t switch_id,
+                           uint32_t entry_count, const expected_table_t* expected, uint64_t query_count,
+                           uint32_t bubble_percent, uint64_t seed, sim_result_t* result) {
+    std::string table_arg = std::string("+routing_table=") + hex_file;
+    std::string switch_arg = "+switch_id=" + std::to_string(switch_id);
+    const char* args[] = {"sim_router", table_arg.c_str(), switch_arg.c_str()};
+
+    *result = sim_result_t();
+    std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    context->commandArgs(3, args);
+    std::unique_ptr<Vrouter> top(new Vrouter(context.get()));
+
+    query_pool_t pool;
+    build_query_pool(lookup, switch_id, entry_count, expected, &pool);
+    if (expected) {
+        uint64_t wrong = check_image(lookup, switch_id, expected, &pool);
+        if (wrong != 0) {
+            fprintf(stderr, "错误: Switch %u 的镜像有 %llu 处与拓扑不一致，不能作为黄金模型，跳过仿真\n",
+                    switch_id, (unsigned long long)wrong);
+            return -1;
+        }
+    }
+
+    // 复位后等待 router_reader 把本交换机的表写入查找引擎
+    top->rst_n = 0;
+    top->lookup_valid = 0;
+    top->lookup_dst_ip = 0;
+    for (int i = 0; i < SIM_RESET_CYCLES; i++) {
+        tick(context.get(), top.get());
+    }
+    top->rst_n = 1;
+    uint64_t init_cycles = 0;
+    while (!top->init_done && !top->init_error && init_cycles < SIM_INIT_TIMEOUT) {
+        tick(context.get(), top.get());
+        init_cycles++;
+    }
+    if (!top->init_done) {
+        fprintf(stderr, "错误: Switch %u 初始化%s (%llu周期)\n", switch_id,
+                top->init_error ? "失败" : "超时", (unsigned long long)init_cycles);
+        top->final();
+        return -1;
+    }
+
+    // 查询按发送顺序返回（流水线无乱序），用队列配对
+    std::deque<pending_query_t> pending;
+    uint64_t cycle = 0;
+    uint64_t issued = 0;
+    uint64_t first_issue = 0;
+    uint64_t last_issue = 0;
+    uint64_t last_response = 0;
+    uint64_t idle_since = 0;
+    uint64_t min_latency = 0;
+    bool responded = false;
+    uint32_t previous = pool.keys[0];
+    int status = 0;
+
+    while (issued < query_count || !pending.empty()) {
+        bool issue = issued < query_count &&
+                     (bubble_percent == 0 || next_random(&seed) % 100 >= bubble_percent);
+        if (issue) {
+            previous = next_query(&pool, &seed, previous);
+        }
+        top->lookup_valid = issue;
+        top->lookup_dst_ip = issue ? previous : 0;
+        tick(context.get(), top.get());
+        cycle++;
+
+        if (issue) {
+            pending.push_back({previous, cycle});
+            if (issued == 0) {
+                first_issue = cycle;
+            }
+            last_issue = cycle;
+            issued++;
+        }
+
+        if (top->resp_valid) {
+            if (pending.empty()) {
+                fprintf(stderr, "错误: Switch %u 在周期 %llu 出现多余的响应\n",
+                        switch_id, (unsigned long long)cycle);
+                status = -1;
+                break;
+            }
+            pending_query_t query = pending.front();
+            pending.pop_front();
+            responded = true;
+            last_response = cycle;
+            idle_since = cycle;
+            // 延迟按时钟沿计：发送查询的时钟沿到输出响应的时钟沿（含两端）
+            uint64_t latency = cycle - query.issue_cycle + 1;
+            result->latency[latency]++;
+            min_latency = (min_latency == 0 || latency < min_latency) ? latency : min_latency;
+
+            sim_route_t golden;
+            if (expected) {
+                golden = *expected_route(expected, query.dst_ip);
+            } else {
+                y2f_route_t route;
+                y2f_lookup(lookup, switch_id, query.dst_ip, &route);
+                golden = route_from_lookup(&route);
+            }
+            sim_route_t actual = route_from_response(top.get());
+            if (!same_sim_route(&actual, &golden)) {
+                if (result->mismatches < SIM_REPORT_ERRORS) {
+                    fprintf(stderr, "不一致: Switch %u 查询 0x%08X: 硬件 found=%u port=%u next_hop=0x%08X default=%u，"
+                                    "期望 found=%u port=%u next_hop=0x%08X default=%u\n",
+                            switch_id, query.dst_ip, actual.found, actual.out_port, actual.next_hop_ip,
+                            actual.is_default_route, golden.found, golden.out_port, golden.next_hop_ip,
+                            golden.is_default_route);
+                }
+                result->mismatches++;
+            }
+        } else if (!pending.empty()) {
+            // 输入空闲造成的响应间隙不算停顿
+            if (responded && cycle - pending.front().issue_cycle + 1 >= min_latency) {
+                result->stall_cycles++;
+            }
+            if (cycle - (responded ? idle_since : pending.front().issue_cycle) > SIM_DRAIN_TIMEOUT) {
+                fprintf(stderr, "错误: Switch %u 有 %zu 个查询在 %d 周期内没有响应\n",
+                        switch_id, pending.size(), SIM_DRAIN_TIMEOUT);
+                status = -1;
+                break;
+            }
+        }
+    }
+
+    top->final();
+    result->queries = issued;
+    result->issue_cycles = issued ? last_issue - first_issue + 1 : 0;
+    result->cycles = responded ? last_response - first_issue + 1 : 0;
+    return status != 0 || result->mismatches != 0 ? -1 : 0;
+}
+
+static void print_latency(const sim_result_t* result) {
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    for (const auto& bucket : result->latency) {
+        total += bucket.second;
+        sum += bucket.first * bucket.second;
+    }
+    if (total == 0) {
+        return;
+    }
+    printf("  延迟: 最小 %llu, 平均 %.2f, 最大 %llu 周期\n",
+           (unsigned long long)result->latency.begin()->first, (double)sum / (double)total,
+           (unsigned long long)result->latency.rbegin()->first);
+    for (const auto& bucket : result->latency) {
+        printf("    %4llu 周期: %llu (%.2f%%)\n", (unsigned long long)bucket.first,
+               (unsigned long long)bucket.second, 100.0 * (double)bucket.second / (double)total);
+    }
+}
+
+static void print_usage(const char* program_name) {
+    printf("用法: %s [选项] <拓扑.yaml | 镜像.bin>\n\n", program_name);
+    printf("选项:\n");
+    printf("  -n N        每个交换机发送的查询数 (默认: 1000000)\n");
+    printf("  -s ID       只仿真该交换机 (默认: 所有放得进查找引擎的交换机)\n");
+    printf("  -b P        每周期以P%%的概率不发送查询，模拟非满载输入 (默认: 0)\n");
+    printf("  -r SEED     随机种子 (默认: 1)\n");
+    printf("  --compress  YAML输入时做前缀聚合 (需以 SIM_MASKED=1 编译)\n");
+    printf("模型参数: MEM_SIZE=%d字, MAX_ENTRIES=%d, MASKED_MATCH=%d, HASH_BUCKETS=%d\n",
+           SIM_MEM_WORDS, SIM_MAX_ENTRIES, SIM_MASKED, SIM_HASH_BUCKETS);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t query_count = 1000000;
+    uint32_t only_switch = 0;
+    uint32_t bubble_percent = 0;
+    uint64_t seed = 1;
+    bool compress = false;
+    const char* input = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-n") == 0 && has_value) {
+            query_count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && has_value) {
+            only_switch = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-b") == 0 && has_value) {
+            bubble_percent = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-r") == 0 && has_value) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!input || query_count == 0 || bubble_percent >= 100) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // 加载或生成镜像
+    std::vector<uint8_t> image;
+    size_t input_len = strlen(input);
+    bool is_yaml = (input_len >= 5 && strcmp(input + input_len - 5, ".yaml") == 0) ||
+                   (input_len >= 4 && strcmp(input + input_len - 4, ".yml") == 0);
+    if ((is_yaml ? build_image(input, compress, &image) : read_file(input, &image)) != 0) {
+        return 1;
+    }
+    if (image.size() > (size_t)SIM_MEM_WORDS * 4) {
+        fprintf(stderr, "错误: 镜像 %zu 字节超出ROM容量 %d 字节，请以更大的 SIM_MEM_WORDS 编译\n",
+                image.size(), SIM_MEM_WORDS * 4);
+        return 1;
+    }
+
+    y2f_lookup_t* lookup = NULL;
+    y2f_error_t error;
+    if (y2f_lookup_open_buffer(image.data(), image.size(), &lookup, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: %s\n", error.message);
+        return 1;
+    }
+
+    char hex_file[] = "/tmp/sim_router_XXXXXX";
+    if (write_hex(image, hex_file) != 0) {
+        y2f_lookup_close(lookup);
+        return 1;
+    }
+
+    // YAML输入由拓扑推导期望结果
+    topology_model_t model;
+    if (is_yaml && load_topology_model(input, &model) != 0) {
+        cleanup_topology(&model.config);
+        unlink(hex_file);
+        y2f_lookup_close(lookup);
+        return 1;
+    }
+
+    printf("=== router 协同仿真 ===\n");
+    printf("镜像: %s (%zu字节, %u个交换机)，每交换机 %llu 次查询，空闲 %u%%\n", input, image.size(),
+           y2f_lookup_switch_count(lookup), (unsigned long long)query_count, bubble_percent);
+
+    int status = 0;
+    uint32_t simulated = 0;
+    uint64_t total_queries = 0;
+    uint64_t total_cycles = 0;
+    uint64_t total_stalls = 0;
+    for (uint32_t i = 0; i < y2f_lookup_switch_count(lookup); i++) {
+        uint32_t switch_id;
+        uint32_t entry_count;
+        y2f_lookup_table_info(lookup, i, &switch_id, &entry_count);
+        if (only_switch && switch_id != only_switch) {
+            continue;
+        }
+
+        // 超出 router_reader/router_searcher 寻址范围的表无法装入，跳过
+        bool wildcard = false;
+        for (uint32_t addr = 0; addr < entry_count; addr++) {
+            y2f_route_t route;
+            y2f_lookup_entry(lookup, switch_id, addr, &route);
+            wildcard |= route.prefix_wildcard != 0;
+        }
+        const char* reason = switch_id > SIM_MAX_SWITCH_ID ? "交换机ID超出4位"
+                           : (SIM_HASH_BUCKETS && entry_count != SIM_TABLE_ENTRIES) ? "不是按 HASH_BUCKETS 排布的表"
+                           : entry_count > SIM_TABLE_ENTRIES ? "条目数超出 MAX_ENTRIES"
+                           : (wildcard && !SIM_MASKED) ? "前缀条目需要 SIM_MASKED=1"
+                           : NULL;
+        if (reason) {
+            printf("Switch %u: 跳过 (%s)\n", switch_id, reason);
+            if (only_switch) {
+                status = -1;
+            }
+            continue;
+        }
+
+        expected_table_t expected;
+        if (is_yaml && expected_for_switch(&model, switch_id, &expected) != 0) {
+            status = -1;
+            continue;
+        }
+        sim_result_t result;
+        int switch_status = simulate_switch(hex_file, lookup, switch_id, entry_count,
+                                            is_yaml ? &expected : NULL, query_count,
+                                            bubble_percent, seed + switch_id, &result);
+        simulated++;
+        total_queries += result.queries;
+        total_cycles += result.cycles;
+        total_stalls += result.stall_cycles;
+        if (result.cycles > 0) {
+            printf("Switch %u: %u条目, %llu次查询, %llu周期, 吞吐 %.4f 查询/周期 (发送窗口 %.4f), "
+                   "停顿 %llu 周期, 不一致 %llu\n",
+                   switch_id, entry_count, (unsigned long long)result.queries,
+                   (unsigned long long)result.cycles, (double)result.queries / (double)result.cycles,
+                   (double)result.queries / (double)result.issue_cycles,
+                   (unsigned long long)result.stall_cycles, (unsigned long long)result.mismatches);
+            print_latency(&result);
+        }
+        status |= switch_status;
+    }
+
+    unlink(hex_file);
+    y2f_lookup_close(lookup);
+    if (is_yaml) {
+        cleanup_topology(&model.config);
+    }
+
+    if (simulated == 0) {
+        fprintf(stderr, "错误: 没有可仿真的交换机\n");
+        return 1;
+    }
+    printf("\n合计: %u个交换机, %llu次查询, 吞吐 %.4f 查询/周期, 停顿 %llu 周期 — %s\n", simulated,
+           (unsigned long long)total_queries,
+           total_cycles ? (double)total_queries / (double)total_cycles : 0.0,
+           (unsigned long long)total_stalls, status == 0 ? "全部一致" : "失败");
+    return status == 0 ? 0 : 1;
+}
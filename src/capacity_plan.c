@@ -0,0 +1,88 @@
+#include "yaml2fpga.h"
+
+// ============ 容量规划 ============
+// 查找表按 MAX_ENTRIES 综合：CAM 为寄存器+比较器，条目存放在BRAM中。
+// 资源按 README "FPGA资源需求" 表的线性模型估算：
+//   CAM 约 12.5 LUTs/条目，BRAM36 约 MAX_ENTRIES/32 块（每块36Kb）
+// 哈希查找表（--hash-buckets）没有CAM，每张表的 2N+1 个槽位按同样的BRAM模型估算
+
+#define CAPACITY_LUTS_PER_ENTRY  12.5
+#define CAPACITY_ENTRIES_PER_BRAM36 32.0
+#define CAPACITY_BRAM36_KB       36.0
+#define CAPACITY_CAM_HINT        64       // 超过后提示改用哈希查找表
+
+// 检查每张路由表是否放得进目标查找表，输出占用率和余量
+// 条目数包含稳定槽位排布留下的空洞（空洞同样占用地址）
+// 任一交换机溢出或BRAM超出预算时返回 -1，调用方据此在写文件前中止
+int check_table_capacity(const routing_tables_t* tables, uint32_t max_entries, uint32_t bram_kb) {
+    uint32_t overflow_count = 0;
+    uint32_t peak_entries = 0;
+    uint32_t peak_switch = 0;
+    double luts = CAPACITY_LUTS_PER_ENTRY * max_entries;
+    double bram36 = max_entries / CAPACITY_ENTRIES_PER_BRAM36;
+    double bram_needed_kb = bram36 * CAPACITY_BRAM36_KB;
+
+    LOG_INFO("\n容量规划 (MAX_ENTRIES=%u):\n", max_entries);
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* table = &tables->tables[i];
+        double occupancy = max_entries ? 100.0 * table->entry_count / max_entries : 0.0;
+
+        if (table->entry_count > peak_entries || i == 0) {
+            peak_entries = table->entry_count;
+            peak_switch = table->switch_id;
+        }
+        if (table->entry_count > max_entries) {
+            overflow_count++;
+            LOG_ERROR("错误: Switch %u 路由表有 %u 条目，超出查找表容量 %u (溢出 %u)\n",
+                      table->switch_id, table->entry_count, max_entries,
+                      table->entry_count - max_entries);
+            continue;
+        }
+        LOG_INFO("  Switch %u: %u/%u 条目 (占用 %.1f%%, 余量 %u)\n", table->switch_id,
+                 table->entry_count, max_entries, occupancy, max_entries - table->entry_count);
+    }
+
+    LOG_INFO("最大占用: Switch %u, %u/%u 条目\n", peak_switch, peak_entries, max_entries);
+    LOG_INFO("资源估算 (每个交换机): CAM 约 %.0f LUTs, BRAM36 %.1f 块 (%.0f Kb)\n",
+             luts, bram36, bram_needed_kb);
+
+    if (max_entries > CAPACITY_CAM_HINT) {
+        LOG_INFO("提示: CAM的LUT用量随 MAX_ENTRIES 线性增长，大表可用 --hash-buckets 改用 router_searcher_hash\n");
+    }
+
+    int result = 0;
+    if (bram_kb > 0) {
+        if (bram_needed_kb > bram_kb) {
+            LOG_ERROR("错误: 查找表需要 %.0f Kb BRAM，超出预算 %u Kb\n", bram_needed_kb, bram_kb);
+            result = -1;
+        } else {
+            LOG_INFO("BRAM预算: %.0f/%u Kb (余量 %.0f Kb)\n", bram_needed_kb, bram_kb,
+                     bram_kb - bram_needed_kb);
+        }
+    }
+    if (overflow_count > 0) {
+        LOG_ERROR("错误: %u 个交换机的路由表超出查找表容量，未写出镜像"
+                  "（可尝试 --compress 或增大 --max-entries）\n", overflow_count);
+        result = -1;
+    }
+    return result;
+}
+
+// 哈希查找表的资源估算与BRAM预算检查（容量本身由 place_hash_tables 排布时检查）
+int check_hash_capacity(uint32_t buckets, uint32_t bram_kb) {
+    uint32_t slots = buckets * 2 + 1;
+    double bram36 = slots / CAPACITY_ENTRIES_PER_BRAM36;
+    double bram_needed_kb = bram36 * CAPACITY_BRAM36_KB;
+
+    LOG_INFO("资源估算 (每个交换机): 哈希查找表 %u 槽位, BRAM36 %.1f 块 (%.0f Kb)\n",
+             slots, bram36, bram_needed_kb);
+    if (bram_kb > 0) {
+        if (bram_needed_kb > bram_kb) {
+            LOG_ERROR("错误: 查找表需要 %.0f Kb BRAM，超出预算 %u Kb\n", bram_needed_kb, bram_kb);
+            return -1;
+        }
+        LOG_INFO("BRAM预算: %.0f/%u Kb (余量 %.0f Kb)\n", bram_needed_kb, bram_kb,
+                 bram_kb - bram_needed_kb);
+    }
+    return 0;
+}
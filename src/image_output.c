@@ -0,0 +1,493 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/stat.h>
+
+// ============ CRC32（IEEE 802.3，反射多项式0xEDB88320）============
+
+static const uint32_t crc32_table[256] = {
+    0x00000000u, 0x77073096u, 0xee0e612cu, 0x990951bau, 0x076dc419u, 0x706af48fu,
+    0xe963a535u, 0x9e6495a3u, 0x0edb8832u, 0x79dcb8a4u, 0xe0d5e91eu, 0x97d2d988u,
+    0x09b64c2bu, 0x7eb17cbdu, 0xe7b82d07u, 0x90bf1d91u, 0x1db71064u, 0x6ab020f2u,
+    0xf3b97148u, 0x84be41deu, 0x1adad47du, 0x6ddde4ebu, 0xf4d4b551u, 0x83d385c7u,
+    0x136c9856u, 0x646ba8c0u, 0xfd62f97au, 0x8a65c9ecu, 0x14015c4fu, 0x63066cd9u,
+    0xfa0f3d63u, 0x8d080df5u, 0x3b6e20c8u, 0x4c69105eu, 0xd56041e4u, 0xa2677172u,
+    0x3c03e4d1u, 0x4b04d447u, 0xd20d85fdu, 0xa50ab56bu, 0x35b5a8fau, 0x42b2986cu,
+    0xdbbbc9d6u, 0xacbcf940u, 0x32d86ce3u, 0x45df5c75u, 0xdcd60dcfu, 0xabd13d59u,
+    0x26d930acu, 0x51de003au, 0xc8d75180u, 0xbfd06116u, 0x21b4f4b5u, 0x56b3c423u,
+    0xcfba9599u, 0xb8bda50fu, 0x2802b89eu, 0x5f058808u, 0xc60cd9b2u, 0xb10be924u,
+    0x2f6f7c87u, 0x58684c11u, 0xc1611dabu, 0xb6662d3du, 0x76dc4190u, 0x01db7106u,
+    0x98d220bcu, 0xefd5102au, 0x71b18589u, 0x06b6b51fu, 0x9fbfe4a5u, 0xe8b8d433u,
+    0x7807c9a2u, 0x0f00f934u, 0x9609a88eu, 0xe10e9818u, 0x7f6a0dbbu, 0x086d3d2du,
+    0x91646c97u, 0xe6635c01u, 0x6b6b51f4u, 0x1c6c6162u, 0x856530d8u, 0xf262004eu,
+    0x6c0695edu, 0x1b01a57bu, 0x8208f4c1u, 0xf50fc457u, 0x65b0d9c6u, 0x12b7e950u,
+    0x8bbeb8eau, 0xfcb9887cu, 0x62dd1ddfu, 0x15da2d49u, 0x8cd37cf3u, 0xfbd44c65u,
+    0x4db26158u, 0x3ab551ceu, 0xa3bc0074u, 0xd4bb30e2u, 0x4adfa541u, 0x3dd895d7u,
+    0xa4d1c46du, 0xd3d6f4fbu, 0x4369e96au, 0x346ed9fcu, 0xad678846u, 0xda60b8d0u,
+    0x44042d73u, 0x33031de5u, 0xaa0a4c5fu, 0xdd0d7cc9u, 0x5005713cu, 0x270241aau,
+    0xbe0b1010u, 0xc90c2086u, 0x5768b525u, 0x206f85b3u, 0xb966d409u, 0xce61e49fu,
+    0x5edef90eu, 0x29d9c998u, 0xb0d09822u, 0xc7d7a8b4u, 0x59b33d17u, 0x2eb40d81u,
+    0xb7bd5c3bu, 0xc0ba6cadu, 0xedb88320u, 0x9abfb3b6u, 0x03b6e20cu, 0x74b1d29au,
+    0xead54739u, 0x9dd277afu, 0x04db2615u, 0x73dc1683u, 0xe3630b12u, 0x94643b84u,
+    0x0d6d6a3eu, 0x7a6a5aa8u, 0xe40ecf0bu, 0x9309ff9du, 0x0a00ae27u, 0x7d079eb1u,
+    0xf00f9344u, 0x8708a3d2u, 0x1e01f268u, 0x6906c2feu, 0xf762575du, 0x806567cbu,
+    0x196c3671u, 0x6e6b06e7u, 0xfed41b76u, 0x89d32be0u, 0x10da7a5au, 0x67dd4accu,
+    0xf9b9df6fu, 0x8ebeeff9u, 0x17b7be43u, 0x60b08ed5u, 0xd6d6a3e8u, 0xa1d1937eu,
+    0x38d8c2c4u, 0x4fdff252u, 0xd1bb67f1u, 0xa6bc5767u, 0x3fb506ddu, 0x48b2364bu,
+    0xd80d2bdau, 0xaf0a1b4cu, 0x36034af6u, 0x41047a60u, 0xdf60efc3u, 0xa867df55u,
+    0x316e8eefu, 0x4669be79u, 0xcb61b38cu, 0xbc66831au, 0x256fd2a0u, 0x5268e236u,
+    0xcc0c7795u, 0xbb0b4703u, 0x220216b9u, 0x5505262fu, 0xc5ba3bbeu, 0xb2bd0b28u,
+    0x2bb45a92u, 0x5cb36a04u, 0xc2d7ffa7u, 0xb5d0cf31u, 0x2cd99e8bu, 0x5bdeae1du,
+    0x9b64c2b0u, 0xec63f226u, 0x756aa39cu, 0x026d930au, 0x9c0906a9u, 0xeb0e363fu,
+    0x72076785u, 0x05005713u, 0x95bf4a82u, 0xe2b87a14u, 0x7bb12baeu, 0x0cb61b38u,
+    0x92d28e9bu, 0xe5d5be0du, 0x7cdcefb7u, 0x0bdbdf21u, 0x86d3d2d4u, 0xf1d4e242u,
+    0x68ddb3f8u, 0x1fda836eu, 0x81be16cdu, 0xf6b9265bu, 0x6fb077e1u, 0x18b74777u,
+    0x88085ae6u, 0xff0f6a70u, 0x66063bcau, 0x11010b5cu, 0x8f659effu, 0xf862ae69u,
+    0x616bffd3u, 0x166ccf45u, 0xa00ae278u, 0xd70dd2eeu, 0x4e048354u, 0x3903b3c2u,
+    0xa7672661u, 0xd06016f7u, 0x4969474du, 0x3e6e77dbu, 0xaed16a4au, 0xd9d65adcu,
+    0x40df0b66u, 0x37d83bf0u, 0xa9bcae53u, 0xdebb9ec5u, 0x47b2cf7fu, 0x30b5ffe9u,
+    0xbdbdf21cu, 0xcabac28au, 0x53b39330u, 0x24b4a3a6u, 0xbad03605u, 0xcdd70693u,
+    0x54de5729u, 0x23d967bfu, 0xb3667a2eu, 0xc4614ab8u, 0x5d681b02u, 0x2a6f2b94u,
+    0xb40bbe37u, 0xc30c8ea1u, 0x5a05df1bu, 0x2d02ef8du
+};
+
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = data;
+    crc = ~crc;
+    while (len--) {
+        crc = crc32_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// ============ 镜像序列化 ============
+
+// 计算镜像总字节数（v1: 连续DEST表流；v2: 镜像头 + 目录 + DEST表流）
+size_t routing_image_size(const routing_tables_t* tables, uint32_t image_version) {
+    size_t size = 0;
+
+    if (image_version == FPGA_IMAGE_VERSION) {
+        size += sizeof(fpga_image_header_t) + sizeof(fpga_dir_record_t) * tables->table_count;
+    }
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        size += sizeof(fpga_dest_table_header_t) +
+                sizeof(fpga_dest_entry_t) * tables->tables[i].entry_count;
+    }
+    return size;
+}
+
+// 将全部路由表序列化到调用者提供的缓冲区，返回写入的字节数（容量不足时返回0）
+// v2镜像的目录偏移与CRC在序列化时直接计算，无需回填
+size_t serialize_routing_image(const routing_tables_t* tables, uint32_t image_version,
+                               uint8_t* buf, size_t capacity) {
+    size_t size = routing_image_size(tables, image_version);
+    size_t pos = 0;
+    fpga_dir_record_t* records = NULL;
+
+    if (size > capacity) {
+        return 0;
+    }
+
+    // v2镜像：镜像头和目录位于文件开头
+    if (image_version == FPGA_IMAGE_VERSION) {
+        pos = sizeof(fpga_image_header_t) + sizeof(fpga_dir_record_t) * tables->table_count;
+        records = (fpga_dir_record_t*)(buf + sizeof(fpga_image_header_t));
+    }
+
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* table = &tables->tables[i];
+        size_t entries_size = sizeof(fpga_dest_entry_t) * table->entry_count;
+
+        size_t table_offset = pos;
+
+        // 写入表头
+        fpga_dest_table_header_t header;
+        header.magic = FPGA_DEST_MAGIC;  // "DEST"
+        header.entry_count = table->entry_count;
+        header.switch_id = table->switch_id;
+        header.reserved = 0;
+        memcpy(buf + pos, &header, sizeof(header));
+        pos += sizeof(header);
+
+        // 写入表条目：由列存储逐条打包为硬件格式
+        uint8_t* entries = buf + pos;
+        for (uint32_t e = 0; e < table->entry_count; e++) {
+            fpga_dest_entry_t entry;
+            route_table_pack(table, e, &entry);
+            memcpy(buf + pos, &entry, sizeof(entry));
+            pos += sizeof(entry);
+        }
+
+        if (records) {
+            fpga_dir_record_t record;
+            record.switch_id = table->switch_id;
+            record.offset = (uint32_t)table_offset;
+            record.entry_count = table->entry_count;
+            record.crc32 = crc32_update(0, entries, entries_size);
+            memcpy(&records[i], &record, sizeof(record));
+        }
+
+        LOG_VERBOSE("已写入Switch %u的路由表: %u条目, %zu字节\n",
+               table->switch_id, table->entry_count, sizeof(header) + entries_size);
+    }
+
+    if (records) {
+        size_t dir_size = sizeof(fpga_dir_record_t) * tables->table_count;
+        fpga_image_header_t header;
+        header.magic = FPGA_IMAGE_MAGIC;
+        header.version = FPGA_IMAGE_VERSION;
+        header.switch_count = tables->table_count;
+        header.dir_crc = crc32_update(0, records, dir_size);
+        memcpy(buf, &header, sizeof(header));
+
+        LOG_INFO("已写入镜像目录: %u个交换机, %zu字节\n",
+               tables->table_count, sizeof(header) + dir_size);
+    }
+
+    return pos;
+}
+
+// ============ 镜像解析 ============
+
+// 读取一张DEST表（表头 + 条目）到 table，条目转换为列存储（分配在 arena 中）
+static int parse_dest_table(const uint8_t* image, size_t size, size_t pos, topo_arena_t* arena,
+                            switch_table_t* table, size_t* next) {
+    fpga_dest_table_header_t header;
+
+    if (size - pos < sizeof(header)) {
+        return -1;
+    }
+    memcpy(&header, image + pos, sizeof(header));
+    pos += sizeof(header);
+
+    if (header.magic != FPGA_DEST_MAGIC ||
+        header.entry_count > (size - pos) / sizeof(fpga_dest_entry_t)) {
+        return -1;
+    }
+
+    size_t entries_size = sizeof(fpga_dest_entry_t) * header.entry_count;
+    table->switch_id = header.switch_id;
+    table->lookups = 0;
+    if (route_table_from_entries(table, arena, image + pos, header.entry_count) != 0) {
+        return -1;
+    }
+    *next = pos + entries_size;
+    return 0;
+}
+
+// 将v1/v2镜像解析为按交换机的路由表（与 serialize_routing_image 互逆）
+// v2镜像会校验目录CRC和各表条目区CRC
+int parse_routing_image(const uint8_t* image, size_t size,
+                        routing_tables_t* tables, uint32_t* image_version) {
+    fpga_image_header_t image_header;
+    uint32_t capacity = 16;
+    size_t pos = 0;
+
+    memset(tables, 0, sizeof(routing_tables_t));
+
+    if (size >= sizeof(image_header)) {
+        memcpy(&image_header, image, sizeof(image_header));
+    } else {
+        image_header.magic = 0;
+    }
+
+    if (image_header.magic == FPGA_IMAGE_MAGIC) {
+        size_t dir_size = sizeof(fpga_dir_record_t) * (size_t)image_header.switch_count;
+        if (image_header.version != FPGA_IMAGE_VERSION ||
+            dir_size > size - sizeof(image_header) ||
+            crc32_update(0, image + sizeof(image_header), dir_size) != image_header.dir_crc) {
+            LOG_ERROR("错误: 镜像目录无效或校验失败\n");
+            return -1;
+        }
+
+        tables->tables = calloc(image_header.switch_count + 1, sizeof(switch_table_t));
+        if (!tables->tables) {
+            LOG_ERROR("错误: 内存分配失败\n");
+            return -1;
+        }
+
+        for (uint32_t i = 0; i < image_header.switch_count; i++) {
+            fpga_dir_record_t record;
+            size_t next;
+            memcpy(&record, image + sizeof(image_header) + sizeof(record) * i, sizeof(record));
+
+            if (record.offset >= size ||
+                parse_dest_table(image, size, record.offset, &tables->arena, &tables->tables[i], &next) != 0 ||
+                tables->tables[i].switch_id != record.switch_id ||
+                tables->tables[i].entry_count != record.entry_count ||
+                crc32_update(0, image + record.offset + sizeof(fpga_dest_table_header_t),
+                             sizeof(fpga_dest_entry_t) * record.entry_count) != record.crc32) {
+                LOG_ERROR("错误: 镜像中Switch %u的路由表无效或校验失败\n", record.switch_id);
+                tables->table_count = i + 1;
+                free_routing_tables(tables);
+                return -1;
+            }
+            tables->table_count = i + 1;
+        }
+
+        *image_version = FPGA_IMAGE_VERSION;
+        return 0;
+    }
+
+    // v1：连续的DEST表流
+    tables->tables = calloc(capacity, sizeof(switch_table_t));
+    if (!tables->tables) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    while (pos < size) {
+        if (tables->table_count == capacity) {
+            switch_table_t* grown = realloc(tables->tables, sizeof(switch_table_t) * capacity * 2);
+            if (!grown) {
+                LOG_ERROR("错误: 内存分配失败\n");
+                free_routing_tables(tables);
+                return -1;
+            }
+            memset(grown + capacity, 0, sizeof(switch_table_t) * capacity);
+            tables->tables = grown;
+            capacity *= 2;
+        }
+
+        if (parse_dest_table(image, size, pos, &tables->arena, &tables->tables[tables->table_count], &pos) != 0) {
+            LOG_ERROR("错误: 镜像偏移 %zu 处的路由表无效\n", pos);
+            free_routing_tables(tables);
+            return -1;
+        }
+        tables->table_count++;
+    }
+
+    *image_version = 1;
+    return 0;
+}
+
+// 读取整个文件到新分配的缓冲区
+int read_file_all(const char* path, uint8_t** data, size_t* len) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        LOG_ERROR("错误: 无法打开文件 %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    size_t capacity = 64 * 1024;
+    size_t used = 0;
+    uint8_t* buf = malloc(capacity);
+    while (buf) {
+        used += fread(buf + used, 1, capacity - used, fp);
+        if (used < capacity) {
+            break;
+        }
+        uint8_t* grown = realloc(buf, capacity * 2);
+        if (!grown) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = grown;
+        capacity *= 2;
+    }
+
+    int failed = !buf || ferror(fp);
+    fclose(fp);
+    if (failed) {
+        LOG_ERROR("错误: 读取文件 %s 失败\n", path);
+        free(buf);
+        return -1;
+    }
+
+    *data = buf;
+    *len = used;
+    return 0;
+}
+
+// ============ 文本格式输出（hex / coe / mif）============
+
+static const char hex_digits[] = "0123456789abcdef";
+
+// 以固定宽度写出十六进制数，返回写入的字符数
+static size_t put_hex(char* out, uint32_t value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = hex_digits[value & 0xF];
+        value >>= 4;
+    }
+    return (size_t)digits;
+}
+
+// 将镜像按32位小端字转换为ROM初始化文本（与 bin2hex.py 的字序一致）
+// 不足4字节的尾部补0；文本缓冲区由调用者 free
+int format_image_text(const uint8_t* image, size_t image_size, image_format_t format,
+                      char** text, size_t* text_len) {
+    size_t word_count = (image_size + 3) / 4;
+    int addr_digits = 1;
+    char header[256];
+    int header_len = 0;
+
+    // MIF地址宽度按最大地址取定长
+    while (addr_digits < 8 && ((uint64_t)1 << (addr_digits * 4)) < word_count) {
+        addr_digits++;
+    }
+
+    switch (format) {
+        case IMAGE_FORMAT_HEX:
+            break;
+        case IMAGE_FORMAT_COE:
+            header_len = snprintf(header, sizeof(header),
+                                  "memory_initialization_radix=16;\n"
+                                  "memory_initialization_vector=\n");
+            break;
+        case IMAGE_FORMAT_MIF:
+            header_len = snprintf(header, sizeof(header),
+                                  "DEPTH = %zu;\n"
+                                  "WIDTH = 32;\n"
+                                  "ADDRESS_RADIX = HEX;\n"
+                                  "DATA_RADIX = HEX;\n"
+                                  "CONTENT\n"
+                                  "BEGIN\n", word_count);
+            break;
+        default:
+            LOG_ERROR("错误: 不支持的文本输出格式 %d\n", (int)format);
+            return -1;
+    }
+
+    // 每行最长：MIF "地址 : 数据;\n"
+    size_t line_max = (size_t)addr_digits + 3 + 8 + 2;
+    char* out = malloc((size_t)header_len + word_count * line_max + 16);
+    if (!out) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    char* p = out;
+    memcpy(p, header, (size_t)header_len);
+    p += header_len;
+
+    for (size_t i = 0; i < word_count; i++) {
+        uint8_t bytes[4] = {0, 0, 0, 0};
+        size_t n = image_size - i * 4 < 4 ? image_size - i * 4 : 4;
+        memcpy(bytes, image + i * 4, n);
+        uint32_t word = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                        ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+
+        if (format == IMAGE_FORMAT_MIF) {
+            p += put_hex(p, (uint32_t)i, addr_digits);
+            memcpy(p, " : ", 3);
+            p += 3;
+        }
+        p += put_hex(p, word, 8);
+        if (format == IMAGE_FORMAT_COE) {
+            *p++ = (i + 1 == word_count) ? ';' : ',';
+        } else if (format == IMAGE_FORMAT_MIF) {
+            *p++ = ';';
+        }
+        *p++ = '\n';
+    }
+
+    if (format == IMAGE_FORMAT_COE && word_count == 0) {
+        *p++ = ';';
+        *p++ = '\n';
+    } else if (format == IMAGE_FORMAT_MIF) {
+        memcpy(p, "END;\n", 5);
+        p += 5;
+    }
+
+    *text = out;
+    *text_len = (size_t)(p - out);
+    return 0;
+}
+
+// ============ 原子文件写入 ============
+
+// umask() 只能以设置再恢复的方式读取，不能在写文件时调用（多线程下不可重入），
+// 因此在程序或库加载时（尚无其他线程）读取一次
+static mode_t output_umask = 022;
+
+static void read_output_umask(void) __attribute__((constructor));
+
+static void read_output_umask(void) {
+    output_umask = umask(0);
+    umask(output_umask);
+}
+
+// 新文件的权限：替换已有文件时沿用其权限，否则与 fopen 创建的文件相同（0666 & ~umask）
+static mode_t output_file_mode(const char* path) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        return st.st_mode & 07777;
+    }
+    return 0666 & ~output_umask;
+}
+
+// 写入同目录下的临时文件，fsync 后 rename 覆盖目标文件，
+// 失败时删除临时文件，目标文件保持原样
+int write_file_atomic(const char* path, const void* data, size_t len) {
+    size_t path_len = strlen(path);
+    char* tmp_path = malloc(path_len + sizeof(".tmpXXXXXX"));
+    char* dir_buf = strdup(path);
+    const uint8_t* p = data;
+    int fd;
+
+    if (!tmp_path || !dir_buf) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(tmp_path);
+        free(dir_buf);
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmpXXXXXX", sizeof(".tmpXXXXXX"));
+
+    mode_t mode = output_file_mode(path);
+    fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        LOG_ERROR("错误: 无法创建临时文件 %s: %s\n", tmp_path, strerror(errno));
+        free(tmp_path);
+        free(dir_buf);
+        return -1;
+    }
+
+    int status = 0;
+    while (status == 0 && len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("错误: 写入文件 %s 失败: %s\n", tmp_path, strerror(errno));
+            status = -1;
+            break;
+        }
+        p += written;
+        len -= (size_t)written;
+    }
+
+    // mkstemp 创建的文件权限为0600，改为目标文件应有的权限
+    if (status == 0 && (fchmod(fd, mode) != 0 || fsync(fd) != 0)) {
+        LOG_ERROR("错误: 同步文件 %s 失败: %s\n", tmp_path, strerror(errno));
+        status = -1;
+    }
+    if (close(fd) != 0 && status == 0) {
+        LOG_ERROR("错误: 关闭文件 %s 失败: %s\n", tmp_path, strerror(errno));
+        status = -1;
+    }
+    if (status == 0 && rename(tmp_path, path) != 0) {
+        LOG_ERROR("错误: 无法替换文件 %s: %s\n", path, strerror(errno));
+        status = -1;
+    }
+
+    if (status == 0) {
+        // 同步目录项，保证 rename 本身落盘（失败不影响已完成的替换）
+        int dir_fd = open(dirname(dir_buf), O_RDONLY);
+        if (dir_fd >= 0) {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+    } else {
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+    free(dir_buf);
+    return status;
+}
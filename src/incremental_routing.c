@@ -0,0 +1,233 @@
+#include "yaml2fpga.h"
+
+// ============ 增量更新：只重建受拓扑变化影响的交换机路由表 ============
+// 交换机的路由表只依赖自身连接（直连Host、上行链路）以及其子树内的Host，
+// 因此连接发生变化的交换机及其全部祖先需要重建，其余交换机直接沿用旧镜像中的表。
+// 交换机集合、根或父子关系变化时视为结构变化，退回完整生成。
+
+// 交换机ID -> 新旧拓扑中的下标（ID不存在时为 TOPO_INDEX_NONE）
+static uint32_t switch_index(const topology_config_t* config, uint32_t switch_id) {
+    return topo_hash_get(&config->index.switch_by_id, switch_id);
+}
+
+static uint32_t parent_id(const topology_config_t* config, uint32_t sw_idx) {
+    uint32_t parent = config->index.parent[sw_idx];
+    return parent == TOPO_INDEX_NONE ? 0 : config->switches[parent].id;
+}
+
+// 检查结构是否一致：交换机ID集合（1..N）、根、父子关系，返回描述不一致原因的字符串
+static const char* structural_change(const topology_config_t* old_config,
+                                     const topology_config_t* config) {
+    if (old_config->switch_count != config->switch_count) {
+        return "交换机数量变化";
+    }
+
+    for (uint32_t id = 1; id <= config->switch_count; id++) {
+        uint32_t new_idx = switch_index(config, id);
+        uint32_t old_idx = switch_index(old_config, id);
+
+        if (new_idx == TOPO_INDEX_NONE || old_idx == TOPO_INDEX_NONE) {
+            return "交换机ID集合变化";
+        }
+        if (config->switches[new_idx].is_root != old_config->switches[old_idx].is_root) {
+            return "根交换机变化";
+        }
+        if (parent_id(config, new_idx) != parent_id(old_config, old_idx)) {
+            return "父子关系变化";
+        }
+    }
+    return NULL;
+}
+
+// 标记交换机及其祖先；遇到已标记的祖先即停止（其上的路径已标记过）
+static void mark_path(const topology_config_t* config, uint32_t sw_idx, bool* affected) {
+    while (sw_idx != TOPO_INDEX_NONE && !affected[sw_idx]) {
+        affected[sw_idx] = true;
+        sw_idx = config->index.parent[sw_idx];
+    }
+}
+
+// 计算受影响的交换机（按新拓扑下标），返回受影响数量
+static uint32_t find_affected_switches(const topology_config_t* old_config,
+                                       const topology_config_t* config,
+                                       bool* affected) {
+    const topology_index_t* index = &config->index;
+    const topology_index_t* old_index = &old_config->index;
+
+    // 1. 连接列表发生变化的交换机
+    for (uint32_t i = 0; i < config->switch_count; i++) {
+        const switch_config_t* sw = &config->switches[i];
+        const switch_config_t* old_sw = &old_config->switches[switch_index(old_config, sw->id)];
+
+        if (sw->connection_count != old_sw->connection_count ||
+            memcmp(SWITCH_CONN(config, sw, 0), SWITCH_CONN(old_config, old_sw, 0),
+                   sizeof(network_connection_t) * sw->connection_count) != 0) {
+            mark_path(config, i, affected);
+        }
+    }
+
+    // 2. Host归属变化（同一IP出现在多个交换机下时，归属取首个出现者）
+    for (uint32_t h = 0; h < index->host_count; h++) {
+        uint32_t ip = index->hosts[h];
+        uint32_t owner = index->owner[topo_hash_get(&index->host_by_ip, ip)];
+        uint32_t old_ref = topo_hash_get(&old_index->host_by_ip, ip);
+
+        if (old_ref == TOPO_INDEX_NONE) {
+            mark_path(config, owner, affected);
+            continue;
+        }
+
+        uint32_t old_owner_id = old_config->switches[old_index->owner[old_ref]].id;
+        if (old_owner_id != config->switches[owner].id) {
+            mark_path(config, owner, affected);
+            mark_path(config, switch_index(config, old_owner_id), affected);
+        }
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < config->switch_count; i++) {
+        count += affected[i];
+    }
+    return count;
+}
+
+// 由旧拓扑的路由表增量构建新拓扑的路由表：受影响的交换机重新构建，其余复制 old_tables 中的表
+// old_tables 必须与 old_config 对应（按交换机ID 1..N 排列），调用后保持不变
+// 返回 0 成功，-1 出错，1 无法增量（结构变化等，原因已输出），后两种情况 tables 为空
+int rebuild_routing_tables(const topology_config_t* old_config,
+                           const topology_config_t* config,
+                           const routing_tables_t* old_tables,
+                           routing_tables_t* tables) {
+    uint32_t switch_count = config->switch_count;
+
+    memset(tables, 0, sizeof(routing_tables_t));
+
+    // 旧表必须与旧拓扑对应（表按交换机ID 1..N 顺序排列）
+    const char* reason = NULL;
+    if (old_tables->table_count != old_config->switch_count) {
+        reason = "旧镜像与旧拓扑的交换机数量不一致";
+    } else {
+        for (uint32_t i = 0; i < old_tables->table_count && !reason; i++) {
+            if (old_tables->tables[i].switch_id != i + 1) {
+                reason = "旧镜像的交换机顺序与拓扑不一致";
+            }
+        }
+    }
+    if (!reason) {
+        reason = structural_change(old_config, config);
+    }
+    if (reason) {
+        LOG_INFO("无法增量更新 (%s)，执行完整生成\n", reason);
+        return 1;
+    }
+
+    bool* affected = calloc(switch_count + 1, sizeof(bool));
+    tables->table_count = switch_count;
+    tables->tables = calloc(switch_count + 1, sizeof(switch_table_t));
+    if (!affected || !tables->tables) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(affected);
+        free_routing_tables(tables);
+        return -1;
+    }
+
+    uint32_t rebuild_count = find_affected_switches(old_config, config, affected);
+    int status = 0;
+
+    // 只为受影响的交换机运行路由规划与构建
+    if (rebuild_count > 0) {
+        routing_plan_t plan;
+        route_builder_t builder;
+        if (routing_plan_build(config, &plan) != 0) {
+            status = -1;
+        } else if (route_builder_init(&builder, config) != 0) {
+            routing_plan_free(&plan);
+            status = -1;
+        } else {
+            tables->plan_lookups = plan.lookups;
+            for (uint32_t id = 1; id <= switch_count && status == 0; id++) {
+                if (!affected[switch_index(config, id)]) {
+                    continue;
+                }
+                if (routing_plan_emit_table(&plan, id, &builder, &tables->tables[id - 1], stdout) != 0) {
+                    LOG_ERROR("错误: 构建Switch %u路由表失败\n", id);
+                    status = -1;
+                }
+            }
+            topo_arena_merge(&tables->arena, &builder.arena);
+            route_builder_free(&builder);
+            routing_plan_free(&plan);
+        }
+    }
+
+    // 未受影响的交换机沿用旧表，并输出变更列表
+    uint32_t changed_count = 0;
+    if (status == 0) {
+        LOG_INFO("\n变更列表:\n");
+    }
+    for (uint32_t id = 1; id <= switch_count && status == 0; id++) {
+        switch_table_t* table = &tables->tables[id - 1];
+        const switch_table_t* old_table = &old_tables->tables[id - 1];
+
+        if (!affected[switch_index(config, id)]) {
+            status = route_table_copy(table, &tables->arena, old_table);
+            LOG_VERBOSE("  Switch %u: 未受影响\n", id);
+        } else if (route_table_equal(table, old_table)) {
+            LOG_VERBOSE("  Switch %u: 已重建，内容未变\n", id);
+        } else {
+            changed_count++;
+            LOG_INFO("  Switch %u: 已变更 (%u -> %u 条目)\n", id, old_table->entry_count, table->entry_count);
+        }
+    }
+    free(affected);
+
+    if (status != 0) {
+        free_routing_tables(tables);
+        return -1;
+    }
+    LOG_INFO("增量更新: 重建 %u/%u 个交换机路由表，其中 %u 个发生变化\n",
+             rebuild_count, switch_count, changed_count);
+    return 0;
+}
+
+int generate_incremental_routing_binary(const topology_config_t* old_config,
+                                        const topology_config_t* config,
+                                        const char* prev_image_filename,
+                                        const char* output_filename,
+                                        const generate_options_t* options) {
+    run_stats_t* stats = options ? options->stats : NULL;
+    uint8_t* prev_image = NULL;
+    size_t prev_size = 0;
+    routing_tables_t old_tables;
+    routing_tables_t tables;
+    uint32_t old_version;
+
+    LOG_INFO("\n开始增量生成统一路由表...\n");
+
+    if (read_file_all(prev_image_filename, &prev_image, &prev_size) != 0) {
+        return -1;
+    }
+    int parsed = parse_routing_image(prev_image, prev_size, &old_tables, &old_version);
+    free(prev_image);
+    if (parsed != 0) {
+        LOG_ERROR("错误: 无法解析旧镜像 %s\n", prev_image_filename);
+        return -1;
+    }
+
+    double t_route = stats_now_ms();
+    int status = rebuild_routing_tables(old_config, config, &old_tables, &tables);
+    free_routing_tables(&old_tables);
+    if (status == 1) {
+        return generate_unified_routing_binary(config, output_filename, options);
+    }
+
+    if (status == 0) {
+        if (stats) {
+            stats->route_ms = stats_now_ms() - t_route;
+        }
+        status = write_routing_tables(&tables, output_filename, options);
+    }
+
+    free_routing_tables(&tables);
+    return status;
+}
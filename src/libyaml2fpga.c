@@ -0,0 +1,402 @@
+#include "yaml2fpga.h"
+#include "libyaml2fpga.h"
+
+// ============ 库接口（libyaml2fpga.h）============
+// 每个入口在调用线程上安装错误收集器：内部代码照常调用 LOG_ERROR，
+// 错误记录到本次调用的收集器并返回给调用者，进度日志关闭
+
+struct y2f_topology {
+    topology_config_t config;
+};
+
+struct y2f_tables {
+    routing_tables_t tables;
+};
+
+struct y2f_lookup {
+    route_lookup_t lookup;
+};
+
+typedef struct {
+    error_sink_t sink;
+    error_sink_t* saved;             // 嵌套调用时恢复外层收集器
+} api_scope_t;
+
+static void api_enter(api_scope_t* scope) {
+    memset(&scope->sink, 0, sizeof(error_sink_t));
+    pthread_mutex_init(&scope->sink.lock, NULL);
+    scope->saved = yaml2fpga_error_sink;
+    yaml2fpga_error_sink = &scope->sink;
+}
+
+// 结束调用：把返回码和首条错误写入 error（可为NULL），返回 code
+static int api_leave(api_scope_t* scope, int code, y2f_error_t* error) {
+    yaml2fpga_error_sink = scope->saved;
+    pthread_mutex_destroy(&scope->sink.lock);
+
+    if (error) {
+        error->code = code;
+        error->message[0] = '\0';
+        if (code != Y2F_OK) {
+            const char* message = scope->sink.count > 0 ? scope->sink.message : y2f_strerror(code);
+            snprintf(error->message, sizeof(error->message), "%s", message);
+        }
+    }
+    return code;
+}
+
+const char* y2f_strerror(int code) {
+    switch (code) {
+        case Y2F_OK:           return "成功";
+        case Y2F_ERR_PARSE:    return "YAML解析失败";
+        case Y2F_ERR_INVALID:  return "拓扑无效";
+        case Y2F_ERR_NOMEM:    return "内存分配失败";
+        case Y2F_ERR_ARGUMENT: return "参数无效";
+        case Y2F_ERR_CAPACITY: return "路由表超出查找表容量";
+        case Y2F_ERR_BUFFER:   return "缓冲区不足";
+        default:               return "未知错误";
+    }
+}
+
+// ============ 拓扑 ============
+
+int y2f_topology_parse(const char* data, size_t len, y2f_topology_t** topology, y2f_error_t* error) {
+    api_scope_t scope;
+    int code = Y2F_OK;
+
+    api_enter(&scope);
+    if (!data || !topology) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+    *topology = NULL;
+
+    y2f_topology_t* topo = calloc(1, sizeof(y2f_topology_t));
+    if (!topo) {
+        return api_leave(&scope, Y2F_ERR_NOMEM, error);
+    }
+
+    int result = parse_yaml_topology_buffer(data, len, &topo->config);
+    if (result != SUCCESS) {
+        code = result == ERR_YAML_PARSE ? Y2F_ERR_PARSE : Y2F_ERR_INVALID;
+    } else if (validate_topology(&topo->config) != SUCCESS) {
+        code = Y2F_ERR_INVALID;
+    } else if (build_topology_index(&topo->config) != 0) {
+        code = Y2F_ERR_NOMEM;
+    }
+
+    if (code != Y2F_OK) {
+        // 解析失败时 parse_yaml_topology_buffer 已自行清理
+        if (result == SUCCESS) {
+            cleanup_topology(&topo->config);
+        }
+        free(topo);
+        return api_leave(&scope, code, error);
+    }
+
+    *topology = topo;
+    return api_leave(&scope, Y2F_OK, error);
+}
+
+void y2f_topology_free(y2f_topology_t* topology) {
+    if (!topology) {
+        return;
+    }
+    cleanup_topology(&topology->config);
+    free(topology);
+}
+
+uint32_t y2f_topology_switch_count(const y2f_topology_t* topology) {
+    return topology ? topology->config.switch_count : 0;
+}
+
+uint32_t y2f_topology_host_count(const y2f_topology_t* topology) {
+    return topology ? topology->config.index.host_count : 0;
+}
+
+// ============ 路由表 ============
+
+int y2f_tables_build(const y2f_topology_t* topology, const y2f_options_t* options,
+                     y2f_tables_t** tables, y2f_error_t* error) {
+    api_scope_t scope;
+    generate_options_t gen_options;
+
+    api_enter(&scope);
+    if (!topology || !tables) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+    *tables = NULL;
+
+    memset(&gen_options, 0, sizeof(gen_options));
+    if (options) {
+        gen_options.jobs = options->jobs;
+        gen_options.compress = options->compress != 0;
+        gen_options.max_entries = options->max_entries;
+        gen_options.bram_kb = options->bram_kb;
+        gen_options.hash_buckets = options->hash_buckets;
+    }
+    // 与命令行一致：哈希桶数须为2的幂，且不与聚合、容量检查同时使用
+    uint32_t buckets = gen_options.hash_buckets;
+    if (buckets && (buckets < HASH_BUCKETS_MIN || buckets > HASH_BUCKETS_MAX || (buckets & (buckets - 1)) != 0 ||
+                    gen_options.compress || gen_options.max_entries)) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+    // 与命令行一致：只给出BRAM预算时按64条目的查找表检查
+    if (gen_options.bram_kb && !gen_options.max_entries && !buckets) {
+        gen_options.max_entries = 64;
+    }
+
+    y2f_tables_t* result = calloc(1, sizeof(y2f_tables_t));
+    if (!result) {
+        return api_leave(&scope, Y2F_ERR_NOMEM, error);
+    }
+
+    int code = Y2F_OK;
+    if (build_all_routing_tables(&topology->config, &gen_options, &result->tables) != 0) {
+        free(result);
+        return api_leave(&scope, Y2F_ERR_INVALID, error);
+    }
+    if (gen_options.compress && compress_routing_tables(&result->tables) != 0) {
+        code = Y2F_ERR_NOMEM;
+    } else if (buckets && place_hash_tables(&result->tables, buckets) != 0) {
+        code = Y2F_ERR_CAPACITY;
+    } else if (buckets && check_hash_capacity(buckets, gen_options.bram_kb) != 0) {
+        code = Y2F_ERR_CAPACITY;
+    } else if (gen_options.max_entries &&
+               check_table_capacity(&result->tables, gen_options.max_entries, gen_options.bram_kb) != 0) {
+        code = Y2F_ERR_CAPACITY;
+    }
+    if (code != Y2F_OK) {
+        y2f_tables_free(result);
+        return api_leave(&scope, code, error);
+    }
+
+    *tables = result;
+    return api_leave(&scope, Y2F_OK, error);
+}
+
+void y2f_tables_free(y2f_tables_t* tables) {
+    if (!tables) {
+        return;
+    }
+    free_routing_tables(&tables->tables);
+    free(tables);
+}
+
+uint32_t y2f_tables_count(const y2f_tables_t* tables) {
+    return tables ? tables->tables.table_count : 0;
+}
+
+int y2f_table_info(const y2f_tables_t* tables, uint32_t index,
+                   uint32_t* switch_id, uint32_t* entry_count) {
+    if (!tables || index >= tables->tables.table_count) {
+        return Y2F_ERR_ARGUMENT;
+    }
+    if (switch_id) {
+        *switch_id = tables->tables.tables[index].switch_id;
+    }
+    if (entry_count) {
+        *entry_count = tables->tables.tables[index].entry_count;
+    }
+    return Y2F_OK;
+}
+
+int y2f_table_entries(const y2f_tables_t* tables, uint32_t index,
+                      void* entries, size_t capacity, size_t* required, y2f_error_t* error) {
+    api_scope_t scope;
+
+    api_enter(&scope);
+    if (!tables || index >= tables->tables.table_count) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+
+    const switch_table_t* table = &tables->tables.tables[index];
+    size_t size = sizeof(fpga_dest_entry_t) * table->entry_count;
+    if (required) {
+        *required = size;
+    }
+    if (!entries || capacity < size) {
+        return api_leave(&scope, Y2F_ERR_BUFFER, error);
+    }
+
+    // 调用者的内存不保证对齐，逐条打包后拷贝
+    for (uint32_t i = 0; i < table->entry_count; i++) {
+        fpga_dest_entry_t entry;
+        route_table_pack(table, i, &entry);
+        memcpy((uint8_t*)entries + sizeof(entry) * i, &entry, sizeof(entry));
+    }
+    return api_leave(&scope, Y2F_OK, error);
+}
+
+// ============ 镜像序列化 ============
+
+int y2f_image_serialize(const y2f_tables_t* tables, const y2f_options_t* options,
+                        void* buf, size_t capacity, size_t* required, y2f_error_t* error) {
+    api_scope_t scope;
+    uint32_t image_version = (options && options->image_version) ? options->image_version : 1;
+    uint32_t format = options ? options->format : Y2F_FORMAT_BIN;
+
+    api_enter(&scope);
+    if (!tables || (image_version != 1 && image_version != FPGA_IMAGE_VERSION) ||
+        format > Y2F_FORMAT_MIF) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+
+    size_t image_size = routing_image_size(&tables->tables, image_version);
+
+    // 二进制镜像直接序列化到调用者缓冲区
+    if (format == Y2F_FORMAT_BIN) {
+        if (required) {
+            *required = image_size;
+        }
+        if (!buf || capacity < image_size) {
+            return api_leave(&scope, Y2F_ERR_BUFFER, error);
+        }
+        serialize_routing_image(&tables->tables, image_version, buf, capacity);
+        return api_leave(&scope, Y2F_OK, error);
+    }
+
+    // 文本格式的长度取决于内容，先在内部生成再拷贝
+    uint8_t* image = malloc(image_size ? image_size : 1);
+    char* text = NULL;
+    size_t text_len = 0;
+    int code = Y2F_OK;
+
+    if (!image) {
+        code = Y2F_ERR_NOMEM;
+    } else {
+        serialize_routing_image(&tables->tables, image_version, image, image_size);
+        if (format_image_text(image, image_size, (image_format_t)format, &text, &text_len) != 0) {
+            code = Y2F_ERR_NOMEM;
+        }
+    }
+    if (code == Y2F_OK) {
+        if (required) {
+            *required = text_len;
+        }
+        if (!buf || capacity < text_len) {
+            code = Y2F_ERR_BUFFER;
+        } else {
+            memcpy(buf, text, text_len);
+        }
+    }
+
+    free(text);
+    free(image);
+    return api_leave(&scope, code, error);
+}
+
+// ============ 路由查找 ============
+
+// from_file 时映射 path 指定的文件，否则使用调用者内存中的 image
+static int lookup_create(bool from_file, const char* path, const void* image, size_t size,
+                         y2f_lookup_t** lookup, y2f_error_t* error) {
+    api_scope_t scope;
+
+    api_enter(&scope);
+    if (!lookup || (from_file ? !path : (!image && size > 0))) {
+        return api_leave(&scope, Y2F_ERR_ARGUMENT, error);
+    }
+    *lookup = NULL;
+
+    y2f_lookup_t* result = calloc(1, sizeof(y2f_lookup_t));
+    if (!result) {
+        return api_leave(&scope, Y2F_ERR_NOMEM, error);
+    }
+    int status = from_file ? route_lookup_open(&result->lookup, path)
+                           : route_lookup_init(&result->lookup, image, size);
+    if (status != 0) {
+        free(result);
+        return api_leave(&scope, Y2F_ERR_INVALID, error);
+    }
+
+    *lookup = result;
+    return api_leave(&scope, Y2F_OK, error);
+}
+
+int y2f_lookup_open(const char* path, y2f_lookup_t** lookup, y2f_error_t* error) {
+    return lookup_create(true, path, NULL, 0, lookup, error);
+}
+
+int y2f_lookup_open_buffer(const void* image, size_t size, y2f_lookup_t** lookup, y2f_error_t* error) {
+    return lookup_create(false, NULL, image, size, lookup, error);
+}
+
+void y2f_lookup_close(y2f_lookup_t* lookup) {
+    if (!lookup) {
+        return;
+    }
+    route_lookup_free(&lookup->lookup);
+    free(lookup);
+}
+
+uint32_t y2f_lookup_switch_count(const y2f_lookup_t* lookup) {
+    return lookup ? lookup->lookup.table_count : 0;
+}
+
+int y2f_lookup_table_info(const y2f_lookup_t* lookup, uint32_t index,
+                          uint32_t* switch_id, uint32_t* entry_count) {
+    if (!lookup || index >= lookup->lookup.table_count) {
+        return Y2F_ERR_ARGUMENT;
+    }
+    if (switch_id) {
+        *switch_id = lookup->lookup.tables[index].switch_id;
+    }
+    if (entry_count) {
+        *entry_count = lookup->lookup.tables[index].entry_count;
+    }
+    return Y2F_OK;
+}
+
+// 按 router_searcher 第3级的方式解码条目：标志取各字节的最低位
+static void decode_route(const lookup_table_t* table, int32_t addr, bool is_default, y2f_route_t* route) {
+    fpga_dest_entry_t entry;
+
+    memset(route, 0, sizeof(y2f_route_t));
+    if (addr < 0) {
+        return;
+    }
+    memcpy(&entry, table->entries + sizeof(entry) * (uint32_t)addr, sizeof(entry));
+    route->found = 1;
+    route->is_direct_host = entry.is_direct_host & 1;
+    route->is_broadcast = entry.is_broadcast & 1;
+    route->is_default_route = is_default;
+    route->entry_addr = (uint32_t)addr;
+    route->dst_ip = entry.dst_ip;
+    route->prefix_wildcard = entry.prefix_wildcard;
+    route->out_port = entry.out_port;
+    route->out_qp = entry.out_qp;
+    route->next_hop_ip = entry.next_hop_ip;
+    route->next_hop_port = entry.next_hop_port;
+    route->next_hop_qp = entry.next_hop_qp;
+    memcpy(route->next_hop_mac, entry.next_hop_mac, sizeof(route->next_hop_mac));
+}
+
+int y2f_lookup(const y2f_lookup_t* lookup, uint32_t switch_id, uint32_t dst_ip, y2f_route_t* route) {
+    const lookup_table_t* table = lookup ? route_lookup_table(&lookup->lookup, switch_id) : NULL;
+    if (!table || !route) {
+        return Y2F_ERR_ARGUMENT;
+    }
+    int32_t addr = route_lookup_match(table, dst_ip);
+    decode_route(table, addr, addr >= 0 && addr == table->default_addr, route);
+    return Y2F_OK;
+}
+
+int y2f_lookup_batch(const y2f_lookup_t* lookup, uint32_t switch_id,
+                     const uint32_t* dst_ips, size_t count, int32_t* addrs) {
+    const lookup_table_t* table = lookup ? route_lookup_table(&lookup->lookup, switch_id) : NULL;
+    if (!table || (count > 0 && (!dst_ips || !addrs))) {
+        return Y2F_ERR_ARGUMENT;
+    }
+    route_lookup_batch(table, dst_ips, count, addrs);
+    return Y2F_OK;
+}
+
+int y2f_lookup_entry(const y2f_lookup_t* lookup, uint32_t switch_id, uint32_t entry_addr,
+                     y2f_route_t* route) {
+    const lookup_table_t* table = lookup ? route_lookup_table(&lookup->lookup, switch_id) : NULL;
+    if (!table || !route || entry_addr >= table->entry_count) {
+        return Y2F_ERR_ARGUMENT;
+    }
+    decode_route(table, (int32_t)entry_addr, (int32_t)entry_addr == table->default_addr, route);
+    return Y2F_OK;
+}
@@ -1,59 +1,167 @@
 #include "../include/yaml2fpga.h"
 #include <getopt.h>
 
+// 仅有长选项的命令行参数
+enum {
+    OPT_IMAGE_VERSION = 256,
+    OPT_FORMAT,
+    OPT_STATS,
+    OPT_SAVE_TOPO,
+    OPT_PREV_TOPOLOGY,
+    OPT_PREV_IMAGE,
+    OPT_DELTA,
+    OPT_SLOT_MAP,
+    OPT_COMPRESS,
+    OPT_MAX_ENTRIES,
+    OPT_BRAM_KB,
+    OPT_HASH_BUCKETS,
+    OPT_WATCH,
+    OPT_SOCKET,
+    OPT_DEBOUNCE
+};
+
+// --format 取值与默认输出文件名
+static const struct {
+    const char* name;
+    image_format_t format;
+    const char* default_output;
+} output_formats[] = {
+    {"bin", IMAGE_FORMAT_BIN, "fpga_routing.bin"},
+    {"hex", IMAGE_FORMAT_HEX, "fpga_routing.hex"},
+    {"coe", IMAGE_FORMAT_COE, "fpga_routing.coe"},
+    {"mif", IMAGE_FORMAT_MIF, "fpga_routing.mif"},
+};
+
 void print_usage(const char* program_name) {
     printf("用法: %s [选项] YAML文件 [输出文件]\n\n", program_name);
     printf("YAML到FPGA配置转换器\n\n");
     printf("参数:\n");
-    printf("  YAML文件    YAML拓扑配置文件路径\n");
-    printf("  输出文件    FPGA二进制输出文件 (默认: fpga_routing.bin)\n\n");
+    printf("  YAML文件    YAML拓扑配置文件路径（以 .topo 结尾时按拓扑快照加载）\n");
+    printf("  输出文件    FPGA输出文件 (默认: fpga_routing.<格式扩展名>)\n\n");
     printf("选项:\n");
     printf("  -s, --summary   只显示拓扑摘要\n");
+    printf("  -q, --quiet     安静模式，只输出错误\n");
+    printf("  -v, --verbose   输出逐条目的详细路由日志\n");
+    printf("  -j, --jobs N    使用N个线程并行构建各交换机路由表 (默认: 1)\n");
+    printf("  --image-version V  输出镜像版本: 1=连续DEST表, 2=带目录索引 (默认: 1)\n");
+    printf("  --format F      输出格式: bin, hex($readmemh), coe(Xilinx), mif(Altera) (默认: bin)\n");
+    printf("  --stats[=FILE]  输出各阶段耗时和计数的JSON统计 (默认写到stderr)\n");
+    printf("  --save-topo F   将解析并建好索引的拓扑保存为快照文件F (.topo)\n");
+    printf("  --prev-topology F  增量模式：上次生成所用的拓扑 (YAML或.topo)\n");
+    printf("  --prev-image F  增量模式：上次生成的二进制镜像，只重建受影响的交换机路由表\n");
+    printf("  --delta F       相对 --prev-image 生成增量更新流F，新镜像沿用旧镜像的条目地址\n");
+    printf("  --slot-map F    按槽位映射F排布条目（已有目的地地址不变，新目的地填补空洞），生成后更新F\n");
+    printf("  --compress      前缀聚合：转发动作相同的连续地址块合并为一个条目 (需 router_searcher_masked)\n");
+    printf("  --max-entries N 容量规划：按查找表容量N检查每张表，输出占用率和资源估算，溢出时不写出文件\n");
+    printf("  --bram-kb K     容量规划：查找表的BRAM预算 (Kb)，未给 --max-entries 时按64条目检查\n");
+    printf("  --hash-buckets N  按两路cuckoo哈希把条目预先放入每路N个桶 (N为2的幂，需 router_searcher_hash)\n");
+    printf("  --watch         常驻模式：监视YAML文件，变化后增量重建并原子替换输出文件\n");
+    printf("  --socket F      常驻模式：查询路由表的Unix套接字路径 (默认: <输出文件>.sock)\n");
+    printf("  --debounce MS   常驻模式：文件最后一次变化后等待MS毫秒再重建 (默认: 200)\n");
     printf("  -h, --help      显示此帮助信息\n\n");
     printf("示例:\n");
     printf("  %s topology-tree.yaml\n", program_name);
     printf("  %s topology-tree.yaml my_routing.bin\n", program_name);
+    printf("  %s -j 8 topology-tree.yaml\n", program_name);
+    printf("  %s --format=hex topology-tree.yaml fpga_routing.hex\n", program_name);
     printf("  %s --summary topology-tree.yaml\n", program_name);
+    printf("  %s --save-topo fabric.topo topology-tree.yaml\n", program_name);
+    printf("  %s fabric.topo\n", program_name);
+    printf("  %s --prev-topology old.topo --prev-image old.bin topology-tree.yaml new.bin\n", program_name);
+    printf("  %s --prev-image old.bin --delta update.delta topology-tree.yaml new.bin\n", program_name);
+    printf("  %s --slot-map fpga_routing.slots topology-tree.yaml\n", program_name);
+    printf("  %s --max-entries 64 --bram-kb 1800 topology-tree.yaml\n", program_name);
+    printf("  %s --hash-buckets 1024 --format=hex topology-tree.yaml fpga_routing.hex\n", program_name);
+    printf("  %s --watch --socket /run/yaml2fpga.sock topology-tree.yaml\n", program_name);
 }
 
-// 基本拓扑验证
-static int validate_basic_topology(const topology_config_t* config) {
-    if (!config || config->switch_count == 0) {
-        return ERR_INVALID_CONFIG;
-    }
+// 加载拓扑并建好索引：.topo 快照直接映射（已含索引），其余按YAML解析
+static int load_topology(const char* path, topology_config_t* config, run_stats_t* stats) {
+    double t_phase = stats_now_ms();
+    size_t name_len = strlen(path);
+    bool from_snapshot = name_len > 5 && strcmp(path + name_len - 5, ".topo") == 0;
+    int result;
 
-    int root_count = 0;
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].is_root) {
-            root_count++;
+    if (from_snapshot) {
+        LOG_INFO("加载拓扑快照 %s...\n", path);
+        result = load_topology_snapshot(path, config);
+        if (result != SUCCESS) {
+            fprintf(stderr, "错误: 拓扑快照加载失败 (错误码: %d)\n", result);
+            return result;
         }
+        stats->parse_ms += stats_now_ms() - t_phase;
+        return SUCCESS;
     }
 
-    if (root_count != 1) {
-        printf("错误: 必须有且仅有一个根交换机 (找到 %d 个)\n", root_count);
-        return ERR_INVALID_CONFIG;
+    LOG_INFO("解析YAML文件 %s...\n", path);
+    result = parse_yaml_topology(path, config);
+    if (result != SUCCESS) {
+        fprintf(stderr, "错误: YAML解析失败 (错误码: %d)\n", result);
+        return result;
     }
+    stats->parse_ms += stats_now_ms() - t_phase;
 
+    // 构建拓扑索引（后续所有路由查询均基于该索引）
+    t_phase = stats_now_ms();
+    if (build_topology_index(config) != 0) {
+        fprintf(stderr, "错误: 拓扑索引构建失败\n");
+        cleanup_topology(config);
+        return ERR_INVALID_CONFIG;
+    }
+    stats->index_ms += stats_now_ms() - t_phase;
     return SUCCESS;
 }
 
 int main(int argc, char* argv[]) {
     char* yaml_file = NULL;
-    char* output_file = "fpga_routing.bin";
+    const char* output_file = NULL;
     bool summary_only = false;
     bool show_help = false;
+    const char* stats_file = NULL;
+    const char* save_topo_file = NULL;
+    const char* prev_topology_file = NULL;
+    const char* prev_image_file = NULL;
+    const char* delta_file = NULL;
+    bool watch = false;
+    const char* socket_file = NULL;
+    uint32_t debounce_ms = 200;
+    bool collect_stats = false;
+    run_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    double t_start = stats_now_ms();
+    generate_options_t gen_options = {0};
+    gen_options.jobs = 1;
+    gen_options.image_version = 1;
 
     // 解析命令行参数
     static struct option long_options[] = {
         {"help", no_argument, 0, 'h'},
         {"summary", no_argument, 0, 's'},
+        {"quiet", no_argument, 0, 'q'},
+        {"verbose", no_argument, 0, 'v'},
+        {"jobs", required_argument, 0, 'j'},
+        {"image-version", required_argument, 0, OPT_IMAGE_VERSION},
+        {"format", required_argument, 0, OPT_FORMAT},
+        {"stats", optional_argument, 0, OPT_STATS},
+        {"save-topo", required_argument, 0, OPT_SAVE_TOPO},
+        {"prev-topology", required_argument, 0, OPT_PREV_TOPOLOGY},
+        {"prev-image", required_argument, 0, OPT_PREV_IMAGE},
+        {"delta", required_argument, 0, OPT_DELTA},
+        {"slot-map", required_argument, 0, OPT_SLOT_MAP},
+        {"compress", no_argument, 0, OPT_COMPRESS},
+        {"max-entries", required_argument, 0, OPT_MAX_ENTRIES},
+        {"bram-kb", required_argument, 0, OPT_BRAM_KB},
+        {"hash-buckets", required_argument, 0, OPT_HASH_BUCKETS},
+        {"watch", no_argument, 0, OPT_WATCH},
+        {"socket", required_argument, 0, OPT_SOCKET},
+        {"debounce", required_argument, 0, OPT_DEBOUNCE},
         {0, 0, 0, 0}
     };
 
     int option_index = 0;
     int c;
 
-    while ((c = getopt_long(argc, argv, "hs", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "hsqvj:", long_options, &option_index)) != -1) {
         switch (c) {
             case 'h':
                 show_help = true;
@@ -61,6 +169,111 @@ int main(int argc, char* argv[]) {
             case 's':
                 summary_only = true;
                 break;
+            case 'q':
+                yaml2fpga_log_level = LOG_LEVEL_QUIET;
+                break;
+            case 'v':
+                yaml2fpga_log_level = LOG_LEVEL_VERBOSE;
+                break;
+            case 'j': {
+                char* end = NULL;
+                long jobs = strtol(optarg, &end, 10);
+                if (!end || *end != '\0' || jobs < 1 || jobs > 1024) {
+                    fprintf(stderr, "错误: 无效的线程数: %s\n", optarg);
+                    return 1;
+                }
+                gen_options.jobs = (uint32_t)jobs;
+                break;
+            }
+            case OPT_IMAGE_VERSION:
+                if (strcmp(optarg, "1") == 0) {
+                    gen_options.image_version = 1;
+                } else if (strcmp(optarg, "2") == 0) {
+                    gen_options.image_version = FPGA_IMAGE_VERSION;
+                } else {
+                    fprintf(stderr, "错误: 无效的镜像版本: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case OPT_FORMAT: {
+                size_t format_count = sizeof(output_formats) / sizeof(output_formats[0]);
+                size_t f = 0;
+                while (f < format_count && strcmp(optarg, output_formats[f].name) != 0) {
+                    f++;
+                }
+                if (f == format_count) {
+                    fprintf(stderr, "错误: 无效的输出格式: %s\n", optarg);
+                    return 1;
+                }
+                gen_options.format = output_formats[f].format;
+                break;
+            }
+            case OPT_STATS:
+                collect_stats = true;
+                stats_file = optarg;
+                break;
+            case OPT_SAVE_TOPO:
+                save_topo_file = optarg;
+                break;
+            case OPT_PREV_TOPOLOGY:
+                prev_topology_file = optarg;
+                break;
+            case OPT_PREV_IMAGE:
+                prev_image_file = optarg;
+                break;
+            case OPT_DELTA:
+                delta_file = optarg;
+                break;
+            case OPT_SLOT_MAP:
+                gen_options.slot_map = optarg;
+                break;
+            case OPT_COMPRESS:
+                gen_options.compress = true;
+                break;
+            case OPT_MAX_ENTRIES:
+            case OPT_BRAM_KB: {
+                char* end = NULL;
+                long value = strtol(optarg, &end, 10);
+                if (!end || *end != '\0' || value < 1 || value > 0x7FFFFFFF) {
+                    fprintf(stderr, "错误: 无效的%s: %s\n",
+                            c == OPT_MAX_ENTRIES ? "查找表容量" : "BRAM预算", optarg);
+                    return 1;
+                }
+                if (c == OPT_MAX_ENTRIES) {
+                    gen_options.max_entries = (uint32_t)value;
+                } else {
+                    gen_options.bram_kb = (uint32_t)value;
+                }
+                break;
+            }
+            case OPT_HASH_BUCKETS: {
+                char* end = NULL;
+                long value = strtol(optarg, &end, 10);
+                if (!end || *end != '\0' || value < (long)HASH_BUCKETS_MIN || value > (long)HASH_BUCKETS_MAX ||
+                    (value & (value - 1)) != 0) {
+                    fprintf(stderr, "错误: 无效的哈希桶数: %s (需为 %u..%u 之间的2的幂)\n",
+                            optarg, HASH_BUCKETS_MIN, HASH_BUCKETS_MAX);
+                    return 1;
+                }
+                gen_options.hash_buckets = (uint32_t)value;
+                break;
+            }
+            case OPT_WATCH:
+                watch = true;
+                break;
+            case OPT_SOCKET:
+                socket_file = optarg;
+                break;
+            case OPT_DEBOUNCE: {
+                char* end = NULL;
+                long value = strtol(optarg, &end, 10);
+                if (!end || *end != '\0' || value < 0 || value > 60000) {
+                    fprintf(stderr, "错误: 无效的防抖时间: %s\n", optarg);
+                    return 1;
+                }
+                debounce_ms = (uint32_t)value;
+                break;
+            }
             case '?':
                 fprintf(stderr, "使用 --help 查看帮助信息。\n");
                 return 1;
@@ -78,29 +291,89 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // --prev-image 单独使用时只用于生成增量更新流（完整重建后与旧镜像比较）
+    if (prev_topology_file && !prev_image_file) {
+        fprintf(stderr, "错误: 增量模式需要同时指定 --prev-topology 和 --prev-image\n");
+        return 1;
+    }
+    if (prev_image_file && !prev_topology_file && !delta_file) {
+        fprintf(stderr, "错误: --prev-image 需要配合 --prev-topology 或 --delta 使用\n");
+        return 1;
+    }
+    if (delta_file && !prev_image_file) {
+        fprintf(stderr, "错误: --delta 需要通过 --prev-image 指定上一版镜像\n");
+        return 1;
+    }
+    // 哈希查找表的地址由桶号决定，容量由桶数决定
+    if (gen_options.hash_buckets &&
+        (gen_options.compress || gen_options.slot_map || delta_file || gen_options.max_entries)) {
+        fprintf(stderr, "错误: --hash-buckets 不能与 --compress/--slot-map/--delta/--max-entries 同时使用\n");
+        return 1;
+    }
+    // 只给出BRAM预算时按RTL默认的64条目查找表规划
+    if (gen_options.bram_kb && !gen_options.max_entries && !gen_options.hash_buckets) {
+        gen_options.max_entries = 64;
+    }
+    gen_options.prev_image = prev_image_file;
+    gen_options.delta_file = delta_file;
+
     yaml_file = argv[optind];
     if (optind + 1 < argc) {
         output_file = argv[optind + 1];
+    } else {
+        output_file = output_formats[gen_options.format].default_output;
+    }
+
+    // 常驻模式：拓扑和路由表留在内存中，由守护循环负责之后的全部生成
+    if (watch) {
+        size_t name_len = strlen(yaml_file);
+        if (summary_only || collect_stats || prev_image_file || save_topo_file || gen_options.slot_map ||
+            (name_len > 5 && strcmp(yaml_file + name_len - 5, ".topo") == 0)) {
+            fprintf(stderr, "错误: --watch 只能监视YAML文件，不能与 --summary/--stats/--save-topo/"
+                            "--prev-topology/--prev-image/--delta/--slot-map 同时使用\n");
+            return 1;
+        }
+        char default_socket[4096];
+        if (!socket_file) {
+            snprintf(default_socket, sizeof(default_socket), "%s.sock", output_file);
+            socket_file = default_socket;
+        }
+        return run_watch_daemon(yaml_file, output_file, &gen_options, socket_file, debounce_ms) == 0 ? 0 : 1;
+    }
+    if (socket_file) {
+        fprintf(stderr, "错误: --socket 只能在 --watch 常驻模式下使用\n");
+        return 1;
     }
 
-    printf("=== YAML到FPGA配置转换器 ===\n");
-    printf("输入: %s\n", yaml_file);
+    LOG_INFO("=== YAML到FPGA配置转换器 ===\n");
+    LOG_INFO("输入: %s\n", yaml_file);
     if (!summary_only) {
-        printf("输出: %s\n", output_file);
+        LOG_INFO("输出: %s\n", output_file);
     }
-    printf("\n");
+    LOG_INFO("\n");
 
-    // 步骤1: 解析YAML
-    printf("解析YAML文件...\n");
+    // 步骤1: 解析YAML（或直接映射拓扑快照，快照中已包含索引）
     topology_config_t config;
-    int result = parse_yaml_topology(yaml_file, &config);
-    if (result != SUCCESS) {
-        fprintf(stderr, "错误: YAML解析失败 (错误码: %d)\n", result);
+    if (load_topology(yaml_file, &config, &stats) != SUCCESS) {
         return 1;
     }
+    double t_phase;
+    int result;
 
-    // 步骤2: 显示摘要
-    print_topology_summary(&config);
+    if (save_topo_file && save_topology_snapshot(&config, save_topo_file) != 0) {
+        fprintf(stderr, "错误: 拓扑快照保存失败\n");
+        cleanup_topology(&config);
+        return 1;
+    }
+    stats.yaml_events = config.yaml_event_count;
+    stats.switches = config.switch_count;
+    stats.connections = config.connection_count;
+    stats.hosts = config.index.host_count;
+
+    // 步骤2: 显示摘要（--summary 时总是输出）
+    if (summary_only || LOG_ENABLED(LOG_LEVEL_INFO)) {
+        print_topology_summary(&config);
+    }
 
     if (summary_only) {
         cleanup_topology(&config);
@@ -108,33 +381,63 @@ int main(int argc, char* argv[]) {
     }
 
     // 步骤3: 基本验证
-    printf("\n验证拓扑...\n");
-    result = validate_basic_topology(&config);
+    LOG_INFO("\n验证拓扑...\n");
+    t_phase = stats_now_ms();
+    result = validate_topology(&config);
+    stats.validate_ms = stats_now_ms() - t_phase;
     if (result != SUCCESS) {
         fprintf(stderr, "错误: 验证失败 (错误码: %d)\n", result);
         cleanup_topology(&config);
         return 1;
     }
 
-    printf("验证通过\n\n");
+    LOG_INFO("验证通过\n\n");
 
     // 步骤4: 生成统一路由表
-    printf("生成统一路由表...\n");
-    result = generate_unified_routing_binary(&config, output_file);
+    LOG_INFO("生成统一路由表...\n");
+    if (collect_stats) {
+        gen_options.stats = &stats;
+    }
+    if (prev_topology_file) {
+        // 增量模式：与上次的拓扑对比，只重建受影响的交换机路由表
+        topology_config_t prev_config;
+        if (load_topology(prev_topology_file, &prev_config, &stats) != SUCCESS) {
+            cleanup_topology(&config);
+            return 1;
+        }
+        result = generate_incremental_routing_binary(&prev_config, &config, prev_image_file,
+                                                     output_file, &gen_options);
+        cleanup_topology(&prev_config);
+    } else {
+        result = generate_unified_routing_binary(&config, output_file, &gen_options);
+    }
     if (result != SUCCESS) {
         fprintf(stderr, "错误: 生成统一路由表失败 (错误码: %d)\n", result);
         cleanup_topology(&config);
         return 1;
     }
 
-    printf("统一路由表已生成: %s\n\n", output_file);
+    LOG_INFO("统一路由表已生成: %s\n\n", output_file);
 
     // 清理
     cleanup_topology(&config);
 
-    printf("=== 转换完成 ===\n");
-    printf("生成的文件:\n");
-    printf("  - %s - 统一路由表\n", output_file);
+    LOG_INFO("=== 转换完成 ===\n");
+    LOG_INFO("生成的文件:\n");
+    LOG_INFO("  - %s - 统一路由表\n", output_file);
+
+    if (collect_stats) {
+        stats.total_ms = stats_now_ms() - t_start;
+        FILE* stats_out = stats_file ? fopen(stats_file, "w") : stderr;
+        if (!stats_out) {
+            fprintf(stderr, "错误: 无法创建统计文件 %s\n", stats_file);
+            return 1;
+        }
+        write_stats_json(stats_out, &stats);
+        if (stats_out != stderr) {
+            fclose(stats_out);
+        }
+    }
 
     return 0;
 }
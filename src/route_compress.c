@@ -0,0 +1,208 @@
+#include "yaml2fpga.h"
+
+// ============ 前缀聚合 ============
+// 转发动作相同的条目中，大小相同、地址相邻且按上一级对齐的两个地址块合并为一个块
+// （通配位数+1），直到不能再合并。只合并完整的地址块：聚合后的前缀恰好覆盖原来的
+// 地址集合，不会把表中没有的地址引到某个端口，查找结果与聚合前逐地址一致。
+// 默认路由不参与聚合；表中地址块有重叠时（同一IP出现多次）整张表保持不变。
+
+// 转发动作相同：条目标志相同且去重后的动作内容相同
+
+typedef struct {
+    const route_action_t* action;    // 转发动作（actions 中的一项）
+    uint32_t action_id;
+    uint32_t index;                  // 原表下标，聚合块取成员中最小的下标
+    uint32_t ip;
+    uint8_t  flags;
+    uint8_t  wildcard;
+} prefix_block_t;
+
+static uint32_t block_last(const prefix_block_t* block) {
+    return block->ip | ((1u << block->wildcard) - 1);
+}
+
+static int compare_block_ip(const void* a, const void* b) {
+    const prefix_block_t* x = a;
+    const prefix_block_t* y = b;
+    if (x->ip != y->ip) {
+        return x->ip < y->ip ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static int compare_action(const prefix_block_t* x, const prefix_block_t* y) {
+    if (x->flags != y->flags) {
+        return x->flags < y->flags ? -1 : 1;
+    }
+    if (x->action_id == y->action_id) {
+        return 0;
+    }
+    return memcmp(x->action, y->action, sizeof(route_action_t));
+}
+
+static int compare_block_action(const void* a, const void* b) {
+    int action = compare_action(a, b);
+    return action != 0 ? action : compare_block_ip(a, b);
+}
+
+static int compare_block_index(const void* a, const void* b) {
+    const prefix_block_t* x = a;
+    const prefix_block_t* y = b;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static bool same_action(const prefix_block_t* a, const prefix_block_t* b) {
+    return compare_action(a, b) == 0;
+}
+
+// 对同一动作、按地址排序的一段块做伙伴合并（栈式，一遍完成），返回合并后的块数
+static uint32_t merge_buddies(prefix_block_t* blocks, uint32_t count) {
+    uint32_t top = 0;
+    for (uint32_t k = 0; k < count; k++) {
+        blocks[top++] = blocks[k];
+        while (top >= 2) {
+            prefix_block_t* low = &blocks[top - 2];
+            const prefix_block_t* high = &blocks[top - 1];
+            uint32_t size = 1u << low->wildcard;
+
+            if (low->wildcard != high->wildcard || low->wildcard >= PREFIX_WILDCARD_MAX ||
+                (low->ip & (size * 2 - 1)) != 0 || high->ip != low->ip + size) {
+                break;
+            }
+            low->wildcard++;
+            if (high->index < low->index) {
+                low->index = high->index;
+                low->action_id = high->action_id;
+                low->action = high->action;
+            }
+            top--;
+        }
+    }
+    return top;
+}
+
+// 聚合一张路由表，original_count 返回聚合前的有效条目数；聚合后的各列分配在 arena 中，动作数组沿用
+// 空洞（valid=0）在聚合时去掉，由后续的稳定槽位排布重新决定地址
+int compress_routing_table(switch_table_t* table, topo_arena_t* arena, uint32_t* original_count) {
+    uint32_t count = table->entry_count;
+    prefix_block_t* blocks = malloc(sizeof(prefix_block_t) * (count ? count : 1));
+    if (!blocks) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    // 有效条目都转成块，默认路由的通配位数记为0且不参与合并
+    uint32_t block_count = 0;
+    bool malformed = false;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t flags = table->flags[i];
+        if (flags & ROUTE_FLAG_VALID) {
+            uint8_t wildcard = (flags & ROUTE_FLAG_DEFAULT) ? 0 : table->wildcard[i];
+            uint32_t ip = table->dst_ip[i];
+            malformed |= wildcard > PREFIX_WILDCARD_MAX;
+            blocks[block_count].action_id = table->action_id[i];
+            blocks[block_count].action = &table->actions[table->action_id[i]];
+            blocks[block_count].index = i;
+            blocks[block_count].flags = flags;
+            blocks[block_count].wildcard = wildcard;
+            blocks[block_count].ip = malformed ? ip : ip & ~((1u << wildcard) - 1);
+            block_count++;
+        }
+    }
+    *original_count = block_count;
+    if (malformed) {
+        LOG_VERBOSE("  Switch %u: 通配位数超出范围，跳过聚合\n", table->switch_id);
+        free(blocks);
+        return 0;
+    }
+
+    // 默认路由排在最后，剩余的可聚合块按地址检查是否重叠
+    uint32_t merge_count = 0;
+    for (uint32_t k = 0; k < block_count; k++) {
+        if (!(blocks[k].flags & ROUTE_FLAG_DEFAULT)) {
+            prefix_block_t swap = blocks[merge_count];
+            blocks[merge_count++] = blocks[k];
+            blocks[k] = swap;
+        }
+    }
+    qsort(blocks, merge_count, sizeof(prefix_block_t), compare_block_ip);
+    for (uint32_t k = 1; k < merge_count; k++) {
+        if (blocks[k].ip <= block_last(&blocks[k - 1])) {
+            LOG_VERBOSE("  Switch %u: 存在重叠的目的地址，跳过聚合\n", table->switch_id);
+            free(blocks);
+            return 0;
+        }
+    }
+
+    // 按动作分组后组内伙伴合并，结果紧凑地写回数组前部
+    qsort(blocks, merge_count, sizeof(prefix_block_t), compare_block_action);
+    uint32_t out = 0;
+    uint32_t start = 0;
+    while (start < merge_count) {
+        uint32_t end = start + 1;
+        while (end < merge_count && same_action(&blocks[start], &blocks[end])) {
+            end++;
+        }
+        uint32_t merged = merge_buddies(&blocks[start], end - start);
+        memmove(&blocks[out], &blocks[start], sizeof(prefix_block_t) * merged);
+        out += merged;
+        start = end;
+    }
+    memmove(&blocks[out], &blocks[merge_count], sizeof(prefix_block_t) * (block_count - merge_count));
+    out += block_count - merge_count;
+
+    // 按成员在原表中最早出现的位置输出，未发生合并的表保持原样
+    qsort(blocks, out, sizeof(prefix_block_t), compare_block_index);
+    size_t n = out ? out : 1;
+    uint32_t* dst_ip = topo_arena_alloc(arena, sizeof(uint32_t) * n);
+    uint32_t* action_id = topo_arena_alloc(arena, sizeof(uint32_t) * n);
+    uint8_t* flags = topo_arena_alloc(arena, n);
+    uint8_t* wildcard = topo_arena_alloc(arena, n);
+    if (!dst_ip || !action_id || !flags || !wildcard) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(blocks);
+        return -1;
+    }
+    for (uint32_t k = 0; k < out; k++) {
+        uint32_t i = blocks[k].index;
+        bool is_default = (blocks[k].flags & ROUTE_FLAG_DEFAULT) != 0;
+        dst_ip[k] = is_default ? table->dst_ip[i] : blocks[k].ip;
+        wildcard[k] = is_default ? table->wildcard[i] : blocks[k].wildcard;
+        flags[k] = blocks[k].flags;
+        action_id[k] = blocks[k].action_id;
+    }
+
+    free(blocks);
+    table->dst_ip = dst_ip;
+    table->action_id = action_id;
+    table->flags = flags;
+    table->wildcard = wildcard;
+    table->entry_count = out;
+    return 0;
+}
+
+// 聚合全部路由表并输出每个交换机的压缩率
+int compress_routing_tables(routing_tables_t* tables) {
+    uint64_t total_before = 0;
+    uint64_t total_after = 0;
+
+    LOG_INFO("\n前缀聚合:\n");
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        switch_table_t* table = &tables->tables[i];
+        uint32_t before;
+
+        if (compress_routing_table(table, &tables->arena, &before) != 0) {
+            return -1;
+        }
+        total_before += before;
+        total_after += table->entry_count;
+        LOG_INFO("  Switch %u: %u -> %u 条目 (压缩率 %.1f%%)\n", table->switch_id,
+                 before, table->entry_count,
+                 before ? 100.0 * ((double)before - table->entry_count) / before : 0.0);
+    }
+
+    LOG_INFO("前缀聚合完成: %llu -> %llu 条目 (压缩率 %.1f%%)\n",
+             (unsigned long long)total_before, (unsigned long long)total_after,
+             total_before ? 100.0 * (double)(total_before - total_after) / (double)total_before : 0.0);
+    return 0;
+}
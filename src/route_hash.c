@@ -0,0 +1,156 @@
+#include "yaml2fpga.h"
+
+// ============ 哈希查找表排布（--hash-buckets）============
+// router_searcher_hash 用两路 cuckoo 哈希代替CAM：每路 N 个单条目桶（两块BRAM），
+// 查找时两路各探测一个桶，延迟固定。条目在生成时离线放入桶中，表的地址布局为
+//   [0, N)      第0路，地址 = 桶号
+//   [N, 2N)     第1路，地址 = N + 桶号
+//   2N          默认路由（没有默认路由时为空）
+// 空桶为全0条目（valid=0），每张表固定 2N+1 条。桶号计算见 route_hash_bucket，
+// 与 router_searcher_hash.v 中的 hash_bucket 一致。
+
+static uint32_t bucket_bits_of(uint32_t buckets) {
+    uint32_t bits = 0;
+    while ((1u << bits) < buckets) {
+        bits++;
+    }
+    return bits;
+}
+
+// 桶号 = (dst_ip * 乘数) 的高 bucket_bits 位（两路乘数不同）
+uint32_t route_hash_bucket(uint32_t dst_ip, uint32_t way, uint32_t bucket_bits) {
+    uint32_t product = dst_ip * (way ? HASH_MULT_WAY1 : HASH_MULT_WAY0);
+    return product >> (32 - bucket_bits);
+}
+
+// 把一张表排布为哈希布局，kicks 返回插入过程中踢出条目的总次数
+// 已排布过的表（增量模式沿用的旧表）同样适用：空桶被跳过，结果不变
+// 同一 dst_ip 出现多次时保留地址最大的一条，与CAM优先编码器的结果一致
+int place_hash_table(switch_table_t* table, topo_arena_t* arena, uint32_t buckets, uint32_t* kicks) {
+    uint32_t bucket_bits = bucket_bits_of(buckets);
+    uint32_t slot_count = buckets * 2 + 1;
+    uint32_t* owner = calloc(slot_count, sizeof(uint32_t));    // 槽位 -> 原表下标+1，0 为空
+    if (!owner) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    *kicks = 0;
+    int status = 0;
+    for (uint32_t i = 0; i < table->entry_count && status == 0; i++) {
+        uint8_t flags = table->flags[i];
+        if (!(flags & ROUTE_FLAG_VALID)) {
+            continue;
+        }
+        if (flags & ROUTE_FLAG_DEFAULT) {
+            owner[slot_count - 1] = i + 1;
+            continue;
+        }
+        if (table->wildcard[i] != 0) {
+            LOG_ERROR("错误: Switch %u 含前缀条目，哈希查找表只支持精确匹配\n", table->switch_id);
+            status = -1;
+            break;
+        }
+
+        // 已有相同的键时直接替换
+        uint32_t ip = table->dst_ip[i];
+        uint32_t s0 = route_hash_bucket(ip, 0, bucket_bits);
+        uint32_t s1 = buckets + route_hash_bucket(ip, 1, bucket_bits);
+        if (owner[s0] && table->dst_ip[owner[s0] - 1] == ip) {
+            owner[s0] = i + 1;
+            continue;
+        }
+        if (owner[s1] && table->dst_ip[owner[s1] - 1] == ip) {
+            owner[s1] = i + 1;
+            continue;
+        }
+        if (!owner[s0] || !owner[s1]) {
+            owner[owner[s0] ? s1 : s0] = i + 1;
+            continue;
+        }
+
+        // 两个桶都被占用：踢出第0路的条目，被踢出者移到它的另一路，依次类推
+        uint32_t current = i + 1;
+        uint32_t way = 0;
+        uint32_t k = 0;
+        while (current && k < HASH_MAX_KICKS) {
+            uint32_t slot = way * buckets + route_hash_bucket(table->dst_ip[current - 1], way, bucket_bits);
+            uint32_t evicted = owner[slot];
+            owner[slot] = current;
+            current = evicted;
+            way ^= 1;
+            k++;
+        }
+        *kicks += k - (current ? 0 : 1);
+        if (current) {
+            LOG_ERROR("错误: Switch %u 的路由表无法放入 2x%u 个哈希桶，请增大 --hash-buckets\n",
+                      table->switch_id, buckets);
+            status = -1;
+        }
+    }
+
+    uint32_t* dst_ip = NULL;
+    uint32_t* action_id = NULL;
+    uint8_t* flags = NULL;
+    uint8_t* wildcard = NULL;
+    if (status == 0) {
+        dst_ip = topo_arena_alloc(arena, sizeof(uint32_t) * slot_count);
+        action_id = topo_arena_alloc(arena, sizeof(uint32_t) * slot_count);
+        flags = topo_arena_alloc(arena, slot_count);
+        wildcard = topo_arena_alloc(arena, slot_count);
+        if (!dst_ip || !action_id || !flags || !wildcard) {
+            LOG_ERROR("错误: 内存分配失败\n");
+            status = -1;
+        }
+    }
+    if (status != 0) {
+        free(owner);
+        return -1;
+    }
+
+    for (uint32_t s = 0; s < slot_count; s++) {
+        uint32_t i = owner[s];
+        dst_ip[s] = i ? table->dst_ip[i - 1] : 0;
+        action_id[s] = i ? table->action_id[i - 1] : 0;
+        flags[s] = i ? table->flags[i - 1] : 0;
+        wildcard[s] = i ? table->wildcard[i - 1] : 0;
+    }
+    free(owner);
+    table->dst_ip = dst_ip;
+    table->action_id = action_id;
+    table->flags = flags;
+    table->wildcard = wildcard;
+    table->entry_count = slot_count;
+    return 0;
+}
+
+// 按哈希布局排布全部路由表，输出每个交换机两路桶的装载率
+int place_hash_tables(routing_tables_t* tables, uint32_t buckets) {
+    uint64_t total_kicks = 0;
+    uint32_t peak_used = 0;
+    uint32_t peak_switch = 0;
+
+    LOG_INFO("\n哈希排布 (每路 %u 个桶):\n", buckets);
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        switch_table_t* table = &tables->tables[i];
+        uint32_t kicks;
+
+        if (place_hash_table(table, &tables->arena, buckets, &kicks) != 0) {
+            return -1;
+        }
+        uint32_t used = 0;
+        for (uint32_t s = 0; s < buckets * 2; s++) {
+            used += (table->flags[s] & ROUTE_FLAG_VALID) != 0;
+        }
+        if (used > peak_used || i == 0) {
+            peak_used = used;
+            peak_switch = table->switch_id;
+        }
+        total_kicks += kicks;
+        LOG_INFO("  Switch %u: %u/%u 桶 (装载率 %.1f%%, 踢出 %u 次)\n", table->switch_id,
+                 used, buckets * 2, 100.0 * used / (buckets * 2), kicks);
+    }
+    LOG_INFO("最大装载: Switch %u, %u/%u 桶，共踢出 %llu 次\n", peak_switch, peak_used,
+             buckets * 2, (unsigned long long)total_kicks);
+    return 0;
+}
@@ -0,0 +1,346 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LOOKUP_SSE2 1
+#else
+#define LOOKUP_SSE2 0
+#endif
+
+// ============ 路由查找（router_searcher 的软件模型）============
+// 镜像中每张 DEST 表建一个查找结构（SIMD扫描的键列，大表的精确条目另建哈希表），
+// 匹配语义与 router_searcher_masked 相同：
+// valid 条目按 (dst_ip & mask) == key 比较，多条命中取地址最大者（优先编码器），
+// 未命中时使用默认路由条目。非 --compress 镜像的通配位数恒为0，即 router_searcher 的精确匹配。
+// 查找只读取键列，命中后才访问镜像中的条目；不模拟 MAX_ENTRIES 截断（由 --max-entries 检查）。
+
+#define LOOKUP_PAD_KEY  1u               // 补齐键：掩码为0时 (ip & 0) 永远不等于1
+#define LOOKUP_PAD_MASK 0u
+
+static uint32_t entry_u32(const uint8_t* entry, size_t offset) {
+    uint32_t value;
+    memcpy(&value, entry + offset, sizeof(value));
+    return value;
+}
+
+static uint32_t lookup_hash(uint32_t key, uint32_t hash_mask) {
+    return (key * 0x9E3779B1u) >> 7 & hash_mask;
+}
+
+static bool entry_is_default(const uint8_t* entry) {
+    return entry_u32(entry, offsetof(fpga_dest_entry_t, dst_ip)) == 0xFFFFFFFFu &&
+           (entry[offsetof(fpga_dest_entry_t, is_default_route)] & 1);
+}
+
+// 建立一张表的查找结构，entries 已确认在镜像范围内
+static int build_lookup_table(lookup_table_t* table, topo_arena_t* arena, uint32_t switch_id,
+                              const uint8_t* entries, uint32_t entry_count) {
+    table->switch_id = switch_id;
+    table->entry_count = entry_count;
+    table->entries = entries;
+    table->default_addr = -1;
+
+    // 先数出精确匹配条目，决定是否建哈希表
+    uint32_t exact_count = 0;
+    for (uint32_t addr = 0; addr < entry_count; addr++) {
+        const uint8_t* entry = entries + sizeof(fpga_dest_entry_t) * addr;
+        exact_count += !entry_is_default(entry) && (entry[offsetof(fpga_dest_entry_t, valid)] & 1) &&
+                       entry[offsetof(fpga_dest_entry_t, prefix_wildcard)] == 0;
+    }
+    bool use_hash = exact_count > LOOKUP_HASH_MIN;
+    if (use_hash) {
+        uint32_t slots = 1;
+        while (slots < exact_count * 2) {
+            slots <<= 1;
+        }
+        table->hash_mask = slots - 1;
+        table->hash_keys = topo_arena_alloc(arena, sizeof(uint32_t) * slots);
+        table->hash_addrs = topo_arena_alloc(arena, sizeof(uint32_t) * slots);
+        if (!table->hash_keys || !table->hash_addrs) {
+            LOG_ERROR("错误: 内存分配失败\n");
+            return -1;
+        }
+        memset(table->hash_addrs, 0, sizeof(uint32_t) * slots);
+    }
+
+    uint32_t column_count = use_hash ? entry_count - exact_count : entry_count;
+    size_t column = sizeof(uint32_t) * ((column_count + LOOKUP_LANES - 1) / LOOKUP_LANES + 1) * LOOKUP_LANES;
+    table->keys = topo_arena_alloc(arena, column);
+    table->masks = topo_arena_alloc(arena, column);
+    table->addrs = topo_arena_alloc(arena, column);
+    if (!table->keys || !table->masks || !table->addrs) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    // 与硬件逐条写入的效果一致：默认路由条目只记录地址，不进入CAM
+    uint32_t n = 0;
+    for (uint32_t addr = 0; addr < entry_count; addr++) {
+        const uint8_t* entry = entries + sizeof(fpga_dest_entry_t) * addr;
+        uint32_t dst_ip = entry_u32(entry, offsetof(fpga_dest_entry_t, dst_ip));
+        uint8_t wildcard = entry[offsetof(fpga_dest_entry_t, prefix_wildcard)];
+
+        if (entry_is_default(entry)) {
+            table->default_addr = (int32_t)addr;
+            continue;
+        }
+        if (!(entry[offsetof(fpga_dest_entry_t, valid)] & 1)) {
+            continue;
+        }
+        if (use_hash && wildcard == 0) {
+            // 地址递增插入，重复的键被后面的条目覆盖，与优先编码器取最大地址一致
+            uint32_t slot = lookup_hash(dst_ip, table->hash_mask);
+            while (table->hash_addrs[slot] && table->hash_keys[slot] != dst_ip) {
+                slot = (slot + 1) & table->hash_mask;
+            }
+            table->hash_keys[slot] = dst_ip;
+            table->hash_addrs[slot] = addr + 1;
+            continue;
+        }
+        uint32_t mask = wildcard >= 32 ? 0 : 0xFFFFFFFFu << wildcard;
+        table->keys[n] = dst_ip & mask;
+        table->masks[n] = mask;
+        table->addrs[n] = addr;
+        n++;
+    }
+    while (n == 0 || n % LOOKUP_LANES != 0) {
+        table->keys[n] = LOOKUP_PAD_KEY;
+        table->masks[n] = LOOKUP_PAD_MASK;
+        table->addrs[n] = 0;
+        n++;
+    }
+    table->key_count = n;
+    return 0;
+}
+
+// 校验 offset 处的 DEST 表头并返回条目区，next 为表后的偏移
+static const uint8_t* dest_table_at(const uint8_t* image, size_t size, size_t offset,
+                                    fpga_dest_table_header_t* header, size_t* next) {
+    if (offset > size || size - offset < sizeof(fpga_dest_table_header_t)) {
+        return NULL;
+    }
+    memcpy(header, image + offset, sizeof(fpga_dest_table_header_t));
+    size_t body = sizeof(fpga_dest_entry_t) * (size_t)header->entry_count;
+    if (header->magic != FPGA_DEST_MAGIC ||
+        body > size - offset - sizeof(fpga_dest_table_header_t)) {
+        return NULL;
+    }
+    *next = offset + sizeof(fpga_dest_table_header_t) + body;
+    return image + offset + sizeof(fpga_dest_table_header_t);
+}
+
+static int compare_lookup_tables(const void* a, const void* b) {
+    uint32_t x = ((const lookup_table_t*)a)->switch_id;
+    uint32_t y = ((const lookup_table_t*)b)->switch_id;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// 从v1或v2镜像建立查找结构；镜像内存须在 route_lookup_free 之前保持有效
+int route_lookup_init(route_lookup_t* lookup, const uint8_t* image, size_t size) {
+    fpga_image_header_t image_header;
+    fpga_dest_table_header_t header;
+    uint32_t capacity = 0;
+    size_t pos = 0;
+    int status = 0;
+
+    memset(lookup, 0, sizeof(route_lookup_t));
+
+    if (size >= sizeof(image_header)) {
+        memcpy(&image_header, image, sizeof(image_header));
+    } else {
+        image_header.magic = 0;
+    }
+
+    if (image_header.magic == FPGA_IMAGE_MAGIC) {
+        // v2：按目录定位各表，并校验目录和条目区的CRC
+        size_t dir_size = sizeof(fpga_dir_record_t) * (size_t)image_header.switch_count;
+        if (image_header.version != FPGA_IMAGE_VERSION ||
+            dir_size > size - sizeof(image_header) ||
+            crc32_update(0, image + sizeof(image_header), dir_size) != image_header.dir_crc) {
+            LOG_ERROR("错误: 镜像目录无效或校验失败\n");
+            return -1;
+        }
+        capacity = image_header.switch_count;
+    } else {
+        // v1：连续的DEST表流，先数出表的个数
+        while (pos < size && status == 0) {
+            if (!dest_table_at(image, size, pos, &header, &pos)) {
+                LOG_ERROR("错误: 镜像偏移 %zu 处的路由表无效\n", pos);
+                status = -1;
+            }
+            capacity++;
+        }
+        if (status != 0) {
+            return -1;
+        }
+    }
+
+    lookup->tables = calloc(capacity ? capacity : 1, sizeof(lookup_table_t));
+    if (!lookup->tables) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    pos = 0;
+    for (uint32_t i = 0; i < capacity && status == 0; i++) {
+        const uint8_t* entries;
+        if (image_header.magic == FPGA_IMAGE_MAGIC) {
+            fpga_dir_record_t record;
+            size_t next;
+            memcpy(&record, image + sizeof(image_header) + sizeof(record) * i, sizeof(record));
+            entries = dest_table_at(image, size, record.offset, &header, &next);
+            if (!entries || header.switch_id != record.switch_id ||
+                header.entry_count != record.entry_count ||
+                crc32_update(0, entries, sizeof(fpga_dest_entry_t) * record.entry_count) != record.crc32) {
+                LOG_ERROR("错误: 镜像中Switch %u的路由表无效或校验失败\n", record.switch_id);
+                status = -1;
+                break;
+            }
+        } else {
+            entries = dest_table_at(image, size, pos, &header, &pos);
+        }
+        status = build_lookup_table(&lookup->tables[i], &lookup->arena, header.switch_id,
+                                    entries, header.entry_count);
+        lookup->table_count = i + 1;
+    }
+
+    // 按交换机ID排序后二分查找，ID重复的镜像无法确定查哪张表
+    if (status == 0) {
+        qsort(lookup->tables, lookup->table_count, sizeof(lookup_table_t), compare_lookup_tables);
+        for (uint32_t i = 1; i < lookup->table_count && status == 0; i++) {
+            if (lookup->tables[i].switch_id == lookup->tables[i - 1].switch_id) {
+                LOG_ERROR("错误: 镜像中Switch %u的路由表重复\n", lookup->tables[i].switch_id);
+                status = -1;
+            }
+        }
+    }
+
+    if (status != 0) {
+        route_lookup_free(lookup);
+        return -1;
+    }
+    return 0;
+}
+
+// 以只读 mmap 打开镜像文件并建立查找结构
+int route_lookup_open(route_lookup_t* lookup, const char* path) {
+    memset(lookup, 0, sizeof(route_lookup_t));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("错误: 无法打开文件 %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        LOG_ERROR("错误: %s 不是镜像文件\n", path);
+        close(fd);
+        return -1;
+    }
+
+    // 空文件无法映射，按没有任何表的v1镜像处理
+    size_t size = (size_t)st.st_size;
+    void* base = NULL;
+    if (size > 0) {
+        base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("错误: 无法映射文件 %s\n", path);
+        return -1;
+    }
+
+    if (route_lookup_init(lookup, base, size) != 0) {
+        if (base) {
+            munmap(base, size);
+        }
+        return -1;
+    }
+    lookup->mapping = base;
+    lookup->mapping_size = size;
+    return 0;
+}
+
+void route_lookup_free(route_lookup_t* lookup) {
+    free(lookup->tables);
+    topo_arena_free(&lookup->arena);
+    if (lookup->mapping) {
+        munmap(lookup->mapping, lookup->mapping_size);
+    }
+    memset(lookup, 0, sizeof(route_lookup_t));
+}
+
+const lookup_table_t* route_lookup_table(const route_lookup_t* lookup, uint32_t switch_id) {
+    uint32_t lo = 0;
+    uint32_t hi = lookup->table_count;
+
+    // 生成的镜像按ID 1..N 排列，先试直接下标
+    if (switch_id >= 1 && switch_id <= hi && lookup->tables[switch_id - 1].switch_id == switch_id) {
+        return &lookup->tables[switch_id - 1];
+    }
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (lookup->tables[mid].switch_id < switch_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < lookup->table_count && lookup->tables[lo].switch_id == switch_id) ? &lookup->tables[lo] : NULL;
+}
+
+// 返回命中条目的地址（含默认路由），没有路由时返回 -1
+// 从高地址向低地址扫描键列，第一个命中即键列中地址最大的命中；与哈希表的命中取较大者
+int32_t route_lookup_match(const lookup_table_t* table, uint32_t dst_ip) {
+    int32_t best = -1;
+
+    if (table->hash_addrs) {
+        uint32_t slot = lookup_hash(dst_ip, table->hash_mask);
+        while (table->hash_addrs[slot]) {
+            if (table->hash_keys[slot] == dst_ip) {
+                best = (int32_t)table->hash_addrs[slot] - 1;
+                break;
+            }
+            slot = (slot + 1) & table->hash_mask;
+        }
+    }
+
+#if LOOKUP_SSE2
+    const __m128i ip = _mm_set1_epi32((int)dst_ip);
+    for (uint32_t i = table->key_count; i > 0;) {
+        i -= LOOKUP_LANES;
+        __m128i keys = _mm_load_si128((const __m128i*)(table->keys + i));
+        __m128i masks = _mm_load_si128((const __m128i*)(table->masks + i));
+        int hits = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(ip, masks), keys));
+        if (hits) {
+            // 每个32位通道对应4个掩码位，取最高的命中通道
+            int32_t addr = (int32_t)table->addrs[i + (uint32_t)((31 - __builtin_clz((unsigned)hits)) >> 2)];
+            best = addr > best ? addr : best;
+            break;
+        }
+    }
+#else
+    for (uint32_t i = table->key_count; i > 0;) {
+        i--;
+        if ((dst_ip & table->masks[i]) == table->keys[i]) {
+            best = (int32_t)table->addrs[i] > best ? (int32_t)table->addrs[i] : best;
+            break;
+        }
+    }
+#endif
+    return best >= 0 ? best : table->default_addr;
+}
+
+void route_lookup_batch(const lookup_table_t* table, const uint32_t* dst_ips, size_t count, int32_t* addrs) {
+    for (size_t i = 0; i < count; i++) {
+        addrs[i] = route_lookup_match(table, dst_ips[i]);
+    }
+}
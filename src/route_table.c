@@ -0,0 +1,173 @@
+#include "yaml2fpga.h"
+#include <stddef.h>
+
+// ============ 路由表列存储 ============
+
+// 转发动作在 fpga_dest_entry_t 中的位置
+#define ENTRY_ACTION_OFFSET offsetof(fpga_dest_entry_t, out_port)
+
+int route_builder_init(route_builder_t* builder, const topology_config_t* config) {
+    uint32_t count = config->connection_count + 1;
+
+    memset(builder, 0, sizeof(route_builder_t));
+    builder->conn_action = malloc(sizeof(uint32_t) * count);
+    builder->conn_stamp = calloc(count, sizeof(uint32_t));
+    if (!builder->conn_action || !builder->conn_stamp) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        route_builder_free(builder);
+        return -1;
+    }
+    return 0;
+}
+
+// 释放临时映射和arena（arena中的表应已通过 topo_arena_merge 移交）
+void route_builder_free(route_builder_t* builder) {
+    free(builder->conn_action);
+    free(builder->conn_stamp);
+    topo_arena_free(&builder->arena);
+    memset(builder, 0, sizeof(route_builder_t));
+}
+
+// 在arena中分配各列；条目列按 entry_capacity，动作数组按 action_capacity
+// 动作数组最后分配，填充后可用 topo_arena_grow 原地收缩到实际数量
+int route_table_alloc(switch_table_t* table, topo_arena_t* arena,
+                      uint32_t entry_capacity, uint32_t action_capacity) {
+    size_t n = entry_capacity ? entry_capacity : 1;
+
+    table->entry_count = 0;
+    table->action_count = 0;
+    table->dst_ip = topo_arena_alloc(arena, sizeof(uint32_t) * n);
+    table->action_id = topo_arena_alloc(arena, sizeof(uint32_t) * n);
+    table->flags = topo_arena_alloc(arena, n);
+    table->wildcard = topo_arena_alloc(arena, n);
+    table->actions = topo_arena_alloc(arena, sizeof(route_action_t) * (action_capacity ? action_capacity : 1));
+    if (!table->dst_ip || !table->action_id || !table->flags || !table->wildcard || !table->actions) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+    return 0;
+}
+
+// 把 src 复制到 table，各列与动作数组分配在 arena 中
+int route_table_copy(switch_table_t* table, topo_arena_t* arena, const switch_table_t* src) {
+    if (route_table_alloc(table, arena, src->entry_count, src->action_count) != 0) {
+        return -1;
+    }
+    table->switch_id = src->switch_id;
+    table->entry_count = src->entry_count;
+    table->action_count = src->action_count;
+    table->lookups = src->lookups;
+    memcpy(table->dst_ip, src->dst_ip, sizeof(uint32_t) * src->entry_count);
+    memcpy(table->action_id, src->action_id, sizeof(uint32_t) * src->entry_count);
+    memcpy(table->flags, src->flags, src->entry_count);
+    memcpy(table->wildcard, src->wildcard, src->entry_count);
+    memcpy(table->actions, src->actions, sizeof(route_action_t) * src->action_count);
+    return 0;
+}
+
+// 打包第 i 条为硬件条目格式；无效条目为全0
+void route_table_pack(const switch_table_t* table, uint32_t i, fpga_dest_entry_t* entry) {
+    uint8_t flags = table->flags[i];
+
+    memset(entry, 0, sizeof(fpga_dest_entry_t));
+    if (!(flags & ROUTE_FLAG_VALID)) {
+        return;
+    }
+    entry->dst_ip = table->dst_ip[i];
+    entry->valid = 1;
+    entry->is_direct_host = (flags & ROUTE_FLAG_DIRECT) != 0;
+    entry->is_broadcast = (flags & ROUTE_FLAG_BROADCAST) != 0;
+    entry->is_default_route = (flags & ROUTE_FLAG_DEFAULT) != 0;
+    entry->prefix_wildcard = table->wildcard[i];
+    if (table->action_count > 0) {
+        memcpy((uint8_t*)entry + ENTRY_ACTION_OFFSET, &table->actions[table->action_id[i]],
+               sizeof(route_action_t));
+    }
+}
+
+// 两表中各一条是否打包后相同
+bool route_entry_equal(const switch_table_t* a, uint32_t i, const switch_table_t* b, uint32_t j) {
+    if (a->flags[i] != b->flags[j]) {
+        return false;
+    }
+    if (!(a->flags[i] & ROUTE_FLAG_VALID)) {
+        return true;
+    }
+    if (a->dst_ip[i] != b->dst_ip[j] || a->wildcard[i] != b->wildcard[j]) {
+        return false;
+    }
+    if (a->action_count == 0 || b->action_count == 0) {
+        return a->action_count == b->action_count;
+    }
+    return memcmp(&a->actions[a->action_id[i]], &b->actions[b->action_id[j]],
+                  sizeof(route_action_t)) == 0;
+}
+
+bool route_table_equal(const switch_table_t* a, const switch_table_t* b) {
+    if (a->entry_count != b->entry_count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->entry_count; i++) {
+        if (!route_entry_equal(a, i, b, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a
+static uint32_t action_hash(const route_action_t* action) {
+    const uint8_t* p = (const uint8_t*)action;
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < sizeof(route_action_t); k++) {
+        hash = (hash ^ p[k]) * 16777619u;
+    }
+    return hash;
+}
+
+// 由镜像中的打包条目（可能未对齐）建立列存储，转发动作按内容去重
+int route_table_from_entries(switch_table_t* table, topo_arena_t* arena,
+                             const uint8_t* entries, uint32_t entry_count) {
+    uint32_t capacity = 16;
+    while (capacity < entry_count * 2) {
+        capacity <<= 1;
+    }
+
+    uint32_t* slots = calloc(capacity, sizeof(uint32_t));   // 动作下标+1，0为空
+    if (!slots || route_table_alloc(table, arena, entry_count, entry_count) != 0) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(slots);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < entry_count; i++) {
+        fpga_dest_entry_t entry;
+        route_action_t action;
+        memcpy(&entry, entries + sizeof(fpga_dest_entry_t) * i, sizeof(entry));
+        memcpy(&action, (const uint8_t*)&entry + ENTRY_ACTION_OFFSET, sizeof(action));
+
+        table->dst_ip[i] = entry.dst_ip;
+        table->wildcard[i] = entry.prefix_wildcard;
+        table->flags[i] = (entry.valid ? ROUTE_FLAG_VALID : 0) |
+                          (entry.is_direct_host ? ROUTE_FLAG_DIRECT : 0) |
+                          (entry.is_broadcast ? ROUTE_FLAG_BROADCAST : 0) |
+                          (entry.is_default_route ? ROUTE_FLAG_DEFAULT : 0);
+
+        uint32_t slot = action_hash(&action) & (capacity - 1);
+        while (slots[slot] != 0 &&
+               memcmp(&table->actions[slots[slot] - 1], &action, sizeof(action)) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (slots[slot] == 0) {
+            table->actions[table->action_count] = action;
+            slots[slot] = ++table->action_count;
+        }
+        table->action_id[i] = slots[slot] - 1;
+    }
+
+    table->entry_count = entry_count;
+    table->actions = topo_arena_grow(arena, table->actions, sizeof(route_action_t) * entry_count,
+                                     sizeof(route_action_t) * table->action_count);
+    free(slots);
+    return 0;
+}
@@ -0,0 +1,480 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <errno.h>
+
+// ============ 稳定槽位与增量更新流 ============
+// 新路由表按旧表的槽位排布：旧表中已有的目的地（dst_ip + 是否默认路由）保持原地址，
+// 新增的目的地依次填入空闲槽位（旧表中失效或已删除的位置），不够时追加到末尾。
+// 空洞用全0条目（valid=0）占位。这样新旧两表逐槽位比较即可得到最少的写入。
+
+typedef struct {
+    uint64_t key;
+    uint32_t slot;
+} slot_key_t;
+
+static uint64_t entry_key(const switch_table_t* table, uint32_t i) {
+    return ((uint64_t)table->wildcard[i] << 33) |
+           ((uint64_t)((table->flags[i] & ROUTE_FLAG_DEFAULT) != 0) << 32) | table->dst_ip[i];
+}
+
+static int compare_slot_key(const void* a, const void* b) {
+    const slot_key_t* x = a;
+    const slot_key_t* y = b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->slot < y->slot ? -1 : (x->slot > y->slot);
+}
+
+// 在按键排序的数组中查找，返回首个匹配的槽位
+static uint32_t find_slot(const slot_key_t* keys, uint32_t count, uint64_t key) {
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (keys[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < count && keys[lo].key == key) ? keys[lo].slot : TOPO_INDEX_NONE;
+}
+
+// 把 table 的第 i 条移到新列的 slot 位置
+static void move_entry(const switch_table_t* table, uint32_t i, switch_table_t* placed, uint32_t slot) {
+    placed->dst_ip[slot] = table->dst_ip[i];
+    placed->action_id[slot] = table->action_id[i];
+    placed->flags[slot] = table->flags[i];
+    placed->wildcard[slot] = table->wildcard[i];
+}
+
+// 按旧表槽位重新排布 table 的条目（old_table 为NULL时保持原顺序）
+// 排布后的各列分配在 arena 中，动作数组沿用
+int place_stable_slots(const switch_table_t* old_table, switch_table_t* table, topo_arena_t* arena) {
+    uint32_t old_count = old_table ? old_table->entry_count : 0;
+    uint32_t capacity = old_count + table->entry_count;
+
+    if (old_count == 0 || table->entry_count == 0) {
+        return 0;
+    }
+
+    switch_table_t placed = *table;
+    placed.dst_ip = topo_arena_alloc(arena, sizeof(uint32_t) * capacity);
+    placed.action_id = topo_arena_alloc(arena, sizeof(uint32_t) * capacity);
+    placed.flags = topo_arena_alloc(arena, capacity);
+    placed.wildcard = topo_arena_alloc(arena, capacity);
+    slot_key_t* keys = malloc(sizeof(slot_key_t) * old_count);
+    bool* used = calloc(capacity, sizeof(bool));
+    uint32_t* pending = malloc(sizeof(uint32_t) * table->entry_count);
+    if (!placed.dst_ip || !placed.action_id || !placed.flags || !placed.wildcard ||
+        !keys || !used || !pending) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(keys);
+        free(used);
+        free(pending);
+        return -1;
+    }
+
+    // 空洞为全0（flags 为0即无效）
+    memset(placed.dst_ip, 0, sizeof(uint32_t) * capacity);
+    memset(placed.action_id, 0, sizeof(uint32_t) * capacity);
+    memset(placed.flags, 0, capacity);
+    memset(placed.wildcard, 0, capacity);
+
+    uint32_t key_count = 0;
+    for (uint32_t s = 0; s < old_count; s++) {
+        if (old_table->flags[s] & ROUTE_FLAG_VALID) {
+            keys[key_count].key = entry_key(old_table, s);
+            keys[key_count].slot = s;
+            key_count++;
+        }
+    }
+    qsort(keys, key_count, sizeof(slot_key_t), compare_slot_key);
+
+    // 已有目的地保持原槽位
+    uint32_t pending_count = 0;
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < table->entry_count; i++) {
+        uint32_t slot = find_slot(keys, key_count, entry_key(table, i));
+        if (slot != TOPO_INDEX_NONE && !used[slot]) {
+            move_entry(table, i, &placed, slot);
+            used[slot] = true;
+            length = slot + 1 > length ? slot + 1 : length;
+        } else {
+            pending[pending_count++] = i;
+        }
+    }
+
+    // 新目的地填入空闲槽位
+    uint32_t cursor = 0;
+    for (uint32_t p = 0; p < pending_count; p++) {
+        while (used[cursor]) {
+            cursor++;
+        }
+        move_entry(table, pending[p], &placed, cursor);
+        used[cursor] = true;
+        length = cursor + 1 > length ? cursor + 1 : length;
+    }
+
+    placed.entry_count = length;
+    *table = placed;
+
+    free(keys);
+    free(used);
+    free(pending);
+    return 0;
+}
+
+// 新旧两表逐槽位比较，把差异写成写记录，返回记录数
+static uint32_t diff_slots(const switch_table_t* old_table, const switch_table_t* table,
+                           fpga_delta_write_t* writes, uint32_t* invalidations) {
+    uint32_t old_count = old_table ? old_table->entry_count : 0;
+    uint32_t count = old_count > table->entry_count ? old_count : table->entry_count;
+    uint32_t write_count = 0;
+
+    *invalidations = 0;
+    for (uint32_t s = 0; s < count; s++) {
+        bool old_valid = s < old_count && (old_table->flags[s] & ROUTE_FLAG_VALID);
+        bool new_valid = s < table->entry_count && (table->flags[s] & ROUTE_FLAG_VALID);
+
+        if (new_valid) {
+            if (old_valid && route_entry_equal(old_table, s, table, s)) {
+                continue;
+            }
+            fpga_dest_entry_t entry;
+            route_table_pack(table, s, &entry);
+            writes[write_count].flags = 0;
+            writes[write_count].entry = entry;
+        } else if (old_valid) {
+            writes[write_count].flags = FPGA_DELTA_INVALIDATE;
+            memset(&writes[write_count].entry, 0, sizeof(fpga_dest_entry_t));
+            (*invalidations)++;
+        } else {
+            continue;
+        }
+        writes[write_count].addr = s;
+        write_count++;
+    }
+    return write_count;
+}
+
+// 在 old_tables 中查找与 switch_id 对应的表，hint 为预期位置
+static const switch_table_t* find_old_table(const routing_tables_t* old_tables,
+                                            uint32_t switch_id, uint32_t hint) {
+    for (uint32_t k = 0; k < old_tables->table_count; k++) {
+        // 两边通常都按交换机ID顺序排列，k == 0 即命中
+        uint32_t probe = (hint + k) % old_tables->table_count;
+        if (old_tables->tables[probe].switch_id == switch_id) {
+            return &old_tables->tables[probe];
+        }
+    }
+    return NULL;
+}
+
+// 按 old_tables 的槽位排布 tables 中的全部路由表
+// 交换机按ID对应；old_tables 中没有的交换机保持原顺序
+// 排布后仍有空洞的表单独输出一行（构建时的摘要是排布前的条目数）
+int place_routing_tables(const routing_tables_t* old_tables, routing_tables_t* tables) {
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        switch_table_t* table = &tables->tables[i];
+        if (place_stable_slots(find_old_table(old_tables, table->switch_id, i), table, &tables->arena) != 0) {
+            return -1;
+        }
+
+        uint32_t live = 0;
+        for (uint32_t s = 0; s < table->entry_count; s++) {
+            live += (table->flags[s] & ROUTE_FLAG_VALID) != 0;
+        }
+        uint32_t holes = table->entry_count - live;
+        if (holes == 0) {
+            continue;
+        }
+        LOG_INFO("Switch %u: 排布后%u槽位 (有效%u, 空洞%u)\n", table->switch_id,
+                 table->entry_count, live, holes);
+        // 删除少量目的地留下的空洞会被后续新增的目的地填上；空洞比有效条目还多，
+        // 通常是过时或手工改过的槽位映射把条目放到了远超表长的槽位
+        if (holes > live) {
+            LOG_WARN("警告: Switch %u 的空洞(%u)多于有效条目(%u)，槽位映射可能已过时\n",
+                     table->switch_id, holes, live);
+        }
+    }
+    return 0;
+}
+
+// 按稳定槽位排布 tables 中的全部路由表，并生成相对 old_tables 的增量更新流
+// 旧镜像中没有的交换机视为空表（全部写入）
+int build_routing_delta(const routing_tables_t* old_tables, routing_tables_t* tables,
+                        uint8_t** delta, size_t* delta_size) {
+    size_t capacity = sizeof(fpga_delta_header_t);
+
+    if (place_routing_tables(old_tables, tables) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* old_table = find_old_table(old_tables, tables->tables[i].switch_id, i);
+        uint32_t old_count = old_table ? old_table->entry_count : 0;
+        uint32_t new_count = tables->tables[i].entry_count;
+        uint32_t slots = old_count > new_count ? old_count : new_count;
+        capacity += sizeof(fpga_delta_switch_t) + sizeof(fpga_delta_write_t) * (size_t)slots;
+    }
+
+    uint8_t* buf = malloc(capacity);
+    if (!buf) {
+        LOG_ERROR("错误: 内存分配失败 (%zu字节)\n", capacity);
+        return -1;
+    }
+
+    fpga_delta_header_t header;
+    size_t pos = sizeof(header);
+    uint32_t changed = 0;
+
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* table = &tables->tables[i];
+        const switch_table_t* old_table = find_old_table(old_tables, table->switch_id, i);
+        fpga_delta_switch_t section;
+        uint32_t invalidations;
+        fpga_delta_write_t* writes = (fpga_delta_write_t*)(buf + pos + sizeof(section));
+
+        section.switch_id = table->switch_id;
+        section.write_count = diff_slots(old_table, table, writes, &invalidations);
+        section.entry_count = table->entry_count;
+        section.reserved = 0;
+        if (section.write_count == 0) {
+            continue;
+        }
+
+        memcpy(buf + pos, &section, sizeof(section));
+        pos += sizeof(section) + sizeof(fpga_delta_write_t) * section.write_count;
+        changed++;
+
+        LOG_INFO("  Switch %u: %u次写入 (其中失效%u), 路由表%u槽位\n",
+                 table->switch_id, section.write_count, invalidations, table->entry_count);
+    }
+
+    header.magic = FPGA_DELTA_MAGIC;
+    header.version = FPGA_DELTA_VERSION;
+    header.switch_count = changed;
+    header.reserved = 0;
+    memcpy(buf, &header, sizeof(header));
+
+    *delta = buf;
+    *delta_size = pos;
+    return 0;
+}
+
+// ============ 槽位映射文件（--slot-map）============
+// 文本格式，每行一个有效条目: "<switch_id> <slot> <dst_ip[/前缀长度]|default>"，'#' 开头为注释
+// 加载后转换成只含匹配键的路由表，与上一版镜像一样作为 place_stable_slots 的排布基准
+
+typedef struct {
+    uint32_t switch_id;
+    uint32_t slot;
+    uint32_t dst_ip;
+    uint8_t  is_default;
+    uint8_t  wildcard;
+} slot_record_t;
+
+static int compare_slot_record(const void* a, const void* b) {
+    const slot_record_t* x = a;
+    const slot_record_t* y = b;
+    if (x->switch_id != y->switch_id) {
+        return x->switch_id < y->switch_id ? -1 : 1;
+    }
+    return x->slot < y->slot ? -1 : (x->slot > y->slot);
+}
+
+static int parse_slot_line(const char* line, slot_record_t* record) {
+    char target[32];
+    unsigned a, b, c, d;
+    unsigned prefix_len = 32;
+    char tail;
+    int fields;
+
+    if (sscanf(line, "%u %u %31s %c", &record->switch_id, &record->slot, target, &tail) != 3) {
+        return -1;
+    }
+    if (record->slot >= SLOT_MAP_MAX_SLOT) {
+        return -1;
+    }
+    if (strcmp(target, "default") == 0) {
+        record->dst_ip = 0xFFFFFFFFu;
+        record->is_default = 1;
+        record->wildcard = 0;
+        return 0;
+    }
+    fields = sscanf(target, "%u.%u.%u.%u/%u%c", &a, &b, &c, &d, &prefix_len, &tail);
+    if ((fields != 4 && fields != 5) || a > 255 || b > 255 || c > 255 || d > 255 ||
+        prefix_len < 32 - PREFIX_WILDCARD_MAX || prefix_len > 32) {
+        return -1;
+    }
+    record->dst_ip = (a << 24) | (b << 16) | (c << 8) | d;
+    record->is_default = 0;
+    record->wildcard = (uint8_t)(32 - prefix_len);
+    return 0;
+}
+
+// 由按 (交换机, 槽位) 排序的记录建立只含匹配键的路由表
+static int slot_records_to_tables(const slot_record_t* records, uint32_t count,
+                                  routing_tables_t* map) {
+    uint32_t table_count = 0;
+    for (uint32_t r = 0; r < count; r++) {
+        if (r == 0 || records[r].switch_id != records[r - 1].switch_id) {
+            table_count++;
+        }
+    }
+
+    map->tables = calloc(table_count ? table_count : 1, sizeof(switch_table_t));
+    if (!map->tables) {
+        return -1;
+    }
+
+    uint32_t r = 0;
+    while (r < count) {
+        switch_table_t* table = &map->tables[map->table_count];
+        uint32_t end = r;
+        while (end < count && records[end].switch_id == records[r].switch_id) {
+            end++;
+        }
+
+        uint32_t slots = records[end - 1].slot + 1;
+        map->table_count++;
+        if (route_table_alloc(table, &map->arena, slots, 0) != 0) {
+            return -1;
+        }
+        table->switch_id = records[r].switch_id;
+        table->entry_count = slots;
+        memset(table->dst_ip, 0, sizeof(uint32_t) * slots);
+        memset(table->action_id, 0, sizeof(uint32_t) * slots);
+        memset(table->flags, 0, slots);
+        memset(table->wildcard, 0, slots);
+        for (; r < end; r++) {
+            uint32_t slot = records[r].slot;
+            table->dst_ip[slot] = records[r].dst_ip;
+            table->wildcard[slot] = records[r].wildcard;
+            table->flags[slot] = ROUTE_FLAG_VALID | (records[r].is_default ? ROUTE_FLAG_DEFAULT : 0);
+        }
+    }
+    return 0;
+}
+
+// 加载槽位映射；文件不存在时返回空映射（首次运行）
+int load_slot_map(const char* filename, routing_tables_t* map) {
+    FILE* fp;
+    char line[256];
+    slot_record_t* records = NULL;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    uint32_t line_no = 0;
+    int result = 0;
+
+    memset(map, 0, sizeof(routing_tables_t));
+    fp = fopen(filename, "r");
+    if (!fp) {
+        if (errno == ENOENT) {
+            LOG_INFO("槽位映射 %s 不存在，将按发现顺序排布并新建\n", filename);
+            return 0;
+        }
+        LOG_ERROR("错误: 无法打开槽位映射文件 %s: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    while (result == 0 && fgets(line, sizeof(line), fp)) {
+        const char* p = line;
+        line_no++;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        if (count == capacity) {
+            uint32_t grown_capacity = capacity ? capacity * 2 : 256;
+            slot_record_t* grown = realloc(records, sizeof(slot_record_t) * grown_capacity);
+            if (!grown) {
+                LOG_ERROR("错误: 内存分配失败\n");
+                result = -1;
+                break;
+            }
+            records = grown;
+            capacity = grown_capacity;
+        }
+        if (parse_slot_line(p, &records[count]) != 0) {
+            LOG_ERROR("错误: 槽位映射 %s 第%u行格式错误\n", filename, line_no);
+            result = -1;
+            break;
+        }
+        count++;
+    }
+    if (result == 0 && ferror(fp)) {
+        LOG_ERROR("错误: 读取槽位映射 %s 失败\n", filename);
+        result = -1;
+    }
+    fclose(fp);
+
+    if (result == 0) {
+        qsort(records, count, sizeof(slot_record_t), compare_slot_record);
+        for (uint32_t r = 1; r < count; r++) {
+            if (records[r].switch_id == records[r - 1].switch_id &&
+                records[r].slot == records[r - 1].slot) {
+                LOG_ERROR("错误: 槽位映射 %s 中 Switch %u 的槽位 %u 重复\n",
+                          filename, records[r].switch_id, records[r].slot);
+                result = -1;
+                break;
+            }
+        }
+    }
+    if (result == 0 && slot_records_to_tables(records, count, map) != 0) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        result = -1;
+    }
+
+    free(records);
+    if (result != 0) {
+        free_routing_tables(map);
+        return -1;
+    }
+    LOG_INFO("已加载槽位映射 %s (%u个交换机, %u个条目)\n", filename, map->table_count, count);
+    return 0;
+}
+
+// 把已排布路由表的有效条目写成槽位映射（原子替换）
+int save_slot_map(const char* filename, const routing_tables_t* tables) {
+    char* text = NULL;
+    size_t text_len = 0;
+    FILE* out = open_memstream(&text, &text_len);
+    if (!out) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        return -1;
+    }
+
+    fprintf(out, "# yaml2fpga slot map: <switch_id> <slot> <dst_ip[/prefix_len]|default>\n");
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* table = &tables->tables[i];
+        for (uint32_t s = 0; s < table->entry_count; s++) {
+            uint8_t flags = table->flags[s];
+            if (!(flags & ROUTE_FLAG_VALID)) {
+                continue;
+            }
+            if (flags & ROUTE_FLAG_DEFAULT) {
+                fprintf(out, "%u %u default\n", table->switch_id, s);
+            } else if (table->wildcard[s]) {
+                fprintf(out, "%u %u " IP_FMT "/%u\n", table->switch_id, s,
+                        IP_ARGS(table->dst_ip[s]), 32u - table->wildcard[s]);
+            } else {
+                fprintf(out, "%u %u " IP_FMT "\n", table->switch_id, s, IP_ARGS(table->dst_ip[s]));
+            }
+        }
+    }
+
+    int result = -1;
+    if (fclose(out) == 0) {
+        result = write_file_atomic(filename, text, text_len);
+    } else {
+        LOG_ERROR("错误: 内存分配失败\n");
+    }
+    free(text);
+    return result;
+}
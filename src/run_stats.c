@@ -0,0 +1,68 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <time.h>
+#include <stdarg.h>
+
+// ============ 日志级别 ============
+
+log_level_t yaml2fpga_log_level = LOG_LEVEL_INFO;
+
+__thread error_sink_t* yaml2fpga_error_sink = NULL;
+
+// 输出一条错误；装有错误收集器时只记录第一条，供库接口返回给调用者
+void log_error(const char* fmt, ...) {
+    error_sink_t* sink = yaml2fpga_error_sink;
+    va_list args;
+
+    va_start(args, fmt);
+    if (!sink) {
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+        return;
+    }
+
+    pthread_mutex_lock(&sink->lock);
+    if (sink->count++ == 0) {
+        static const char prefix[] = "错误: ";
+        char message[ERROR_MESSAGE_MAX];
+        const char* text = message;
+        vsnprintf(message, sizeof(message), fmt, args);
+        if (strncmp(text, prefix, sizeof(prefix) - 1) == 0) {
+            text += sizeof(prefix) - 1;
+        }
+        size_t len = strcspn(text, "\n");
+        memcpy(sink->message, text, len);
+        sink->message[len] = '\0';
+    }
+    pthread_mutex_unlock(&sink->lock);
+    va_end(args);
+}
+
+// ============ 运行统计（--stats）============
+
+// 单调时钟，毫秒
+double stats_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+// 以单个JSON对象输出统计结果（一行，便于流水线逐行解析）
+void write_stats_json(FILE* out, const run_stats_t* stats) {
+    fprintf(out,
+            "{\"phases_ms\":{\"parse\":%.3f,\"index\":%.3f,\"validate\":%.3f,"
+            "\"route\":%.3f,\"serialize\":%.3f,\"write\":%.3f,\"total\":%.3f},"
+            "\"counters\":{\"yaml_events\":%llu,\"switches\":%llu,\"connections\":%llu,"
+            "\"hosts\":%llu,\"lookups\":%llu,\"tables\":%llu,\"entries\":%llu,"
+            "\"bytes_written\":%llu}}\n",
+            stats->parse_ms, stats->index_ms, stats->validate_ms,
+            stats->route_ms, stats->serialize_ms, stats->write_ms, stats->total_ms,
+            (unsigned long long)stats->yaml_events,
+            (unsigned long long)stats->switches,
+            (unsigned long long)stats->connections,
+            (unsigned long long)stats->hosts,
+            (unsigned long long)stats->lookups,
+            (unsigned long long)stats->tables,
+            (unsigned long long)stats->entries,
+            (unsigned long long)stats->bytes_written);
+}
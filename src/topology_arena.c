@@ -0,0 +1,100 @@
+#include "yaml2fpga.h"
+
+#define ARENA_MIN_BLOCK (64 * 1024)
+#define ARENA_ALIGN 16
+
+struct topo_arena_block {
+    topo_arena_block_t* next;
+    size_t size;                 // data 区容量
+    size_t used;                 // 已用字节
+    size_t last;                 // 最近一次分配的起始偏移（用于原地扩展）
+    unsigned char data[];
+};
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+void* topo_arena_alloc(topo_arena_t* arena, size_t size) {
+    topo_arena_block_t* block = arena->head;
+    size = align_up(size ? size : 1);
+
+    if (!block || block->size - block->used < size) {
+        size_t block_size = ARENA_MIN_BLOCK;
+        while (block_size < size) {
+            block_size <<= 1;
+        }
+
+        block = malloc(sizeof(topo_arena_block_t) + block_size);
+        if (!block) {
+            return NULL;
+        }
+        block->next = arena->head;
+        block->size = block_size;
+        block->used = 0;
+        block->last = 0;
+        arena->head = block;
+        arena->total += block_size;
+    }
+
+    block->last = block->used;
+    block->used += size;
+    return block->data + block->last;
+}
+
+// 扩展一段已分配的内存：若是当前块的最后一次分配且空间足够则原地扩展，
+// 否则重新分配并拷贝（旧空间随arena一起释放）
+// 收缩（new_size <= old_size）总是原地完成，不会重新分配；只有最后一次分配能归还尾部空间
+void* topo_arena_grow(topo_arena_t* arena, void* ptr, size_t old_size, size_t new_size) {
+    topo_arena_block_t* block = arena->head;
+
+    if (!ptr) {
+        return topo_arena_alloc(arena, new_size);
+    }
+
+    bool is_last = block && (unsigned char*)ptr == block->data + block->last;
+    if (is_last && block->size - block->last >= align_up(new_size)) {
+        block->used = block->last + align_up(new_size);
+        return ptr;
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    void* grown = topo_arena_alloc(arena, new_size);
+    if (grown) {
+        memcpy(grown, ptr, old_size);
+    }
+    return grown;
+}
+
+void topo_arena_free(topo_arena_t* arena) {
+    topo_arena_block_t* block = arena->head;
+    while (block) {
+        topo_arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->total = 0;
+}
+
+// 把 from 的全部块并入 into（接在链表尾部，into 的当前块不变），from 随后为空
+// 用于把各工作线程arena中构建的数据移交给最终的所有者
+void topo_arena_merge(topo_arena_t* into, topo_arena_t* from) {
+    if (!from->head) {
+        return;
+    }
+    if (!into->head) {
+        into->head = from->head;
+    } else {
+        topo_arena_block_t* tail = into->head;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = from->head;
+    }
+    into->total += from->total;
+    from->head = NULL;
+    from->total = 0;
+}
@@ -0,0 +1,138 @@
+#include "yaml2fpga.h"
+
+// ============ 哈希表 ============
+
+static uint32_t hash_u64(uint64_t key) {
+    // splitmix64 终结函数，保证低位分布均匀
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+static int topo_hash_init(topo_hash_t* hash, topo_arena_t* arena, uint32_t expected) {
+    uint32_t capacity = 16;
+    while (capacity < expected * 2) {
+        capacity <<= 1;
+    }
+
+    hash->keys = topo_arena_alloc(arena, sizeof(uint64_t) * capacity);
+    hash->values = topo_arena_alloc(arena, sizeof(uint32_t) * capacity);
+    if (!hash->keys || !hash->values) {
+        return -1;
+    }
+
+    // 空槽的键也清零，保证快照内容可复现
+    memset(hash->keys, 0, sizeof(uint64_t) * capacity);
+    memset(hash->values, 0xFF, sizeof(uint32_t) * capacity);
+    hash->mask = capacity - 1;
+    return 0;
+}
+
+// 插入键值，键已存在时保留先插入的值（与原线性扫描"首个匹配"语义一致）
+// 返回是否为新插入
+static bool topo_hash_put(topo_hash_t* hash, uint64_t key, uint32_t value) {
+    uint32_t slot = hash_u64(key) & hash->mask;
+    while (hash->values[slot] != TOPO_INDEX_NONE) {
+        if (hash->keys[slot] == key) {
+            return false;
+        }
+        slot = (slot + 1) & hash->mask;
+    }
+    hash->keys[slot] = key;
+    hash->values[slot] = value;
+    return true;
+}
+
+uint32_t topo_hash_get(const topo_hash_t* hash, uint64_t key) {
+    if (!hash->values) {
+        return TOPO_INDEX_NONE;
+    }
+
+    uint32_t slot = hash_u64(key) & hash->mask;
+    while (hash->values[slot] != TOPO_INDEX_NONE) {
+        if (hash->keys[slot] == key) {
+            return hash->values[slot];
+        }
+        slot = (slot + 1) & hash->mask;
+    }
+    return TOPO_INDEX_NONE;
+}
+
+// ============ 拓扑索引构建 ============
+
+// 一次遍历全部连接，建立按交换机ID、Host IP、接口IP和父子链路的O(1)查找表
+// 索引存储分配在拓扑arena中，随 cleanup_topology 一并释放
+int build_topology_index(topology_config_t* config) {
+    topology_index_t* index = &config->index;
+    topo_arena_t* arena = &config->arena;
+    uint32_t switch_count = config->switch_count;
+    uint32_t connection_count = config->connection_count;
+
+    memset(index, 0, sizeof(topology_index_t));
+    index->root = TOPO_INDEX_NONE;
+    index->uplink = topo_arena_alloc(arena, sizeof(uint32_t) * (switch_count + 1));
+    index->parent = topo_arena_alloc(arena, sizeof(uint32_t) * (switch_count + 1));
+    index->owner = topo_arena_alloc(arena, sizeof(uint32_t) * (connection_count + 1));
+    index->hosts = topo_arena_alloc(arena, sizeof(uint32_t) * (connection_count + 1));
+
+    if (!index->uplink || !index->parent || !index->owner || !index->hosts ||
+        topo_hash_init(&index->switch_by_id, arena, switch_count) != 0 ||
+        topo_hash_init(&index->switch_by_ip, arena, connection_count) != 0 ||
+        topo_hash_init(&index->host_by_ip, arena, connection_count) != 0 ||
+        topo_hash_init(&index->downlink, arena, connection_count) != 0) {
+        LOG_ERROR("错误: 拓扑索引内存分配失败\n");
+        memset(index, 0, sizeof(topology_index_t));
+        return -1;
+    }
+
+    // 交换机ID与主接口IP（connections[0].my_ip 用于识别父交换机）
+    for (uint32_t i = 0; i < switch_count; i++) {
+        const switch_config_t* sw = &config->switches[i];
+
+        topo_hash_put(&index->switch_by_id, sw->id, i);
+        if (sw->is_root && index->root == TOPO_INDEX_NONE) {
+            index->root = i;
+        }
+        if (sw->connection_count > 0) {
+            topo_hash_put(&index->switch_by_ip, SWITCH_CONN(config, sw, 0)->my_ip, i);
+        }
+    }
+
+    // 逐连接登记：其余接口IP、Host归属、下行链路和上行链路
+    for (uint32_t i = 0; i < switch_count; i++) {
+        const switch_config_t* sw = &config->switches[i];
+
+        index->uplink[i] = TOPO_INDEX_NONE;
+        for (uint32_t j = 0; j < sw->connection_count; j++) {
+            uint32_t ref = sw->connection_offset + j;
+            const network_connection_t* conn = &config->connections[ref];
+
+            index->owner[ref] = i;
+            topo_hash_put(&index->switch_by_ip, conn->my_ip, i);
+
+            if (conn->up == CONN_DOWN) {
+                if (topo_hash_put(&index->host_by_ip, conn->peer_ip, ref)) {
+                    index->hosts[index->host_count++] = conn->peer_ip;
+                }
+                topo_hash_put(&index->downlink, ((uint64_t)i << 32) | conn->peer_ip, ref);
+            } else if (index->uplink[i] == TOPO_INDEX_NONE) {
+                index->uplink[i] = ref;
+            }
+        }
+    }
+
+    // 通过上行链路的对端IP解析父交换机
+    for (uint32_t i = 0; i < switch_count; i++) {
+        index->parent[i] = TOPO_INDEX_NONE;
+        if (index->uplink[i] != TOPO_INDEX_NONE) {
+            const network_connection_t* uplink = &config->connections[index->uplink[i]];
+            index->parent[i] = topo_hash_get(&index->switch_by_ip, uplink->peer_ip);
+        }
+    }
+
+    index->ready = true;
+    return 0;
+}
@@ -0,0 +1,329 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// ============ 拓扑快照（.topo）============
+// 解析并建好索引的拓扑按扁平布局保存：定长文件头 + 若干16字节对齐的数据段
+// （交换机、连接、索引数组和哈希表）。加载时整体 mmap，校验后直接把
+// topology_config_t 的指针指向映射区，不做任何反序列化。
+// 记录按本机结构体布局原样存储，文件头记录结构体大小与字节序标记，不匹配时拒绝加载。
+
+#define TOPO_SNAPSHOT_MAGIC   0x4F504F54u   // "TOPO"
+#define TOPO_SNAPSHOT_VERSION 1
+#define TOPO_SNAPSHOT_ENDIAN  0x01020304u
+#define TOPO_SNAPSHOT_ALIGN   16
+
+enum {
+    SECTION_SWITCHES = 0,
+    SECTION_CONNECTIONS,
+    SECTION_UPLINK,
+    SECTION_PARENT,
+    SECTION_OWNER,
+    SECTION_HOSTS,
+    SECTION_SWITCH_BY_ID_KEYS,
+    SECTION_SWITCH_BY_ID_VALUES,
+    SECTION_SWITCH_BY_IP_KEYS,
+    SECTION_SWITCH_BY_IP_VALUES,
+    SECTION_HOST_BY_IP_KEYS,
+    SECTION_HOST_BY_IP_VALUES,
+    SECTION_DOWNLINK_KEYS,
+    SECTION_DOWNLINK_VALUES,
+    SECTION_COUNT
+};
+
+typedef struct {
+    uint64_t offset;             // 相对文件开头
+    uint64_t size;               // 字节数
+} topo_snapshot_section_t;
+
+typedef struct {
+    uint32_t magic;              // TOPO_SNAPSHOT_MAGIC
+    uint32_t version;            // TOPO_SNAPSHOT_VERSION
+    uint32_t header_size;        // sizeof(topo_snapshot_header_t)
+    uint32_t endian;             // TOPO_SNAPSHOT_ENDIAN
+    uint32_t switch_record_size; // sizeof(switch_config_t)
+    uint32_t connection_record_size; // sizeof(network_connection_t)
+    uint32_t switch_count;
+    uint32_t connection_count;
+    uint32_t host_count;
+    uint32_t root;
+    uint32_t hash_mask[4];       // switch_by_id, switch_by_ip, host_by_ip, downlink
+    uint32_t section_count;      // SECTION_COUNT
+    uint32_t payload_crc;        // 文件头之后全部字节的CRC32
+    topo_snapshot_section_t sections[SECTION_COUNT];
+    uint32_t header_crc;         // 本字段之前文件头字节的CRC32
+    uint32_t reserved;
+} topo_snapshot_header_t;
+
+static size_t align_section(size_t size) {
+    return (size + TOPO_SNAPSHOT_ALIGN - 1) & ~(size_t)(TOPO_SNAPSHOT_ALIGN - 1);
+}
+
+// 各数据段的源数据与大小（保存与加载共用同一张表，保证段顺序一致）
+static void snapshot_sections(const topology_config_t* config, const void* data[SECTION_COUNT],
+                              size_t size[SECTION_COUNT]) {
+    const topology_index_t* index = &config->index;
+    const topo_hash_t* hashes[4] = {
+        &index->switch_by_id, &index->switch_by_ip, &index->host_by_ip, &index->downlink
+    };
+
+    data[SECTION_SWITCHES] = config->switches;
+    size[SECTION_SWITCHES] = sizeof(switch_config_t) * config->switch_count;
+    data[SECTION_CONNECTIONS] = config->connections;
+    size[SECTION_CONNECTIONS] = sizeof(network_connection_t) * config->connection_count;
+    data[SECTION_UPLINK] = index->uplink;
+    size[SECTION_UPLINK] = sizeof(uint32_t) * config->switch_count;
+    data[SECTION_PARENT] = index->parent;
+    size[SECTION_PARENT] = sizeof(uint32_t) * config->switch_count;
+    data[SECTION_OWNER] = index->owner;
+    size[SECTION_OWNER] = sizeof(uint32_t) * config->connection_count;
+    data[SECTION_HOSTS] = index->hosts;
+    size[SECTION_HOSTS] = sizeof(uint32_t) * index->host_count;
+
+    for (int h = 0; h < 4; h++) {
+        size_t capacity = (size_t)hashes[h]->mask + 1;
+        data[SECTION_SWITCH_BY_ID_KEYS + h * 2] = hashes[h]->keys;
+        size[SECTION_SWITCH_BY_ID_KEYS + h * 2] = sizeof(uint64_t) * capacity;
+        data[SECTION_SWITCH_BY_ID_VALUES + h * 2] = hashes[h]->values;
+        size[SECTION_SWITCH_BY_ID_VALUES + h * 2] = sizeof(uint32_t) * capacity;
+    }
+}
+
+// ============ 保存 ============
+
+int save_topology_snapshot(const topology_config_t* config, const char* filename) {
+    const void* data[SECTION_COUNT];
+    size_t size[SECTION_COUNT];
+    topo_snapshot_header_t header;
+
+    if (!config->index.ready) {
+        LOG_ERROR("错误: 拓扑索引未构建，无法保存快照\n");
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    snapshot_sections(config, data, size);
+
+    size_t total = align_section(sizeof(header));
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        header.sections[s].offset = total;
+        header.sections[s].size = size[s];
+        total += align_section(size[s]);
+    }
+
+    uint8_t* buf = calloc(1, total);
+    if (!buf) {
+        LOG_ERROR("错误: 内存分配失败 (%zu字节)\n", total);
+        return -1;
+    }
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (size[s] > 0) {
+            memcpy(buf + header.sections[s].offset, data[s], size[s]);
+        }
+    }
+
+    header.magic = TOPO_SNAPSHOT_MAGIC;
+    header.version = TOPO_SNAPSHOT_VERSION;
+    header.header_size = sizeof(header);
+    header.endian = TOPO_SNAPSHOT_ENDIAN;
+    header.switch_record_size = sizeof(switch_config_t);
+    header.connection_record_size = sizeof(network_connection_t);
+    header.switch_count = config->switch_count;
+    header.connection_count = config->connection_count;
+    header.host_count = config->index.host_count;
+    header.root = config->index.root;
+    header.hash_mask[0] = config->index.switch_by_id.mask;
+    header.hash_mask[1] = config->index.switch_by_ip.mask;
+    header.hash_mask[2] = config->index.host_by_ip.mask;
+    header.hash_mask[3] = config->index.downlink.mask;
+    header.section_count = SECTION_COUNT;
+    header.payload_crc = crc32_update(0, buf + align_section(sizeof(header)),
+                                      total - align_section(sizeof(header)));
+    header.header_crc = crc32_update(0, &header, offsetof(topo_snapshot_header_t, header_crc));
+    memcpy(buf, &header, sizeof(header));
+
+    int result = write_file_atomic(filename, buf, total);
+    free(buf);
+    if (result == 0) {
+        LOG_INFO("已保存拓扑快照: %s (%zu字节)\n", filename, total);
+    }
+    return result;
+}
+
+// ============ 加载 ============
+
+// 校验文件头与各数据段边界，失败时打印原因
+static int validate_snapshot(const uint8_t* base, size_t file_size, const char* filename) {
+    const topo_snapshot_header_t* header = (const topo_snapshot_header_t*)base;
+
+    if (file_size < sizeof(topo_snapshot_header_t) || header->magic != TOPO_SNAPSHOT_MAGIC) {
+        LOG_ERROR("错误: %s 不是拓扑快照文件\n", filename);
+        return -1;
+    }
+    if (header->version != TOPO_SNAPSHOT_VERSION || header->header_size != sizeof(topo_snapshot_header_t) ||
+        header->section_count != SECTION_COUNT) {
+        LOG_ERROR("错误: %s 快照版本不受支持 (版本 %u)\n", filename, header->version);
+        return -1;
+    }
+    if (header->endian != TOPO_SNAPSHOT_ENDIAN ||
+        header->switch_record_size != sizeof(switch_config_t) ||
+        header->connection_record_size != sizeof(network_connection_t)) {
+        LOG_ERROR("错误: %s 由不同字节序或结构布局的程序生成\n", filename);
+        return -1;
+    }
+    if (crc32_update(0, header, offsetof(topo_snapshot_header_t, header_crc)) != header->header_crc) {
+        LOG_ERROR("错误: %s 文件头校验失败\n", filename);
+        return -1;
+    }
+
+    for (int h = 0; h < 4; h++) {
+        if ((header->hash_mask[h] & (header->hash_mask[h] + 1)) != 0) {
+            LOG_ERROR("错误: %s 哈希表容量无效\n", filename);
+            return -1;
+        }
+    }
+    if (header->root != TOPO_INDEX_NONE && header->root >= header->switch_count) {
+        LOG_ERROR("错误: %s 根交换机下标无效\n", filename);
+        return -1;
+    }
+
+    size_t payload = align_section(sizeof(topo_snapshot_header_t));
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        const topo_snapshot_section_t* section = &header->sections[s];
+        if (section->offset < payload || section->offset % TOPO_SNAPSHOT_ALIGN != 0 ||
+            section->offset > file_size || section->size > file_size - section->offset) {
+            LOG_ERROR("错误: %s 数据段 %d 越界\n", filename, s);
+            return -1;
+        }
+    }
+
+    if (crc32_update(0, base + payload, file_size - payload) != header->payload_crc) {
+        LOG_ERROR("错误: %s 数据校验失败\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+// 下标数组中的每个值都必须小于 limit（allow_none 时也可为 TOPO_INDEX_NONE）
+static bool indices_in_range(const uint32_t* values, size_t count, uint32_t limit, bool allow_none) {
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] >= limit && !(allow_none && values[i] == TOPO_INDEX_NONE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int load_topology_snapshot(const char* filename, topology_config_t* config) {
+    memset(config, 0, sizeof(topology_config_t));
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        LOG_ERROR("错误: %s 不是拓扑快照文件\n", filename);
+        close(fd);
+        return ERR_INVALID_CONFIG;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    uint8_t* base = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("错误: 无法映射文件 %s\n", filename);
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    if (validate_snapshot(base, file_size, filename) != 0) {
+        munmap(base, file_size);
+        return ERR_INVALID_CONFIG;
+    }
+
+    const topo_snapshot_header_t* header = (const topo_snapshot_header_t*)base;
+    const size_t expected[SECTION_COUNT] = {
+        sizeof(switch_config_t) * header->switch_count,
+        sizeof(network_connection_t) * header->connection_count,
+        sizeof(uint32_t) * header->switch_count,
+        sizeof(uint32_t) * header->switch_count,
+        sizeof(uint32_t) * header->connection_count,
+        sizeof(uint32_t) * header->host_count,
+        sizeof(uint64_t) * ((size_t)header->hash_mask[0] + 1),
+        sizeof(uint32_t) * ((size_t)header->hash_mask[0] + 1),
+        sizeof(uint64_t) * ((size_t)header->hash_mask[1] + 1),
+        sizeof(uint32_t) * ((size_t)header->hash_mask[1] + 1),
+        sizeof(uint64_t) * ((size_t)header->hash_mask[2] + 1),
+        sizeof(uint32_t) * ((size_t)header->hash_mask[2] + 1),
+        sizeof(uint64_t) * ((size_t)header->hash_mask[3] + 1),
+        sizeof(uint32_t) * ((size_t)header->hash_mask[3] + 1),
+    };
+    void* section[SECTION_COUNT];
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (header->sections[s].size != expected[s]) {
+            LOG_ERROR("错误: %s 数据段 %d 大小不符\n", filename, s);
+            munmap(base, file_size);
+            return ERR_INVALID_CONFIG;
+        }
+        section[s] = base + header->sections[s].offset;
+    }
+
+    // 映射区只读，拓扑结构体的指针直接指向各数据段
+    topology_index_t* index = &config->index;
+    topo_hash_t* hashes[4] = {
+        &index->switch_by_id, &index->switch_by_ip, &index->host_by_ip, &index->downlink
+    };
+
+    config->switch_count = config->switch_capacity = header->switch_count;
+    config->connection_count = config->connection_capacity = header->connection_count;
+    config->switches = section[SECTION_SWITCHES];
+    config->connections = section[SECTION_CONNECTIONS];
+    index->root = header->root;
+    index->uplink = section[SECTION_UPLINK];
+    index->parent = section[SECTION_PARENT];
+    index->owner = section[SECTION_OWNER];
+    index->hosts = section[SECTION_HOSTS];
+    index->host_count = header->host_count;
+    for (int h = 0; h < 4; h++) {
+        hashes[h]->keys = section[SECTION_SWITCH_BY_ID_KEYS + h * 2];
+        hashes[h]->values = section[SECTION_SWITCH_BY_ID_VALUES + h * 2];
+        hashes[h]->mask = header->hash_mask[h];
+    }
+    config->mapping = base;
+    config->mapping_size = file_size;
+
+    // 每个交换机的连接区间必须落在连接数组内，否则后续遍历会越界
+    for (uint32_t i = 0; i < config->switch_count; i++) {
+        const switch_config_t* sw = &config->switches[i];
+        if (sw->connection_offset > config->connection_count ||
+            sw->connection_count > config->connection_count - sw->connection_offset) {
+            LOG_ERROR("错误: %s 交换机 %u 的连接区间无效\n", filename, sw->id);
+            cleanup_topology(config);
+            return ERR_INVALID_CONFIG;
+        }
+    }
+
+    // 索引数组中的下标同样直接用于访问交换机/连接数组，CRC一致的文件也可能含越界下标
+    bool indices_valid =
+        indices_in_range(index->uplink, config->switch_count, config->connection_count, true) &&
+        indices_in_range(index->parent, config->switch_count, config->switch_count, true) &&
+        indices_in_range(index->owner, config->connection_count, config->switch_count, false);
+    for (int h = 0; h < 4 && indices_valid; h++) {
+        // 交换机ID/IP索引的值为交换机下标，其余两个为连接引用
+        uint32_t limit = h < 2 ? config->switch_count : config->connection_count;
+        indices_valid = indices_in_range(hashes[h]->values, (size_t)hashes[h]->mask + 1, limit, true);
+    }
+    if (!indices_valid) {
+        LOG_ERROR("错误: %s 索引中的下标越界\n", filename);
+        cleanup_topology(config);
+        return ERR_INVALID_CONFIG;
+    }
+
+    index->ready = true;
+    return SUCCESS;
+}
@@ -1,431 +1,861 @@
+#define _POSIX_C_SOURCE 200809L
 #include "yaml2fpga.h"
 #include <time.h>
+#include <pthread.h>
 
 // ============ 辅助函数声明 ============
-static uint32_t ip_str_to_uint32(const char* ip_str);
-static void mac_str_to_bytes(const char* mac_str, uint8_t* mac_bytes);
-static network_connection_t* find_uplink_connection(const topology_config_t* config, uint32_t switch_id);
-static network_connection_t* find_host_connection(const topology_config_t* config, uint32_t switch_id, uint32_t host_ip);
-static uint32_t find_host_attached_switch(const topology_config_t* config, uint32_t host_ip);
-static bool is_root_switch(const topology_config_t* config, uint32_t switch_id);
-static uint32_t find_subtree_switch(const topology_config_t* config, uint32_t root_id, uint32_t target_switch_id);
-static network_connection_t* find_downlink_to_switch(const topology_config_t* config, uint32_t from_switch, uint32_t to_switch);
-static int collect_all_hosts(const topology_config_t* config, uint32_t** host_ips, uint32_t* host_count);
-
-// ============ IP和MAC转换函数 ============
-static uint32_t ip_str_to_uint32(const char* ip_str) {
-    uint32_t a, b, c, d;
-    if (sscanf(ip_str, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) {
-        fprintf(stderr, "错误: 无效的IP地址格式: %s\n", ip_str);
-        return 0;
-    }
-    return (a << 24) | (b << 16) | (c << 8) | d;
-}
+static void mac_to_entry_bytes(const uint8_t* mac, uint8_t* mac_bytes);
+static void fill_action_from_connection(route_action_t* action, const network_connection_t* conn);
+static const network_connection_t* conn_from_ref(const topology_config_t* config, uint32_t ref);
 
-static void mac_str_to_bytes(const char* mac_str, uint8_t* mac_bytes) {
-    unsigned int m[6];
-    if (sscanf(mac_str, "%x:%x:%x:%x:%x:%x",
-               &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != 6) {
-        fprintf(stderr, "错误: 无效的MAC地址格式: %s\n", mac_str);
-        memset(mac_bytes, 0, 6);
-        return;
-    }
-    // 反向存储以适应Verilog的48位读取（小端序）
-    // 例如 "52:54:00:c2:11:88" 存储为 [88,11,c2,00,54,52]
-    // 这样在Verilog中读取48位时会得到正确的 0x525400c21188
+// ============ 条目填充函数 ============
+
+// 反向存储以适应Verilog的48位读取（小端序）
+// 例如 52:54:00:c2:11:88 存储为 [88,11,c2,00,54,52]
+// 这样在Verilog中读取48位时会得到正确的 0x525400c21188
+static void mac_to_entry_bytes(const uint8_t* mac, uint8_t* mac_bytes) {
     for (int i = 0; i < 6; i++) {
-        mac_bytes[5 - i] = (uint8_t)m[i];
+        mac_bytes[5 - i] = mac[i];
     }
 }
 
-// ============ 拓扑查询辅助函数 ============
+// 用连接的本端/对端信息填充转发动作
+static void fill_action_from_connection(route_action_t* action, const network_connection_t* conn) {
+    action->out_port = conn->my_port;
+    action->out_qp = conn->my_qp;
+    action->next_hop_ip = conn->peer_ip;
+    action->next_hop_port = conn->peer_port;
+    action->next_hop_qp = conn->peer_qp;
+    mac_to_entry_bytes(conn->peer_mac, action->next_hop_mac);
+}
 
-// 查找交换机的上行连接（连接到父交换机）
-static network_connection_t* find_uplink_connection(const topology_config_t* config, uint32_t switch_id) {
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].id == switch_id) {
-            for (uint32_t j = 0; j < config->switches[i].connection_count; j++) {
-                if (config->switches[i].connections[j].up == CONN_UP) {
-                    return &config->switches[i].connections[j];
-                }
-            }
-        }
+// 将索引中的连接引用还原为连接指针
+static const network_connection_t* conn_from_ref(const topology_config_t* config, uint32_t ref) {
+    if (ref == TOPO_INDEX_NONE) {
+        return NULL;
     }
-    return NULL;
+    return &config->connections[ref];
 }
 
-// 查找交换机到某个Host的直连连接
-static network_connection_t* find_host_connection(const topology_config_t* config,
-                                                   uint32_t switch_id, uint32_t host_ip) {
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].id == switch_id) {
-            for (uint32_t j = 0; j < config->switches[i].connection_count; j++) {
-                network_connection_t* conn = &config->switches[i].connections[j];
-                if (ip_str_to_uint32(conn->peer_ip) == host_ip && conn->up == CONN_DOWN) {
-                    return conn;
+// ============ 全拓扑路由规划（所有交换机共享的只读状态）============
+
+// 从根出发一次遍历，计算每个Host的归属交换机、每个交换机的直连Host列表、
+// 每个交换机所在的根子树以及DFS进出区间；之后各交换机的路由表都由该状态直接生成
+int routing_plan_build(const topology_config_t* config, routing_plan_t* plan) {
+    const topology_index_t* index = &config->index;
+    uint32_t switch_count = config->switch_count;
+    uint32_t host_count = index->host_count;
+
+    memset(plan, 0, sizeof(routing_plan_t));
+
+    if (!index->ready) {
+        LOG_ERROR("错误: 拓扑索引未构建\n");
+        return -1;
+    }
+
+    plan->config = config;
+    plan->root = index->root;
+    plan->host_count = host_count;
+    plan->host_ips = index->hosts;
+    plan->host_conn = malloc(sizeof(uint32_t) * (host_count + 1));
+    plan->switch_host_start = calloc(switch_count + 1, sizeof(uint32_t));
+    plan->switch_hosts = malloc(sizeof(uint32_t) * (host_count + 1));
+    plan->subtree = malloc(sizeof(uint32_t) * (switch_count + 1));
+    plan->child_link = malloc(sizeof(uint32_t) * (switch_count + 1));
+    plan->tin = malloc(sizeof(uint32_t) * (switch_count + 1));
+    plan->tout = malloc(sizeof(uint32_t) * (switch_count + 1));
+    plan->euler = malloc(sizeof(uint32_t) * (switch_count + 1));
+
+    uint32_t* child_start = calloc(switch_count + 2, sizeof(uint32_t));
+    uint32_t* children = malloc(sizeof(uint32_t) * (switch_count + 1));
+    uint32_t* stack = malloc(sizeof(uint32_t) * (switch_count + 1));
+    uint32_t* cursor = malloc(sizeof(uint32_t) * (switch_count + 1));
+
+    if (!plan->host_conn || !plan->switch_host_start || !plan->switch_hosts ||
+        !plan->subtree || !plan->child_link || !plan->tin || !plan->tout || !plan->euler ||
+        !child_start || !children || !stack || !cursor) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(child_start);
+        free(children);
+        free(stack);
+        free(cursor);
+        routing_plan_free(plan);
+        return -1;
+    }
+
+    // 每个Host的直连连接与归属交换机，按交换机分桶（保持Host发现顺序）
+    for (uint32_t h = 0; h < host_count; h++) {
+        plan->host_conn[h] = topo_hash_get(&index->host_by_ip, plan->host_ips[h]);
+        plan->lookups++;
+        plan->switch_host_start[index->owner[plan->host_conn[h]] + 1]++;
+    }
+    for (uint32_t i = 0; i < switch_count; i++) {
+        plan->switch_host_start[i + 1] += plan->switch_host_start[i];
+        cursor[i] = plan->switch_host_start[i];
+    }
+    for (uint32_t h = 0; h < host_count; h++) {
+        uint32_t owner = index->owner[plan->host_conn[h]];
+        plan->switch_hosts[cursor[owner]++] = h;
+    }
+
+    // 由父指针建立子节点列表
+    for (uint32_t i = 0; i < switch_count; i++) {
+        if (index->parent[i] != TOPO_INDEX_NONE) {
+            child_start[index->parent[i] + 2]++;
+        }
+    }
+    for (uint32_t i = 0; i < switch_count; i++) {
+        child_start[i + 2] += child_start[i + 1];
+    }
+    for (uint32_t i = 0; i < switch_count; i++) {
+        if (index->parent[i] != TOPO_INDEX_NONE) {
+            children[child_start[index->parent[i] + 1]++] = i;
+        }
+    }
+
+    // 从根出发做一次DFS：记录每个交换机的进入序号 tin 和离开时的序号 tout，
+    // 子树内的交换机在欧拉序中连续，子树判断变为区间比较；
+    // 根的每个直接子节点为一棵根子树，根不可达的交换机保持为自身
+    for (uint32_t i = 0; i < switch_count; i++) {
+        plan->subtree[i] = i;
+        plan->child_link[i] = TOPO_INDEX_NONE;
+        plan->tin[i] = TOPO_INDEX_NONE;
+        plan->tout[i] = TOPO_INDEX_NONE;
+    }
+
+    if (plan->root != TOPO_INDEX_NONE) {
+        uint32_t top = 0;
+        uint32_t order = 0;
+
+        plan->tin[plan->root] = order;
+        plan->euler[order++] = plan->root;
+        cursor[plan->root] = child_start[plan->root];
+        stack[top++] = plan->root;
+        while (top > 0) {
+            uint32_t sw = stack[top - 1];
+            if (cursor[sw] < child_start[sw + 1]) {
+                uint32_t child = children[cursor[sw]++];
+                if (plan->tin[child] != TOPO_INDEX_NONE) {
+                    continue;  // 父指针成环时不重复访问
                 }
+                plan->tin[child] = order;
+                plan->euler[order++] = child;
+                plan->subtree[child] = (sw == plan->root) ? child : plan->subtree[sw];
+                cursor[child] = child_start[child];
+                stack[top++] = child;
+            } else {
+                plan->tout[sw] = order;
+                top--;
             }
         }
-    }
-    return NULL;
-}
 
-// 查找Host连接到哪个交换机
-static uint32_t find_host_attached_switch(const topology_config_t* config, uint32_t host_ip) {
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        for (uint32_t j = 0; j < config->switches[i].connection_count; j++) {
-            network_connection_t* conn = &config->switches[i].connections[j];
-            if (ip_str_to_uint32(conn->peer_ip) == host_ip && conn->up == CONN_DOWN) {
-                return config->switches[i].id;
+        // 父交换机到每个子交换机的下行连接：由子交换机上行链路的本端IP定位，
+        // 不依赖 connections[0] 的顺序
+        for (uint32_t i = 0; i < switch_count; i++) {
+            if (plan->tin[i] != TOPO_INDEX_NONE && index->parent[i] != TOPO_INDEX_NONE &&
+                index->uplink[i] != TOPO_INDEX_NONE) {
+                const network_connection_t* uplink = &config->connections[index->uplink[i]];
+                plan->child_link[i] = topo_hash_get(&index->downlink,
+                                                    ((uint64_t)index->parent[i] << 32) | uplink->my_ip);
+                plan->lookups++;
             }
         }
     }
-    return 0;  // 未找到
+
+    free(child_start);
+    free(children);
+    free(stack);
+    free(cursor);
+    return 0;
 }
 
-// 判断是否为根交换机
-static bool is_root_switch(const topology_config_t* config, uint32_t switch_id) {
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].id == switch_id) {
-            return config->switches[i].is_root;
-        }
+void routing_plan_free(routing_plan_t* plan) {
+    if (!plan) {
+        return;
     }
-    return false;
+    free(plan->host_conn);
+    free(plan->switch_host_start);
+    free(plan->switch_hosts);
+    free(plan->subtree);
+    free(plan->child_link);
+    free(plan->tin);
+    free(plan->tout);
+    free(plan->euler);
+    memset(plan, 0, sizeof(routing_plan_t));
 }
 
-// 查找目标交换机在根交换机的哪个子树下（用于根交换机路由决策）
-static uint32_t find_subtree_switch(const topology_config_t* config,
-                                      uint32_t root_id, uint32_t target_switch_id) {
-    if (target_switch_id == root_id) {
-        return root_id;
-    }
+// ============ 核心函数：由路由规划为指定交换机生成统一路由表 ============
 
-    // 从目标交换机向上回溯，直到找到根的直接子节点
-    uint32_t current = target_switch_id;
+// 取连接对应的转发动作下标：同一张表内经同一连接转发的条目共用一个动作
+// ref 为 TOPO_INDEX_NONE 时对应全0动作（找不到下一跳的条目）
+static uint32_t table_action(const topology_config_t* config, route_builder_t* builder,
+                             switch_table_t* table, uint32_t ref) {
+    uint32_t key = ref == TOPO_INDEX_NONE ? config->connection_count : ref;
 
-    while (current != 0) {
-        // 查找current的父交换机
-        network_connection_t* uplink = find_uplink_connection(config, current);
-        if (!uplink) {
-            break;  // 已经到达根
+    if (builder->conn_stamp[key] != builder->stamp) {
+        route_action_t* action = &table->actions[table->action_count];
+        memset(action, 0, sizeof(route_action_t));
+        if (ref != TOPO_INDEX_NONE) {
+            fill_action_from_connection(action, &config->connections[ref]);
         }
+        builder->conn_stamp[key] = builder->stamp;
+        builder->conn_action[key] = table->action_count++;
+    }
+    return builder->conn_action[key];
+}
 
-        // 解析父交换机的IP找到其ID
-        uint32_t parent_ip = ip_str_to_uint32(uplink->peer_ip);
-        uint32_t parent_id = 0;
-        for (uint32_t i = 0; i < config->switch_count; i++) {
-            if (ip_str_to_uint32(config->switches[i].connections[0].my_ip) == parent_ip) {
-                parent_id = config->switches[i].id;
-                break;
-            }
-        }
+// 追加一条有效条目，返回其转发动作
+static const route_action_t* table_append(switch_table_t* table, uint32_t dst_ip,
+                                          uint8_t flags, uint32_t action_id) {
+    uint32_t i = table->entry_count++;
+    table->dst_ip[i] = dst_ip;
+    table->flags[i] = ROUTE_FLAG_VALID | flags;
+    table->wildcard[i] = 0;
+    table->action_id[i] = action_id;
+    return &table->actions[action_id];
+}
 
-        if (parent_id == root_id) {
-            return current;  // current是根的直接子节点
-        }
+// 只读访问 plan，可在多个线程中并发调用；表的各列分配在 builder->arena 中
+// 过程日志写入 log（日志关闭时可为NULL）
+int routing_plan_emit_table(const routing_plan_t* plan,
+                            uint32_t switch_id,
+                            route_builder_t* builder,
+                            switch_table_t* table,
+                            FILE* log) {
+    const topology_config_t* config = plan->config;
+    uint32_t sw_idx = topo_hash_get(&config->index.switch_by_id, switch_id);
+    bool is_root = sw_idx != TOPO_INDEX_NONE && config->switches[sw_idx].is_root;
 
-        current = parent_id;
-    }
+    memset(table, 0, sizeof(switch_table_t));
+    table->switch_id = switch_id;
+    table->lookups = 1;
+    builder->stamp++;
 
-    return target_switch_id;  // 默认返回自己
-}
+    uint32_t direct_count = 0;
+    uint32_t subtree_count = 0;
+    uint32_t capacity = 0;
+
+    LOG_TO(log, LOG_LEVEL_VERBOSE, "\n构建Switch %u的统一路由表...\n", switch_id);
 
-// 查找从一个交换机到另一个交换机的下行连接
-static network_connection_t* find_downlink_to_switch(const topology_config_t* config,
-                                                       uint32_t from_switch, uint32_t to_switch) {
-    // 先获取目标交换机的IP地址
-    uint32_t to_switch_ip = 0;
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].id == to_switch) {
-            to_switch_ip = ip_str_to_uint32(config->switches[i].connections[0].my_ip);
-            break;
+    if (is_root) {
+        // ========== 根交换机：完整路由表 ==========
+        LOG_TO(log, LOG_LEVEL_VERBOSE, "  类型: 根交换机 - 生成完整路由表\n");
+        LOG_TO(log, LOG_LEVEL_VERBOSE, "收集到 %u 个Host\n", plan->host_count);
+
+        // 分配路由表内存（动作数不会超过条目数）
+        capacity = plan->host_count;
+        if (route_table_alloc(table, &builder->arena, capacity, capacity) != 0) {
+            return -1;
         }
-    }
 
-    if (to_switch_ip == 0) {
-        return NULL;
-    }
+        // 为每个Host生成路由条目
+        for (uint32_t h = 0; h < plan->host_count; h++) {
+            uint32_t host_ip = plan->host_ips[h];
+            uint32_t host_switch = config->index.owner[plan->host_conn[h]];
+            table->lookups++;
+
+            if (host_switch == sw_idx) {
+                // 情况1：直连Host
+                const network_connection_t* conn = conn_from_ref(config, plan->host_conn[h]);
+                const route_action_t* action = table_append(table, host_ip, ROUTE_FLAG_DIRECT,
+                    table_action(config, builder, table, plan->host_conn[h]));
+                direct_count++;
+
+                LOG_TO(log, LOG_LEVEL_VERBOSE, "  [Entry %u] 直连Host: " IP_FMT " -> port=%u, QP=%u\n",
+                       table->entry_count - 1, IP_ARGS(conn->peer_ip), action->out_port, action->out_qp);
+
+            } else {
+                // 情况2：需要路由到子树
+                uint32_t subtree = plan->subtree[host_switch];
+                uint32_t ref = plan->child_link[subtree];
+                const network_connection_t* conn = conn_from_ref(config, ref);
+                const route_action_t* action = table_append(table, host_ip, 0,
+                    table_action(config, builder, table, ref));
+                table->lookups += 2;
+
+                if (conn) {
+                    subtree_count++;
 
-    // 在from_switch的连接中查找peer_ip等于to_switch_ip的下行连接
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        if (config->switches[i].id == from_switch) {
-            for (uint32_t j = 0; j < config->switches[i].connection_count; j++) {
-                network_connection_t* conn = &config->switches[i].connections[j];
-                if (conn->up == CONN_DOWN &&
-                    ip_str_to_uint32(conn->peer_ip) == to_switch_ip) {
-                    return conn;
+                    LOG_TO(log, LOG_LEVEL_VERBOSE, "  [Entry %u] 路由到子树Switch %u: host_ip=%08x -> next_hop=" IP_FMT ", port=%u, QP=%u\n",
+                           table->entry_count - 1, config->switches[subtree].id, host_ip,
+                           IP_ARGS(conn->peer_ip), action->out_port, action->out_qp);
                 }
             }
         }
-    }
 
-    return NULL;
-}
+    } else {
+        // ========== 非根交换机：直连主机 + 子树内主机（向下）+ 默认路由 ==========
+        LOG_TO(log, LOG_LEVEL_VERBOSE, "  类型: 非根交换机 - 生成直连主机表 + 子树路由 + 默认路由\n");
+        LOG_TO(log, LOG_LEVEL_VERBOSE, "收集到 %u 个Host\n", plan->host_count);
+
+        uint32_t first = 0;
+        uint32_t last = 0;
+        uint32_t below_first = 0;
+        uint32_t below_last = 0;
+        if (sw_idx != TOPO_INDEX_NONE) {
+            first = plan->switch_host_start[sw_idx];
+            last = plan->switch_host_start[sw_idx + 1];
+            if (plan->tin[sw_idx] != TOPO_INDEX_NONE) {
+                below_first = plan->tin[sw_idx] + 1;
+                below_last = plan->tout[sw_idx];
+            }
+        }
 
-// 收集拓扑中所有Host的IP地址
-static int collect_all_hosts(const topology_config_t* config, uint32_t** host_ips, uint32_t* host_count) {
-    *host_count = 0;
-    *host_ips = malloc(sizeof(uint32_t) * 256);  // 最多256个Host
+        // 子树内（不含自身）的Host数
+        uint32_t below_hosts = 0;
+        for (uint32_t t = below_first; t < below_last; t++) {
+            uint32_t sw = plan->euler[t];
+            below_hosts += plan->switch_host_start[sw + 1] - plan->switch_host_start[sw];
+        }
 
-    if (!*host_ips) {
-        fprintf(stderr, "错误: 内存分配失败\n");
-        return -1;
-    }
+        // 分配内存：直连主机 + 子树主机 + 1条默认路由
+        capacity = last - first + below_hosts + 1;
+        if (route_table_alloc(table, &builder->arena, capacity, capacity) != 0) {
+            return -1;
+        }
 
-    // 遍历所有交换机的下行连接，收集Host IP
-    for (uint32_t i = 0; i < config->switch_count; i++) {
-        for (uint32_t j = 0; j < config->switches[i].connection_count; j++) {
-            network_connection_t* conn = &config->switches[i].connections[j];
-            if (conn->up == CONN_DOWN) {
-                uint32_t ip = ip_str_to_uint32(conn->peer_ip);
-
-                // 检查是否已经添加过（去重）
-                bool exists = false;
-                for (uint32_t k = 0; k < *host_count; k++) {
-                    if ((*host_ips)[k] == ip) {
-                        exists = true;
-                        break;
-                    }
-                }
+        // 添加直连主机条目
+        for (uint32_t k = first; k < last; k++) {
+            uint32_t h = plan->switch_hosts[k];
+            const network_connection_t* conn = conn_from_ref(config, plan->host_conn[h]);
+            const route_action_t* action = table_append(table, plan->host_ips[h], ROUTE_FLAG_DIRECT,
+                table_action(config, builder, table, plan->host_conn[h]));
+            direct_count++;
+
+            LOG_TO(log, LOG_LEVEL_VERBOSE, "  [Entry %u] 直连Host: " IP_FMT " -> port=%u, QP=%u\n",
+                   table->entry_count - 1, IP_ARGS(conn->peer_ip), action->out_port, action->out_qp);
+        }
 
-                if (!exists) {
-                    (*host_ips)[*host_count] = ip;
-                    (*host_count)++;
+        // 添加子树内主机条目（向下转发）：按欧拉序遍历后代交换机，
+        // 每个后代所属的直接子交换机由区间判断得到，子交换机的区间连续排列
+        uint32_t child = TOPO_INDEX_NONE;
+        const network_connection_t* downlink = NULL;
+        uint32_t downlink_action = 0;
+        for (uint32_t t = below_first; t < below_last; t++) {
+            uint32_t sw = plan->euler[t];
+            if (child == TOPO_INDEX_NONE || !routing_plan_in_subtree(plan, sw, child)) {
+                child = sw;
+                downlink = conn_from_ref(config, plan->child_link[child]);
+                table->lookups++;
+                if (!downlink) {
+                    LOG_ERROR("错误: 交换机 %u 没有找到到子交换机 %u 的下行连接\n",
+                              switch_id, config->switches[child].id);
+                    table->entry_count = 0;
+                    return -1;
                 }
+                downlink_action = table_action(config, builder, table, plan->child_link[child]);
+            }
+
+            for (uint32_t k = plan->switch_host_start[sw]; k < plan->switch_host_start[sw + 1]; k++) {
+                uint32_t h = plan->switch_hosts[k];
+                const route_action_t* action = table_append(table, plan->host_ips[h], 0, downlink_action);
+                subtree_count++;
+
+                LOG_TO(log, LOG_LEVEL_VERBOSE, "  [Entry %u] 向下路由到子交换机 %u: host_ip=%08x -> next_hop=" IP_FMT ", port=%u, QP=%u\n",
+                       table->entry_count - 1, config->switches[child].id, plan->host_ips[h],
+                       IP_ARGS(downlink->peer_ip), action->out_port, action->out_qp);
             }
         }
+
+        // 添加默认路由条目（向上转发）
+        uint32_t uplink_ref = TOPO_INDEX_NONE;
+        if (sw_idx != TOPO_INDEX_NONE) {
+            uplink_ref = config->index.uplink[sw_idx];
+            table->lookups++;
+        }
+        const network_connection_t* uplink = conn_from_ref(config, uplink_ref);
+
+        if (uplink) {
+            // 特殊标记：默认路由的 dst_ip 为 0xFFFFFFFF
+            const route_action_t* action = table_append(table, 0xFFFFFFFF, ROUTE_FLAG_DEFAULT,
+                table_action(config, builder, table, uplink_ref));
+
+            LOG_TO(log, LOG_LEVEL_VERBOSE, "  [Entry %u] 默认路由(向上): next_hop=" IP_FMT ", port=%u, QP=%u\n",
+                   table->entry_count - 1, IP_ARGS(uplink->peer_ip), action->out_port, action->out_qp);
+        } else {
+            LOG_ERROR("错误: 非根交换机 %u 没有找到上行连接\n", switch_id);
+            table->entry_count = 0;
+            return -1;
+        }
     }
 
-    printf("收集到 %u 个Host\n", *host_count);
+    // 动作数组是最后一次分配，原地收缩到实际的动作数
+    table->actions = topo_arena_grow(&builder->arena, table->actions,
+                                     sizeof(route_action_t) * (capacity ? capacity : 1),
+                                     sizeof(route_action_t) * table->action_count);
+
+    // 每表一行摘要：类型、条目总数及按转发方式的分类
+    LOG_TO(log, LOG_LEVEL_INFO, "Switch %u: %s, %u条目 (直连%u, 经子树%u, 默认路由%u)\n",
+           switch_id, is_root ? "根" : "非根", table->entry_count,
+           direct_count, subtree_count, table->entry_count - direct_count - subtree_count);
     return 0;
 }
 
-// ============ 核心函数：为指定交换机构建统一路由表（优化版）============
+// 为单个交换机构建路由表（一次性规划，适合只需要少量交换机的调用者）
+// 返回打包好的条目数组，由调用者 free
 int build_unified_routing_table(const topology_config_t* config,
                                  uint32_t switch_id,
                                  fpga_dest_entry_t** dest_table,
                                  uint32_t* entry_count) {
-    printf("\n构建Switch %u的统一路由表...\n", switch_id);
+    routing_plan_t plan;
+    route_builder_t builder;
+    switch_table_t table;
 
-    bool is_root = is_root_switch(config, switch_id);
-
-    if (is_root) {
-        // ========== 根交换机：完整路由表 ==========
-        printf("  类型: 根交换机 - 生成完整路由表\n");
-
-        // 收集所有Host
-        uint32_t* all_host_ips = NULL;
-        uint32_t total_hosts = 0;
-        if (collect_all_hosts(config, &all_host_ips, &total_hosts) != 0) {
-            return -1;
-        }
+    *dest_table = NULL;
+    *entry_count = 0;
+    if (routing_plan_build(config, &plan) != 0) {
+        return -1;
+    }
+    if (route_builder_init(&builder, config) != 0) {
+        routing_plan_free(&plan);
+        return -1;
+    }
 
-        // 分配路由表内存
-        *dest_table = malloc(sizeof(fpga_dest_entry_t) * total_hosts);
-        if (!*dest_table) {
-            fprintf(stderr, "错误: 内存分配失败\n");
-            free(all_host_ips);
-            return -1;
+    int result = routing_plan_emit_table(&plan, switch_id, &builder, &table, stdout);
+    if (result == 0) {
+        *dest_table = malloc(sizeof(fpga_dest_entry_t) * (table.entry_count ? table.entry_count : 1));
+        if (*dest_table) {
+            for (uint32_t i = 0; i < table.entry_count; i++) {
+                route_table_pack(&table, i, &(*dest_table)[i]);
+            }
+            *entry_count = table.entry_count;
+        } else {
+            LOG_ERROR("错误: 内存分配失败\n");
+            result = -1;
         }
-        memset(*dest_table, 0, sizeof(fpga_dest_entry_t) * total_hosts);
-
-        *entry_count = 0;
+    }
+    route_builder_free(&builder);
+    routing_plan_free(&plan);
+    return result;
+}
 
-        // 为每个Host生成路由条目
-        for (uint32_t i = 0; i < total_hosts; i++) {
-            uint32_t host_ip = all_host_ips[i];
-            fpga_dest_entry_t* entry = &(*dest_table)[*entry_count];
+// ============ 并行构建：工作线程池 ============
+
+// 单个交换机的构建结果，日志先缓存在内存流中，由主线程按交换机ID顺序输出
+typedef struct {
+    switch_table_t table;
+    char* log_buf;
+    size_t log_len;
+    int status;
+    bool done;
+} switch_build_result_t;
+
+typedef struct {
+    const routing_plan_t* plan;
+    switch_build_result_t* results;
+    uint32_t task_count;
+    uint32_t next_task;              // 下一个待领取的交换机下标
+    uint32_t consumed;               // 主线程已按序消费的结果数
+    uint32_t window;                 // 领先主线程的最大任务数（限制日志缓存占用）
+    bool abort;
+    error_sink_t* error_sink;        // 调用线程的错误收集器，工作线程沿用
+    pthread_mutex_t lock;
+    pthread_cond_t task_done;        // 有结果完成（唤醒主线程）
+    pthread_cond_t slot_free;        // 主线程消费了结果（唤醒工作线程）
+} build_pool_t;
+
+// 工作线程：各自的表存储arena，构建结束后并入 routing_tables_t
+typedef struct {
+    build_pool_t* pool;
+    route_builder_t builder;
+} build_worker_t;
+
+static void build_one_switch(const routing_plan_t* plan, uint32_t sw_id, route_builder_t* builder,
+                             switch_build_result_t* result) {
+    // 安静模式下不产生任何日志，无需日志缓冲
+    if (!LOG_ENABLED(LOG_LEVEL_INFO)) {
+        result->status = routing_plan_emit_table(plan, sw_id, builder, &result->table, NULL);
+        return;
+    }
 
-            entry->dst_ip = host_ip;
-            entry->valid = 1;
-            entry->is_default_route = 0;
+    FILE* log = open_memstream(&result->log_buf, &result->log_len);
+    if (!log) {
+        result->status = -1;
+        return;
+    }
+    result->status = routing_plan_emit_table(plan, sw_id, builder, &result->table, log);
+    fclose(log);
+}
 
-            uint32_t host_switch_id = find_host_attached_switch(config, host_ip);
+static void* build_worker(void* arg) {
+    build_worker_t* worker = arg;
+    build_pool_t* pool = worker->pool;
 
-            if (host_switch_id == 0) {
-                fprintf(stderr, "警告: Host IP %08x 未找到所属交换机\n", host_ip);
-                continue;
-            }
+    yaml2fpga_error_sink = pool->error_sink;
 
-            if (host_switch_id == switch_id) {
-                // 情况1：直连Host
-                entry->is_direct_host = 1;
-                network_connection_t* conn = find_host_connection(config, switch_id, host_ip);
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->abort && pool->next_task < pool->task_count) {
+        if (pool->next_task >= pool->consumed + pool->window) {
+            pthread_cond_wait(&pool->slot_free, &pool->lock);
+            continue;
+        }
+        uint32_t task = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
 
-                if (conn) {
-                    entry->out_port = conn->my_port;
-                    entry->out_qp = conn->my_qp;
-                    entry->next_hop_ip = ip_str_to_uint32(conn->peer_ip);
-                    entry->next_hop_port = conn->peer_port;
-                    entry->next_hop_qp = conn->peer_qp;
-                    mac_str_to_bytes(conn->peer_mac, entry->next_hop_mac);
-
-                    printf("  [Entry %u] 直连Host: %s -> port=%u, QP=%u\n",
-                           *entry_count, conn->peer_ip, entry->out_port, entry->out_qp);
-                }
+        switch_build_result_t result;
+        memset(&result, 0, sizeof(result));
+        build_one_switch(pool->plan, task + 1, &worker->builder, &result);
 
-            } else {
-                // 情况2：需要路由到子树
-                entry->is_direct_host = 0;
-                uint32_t subtree_switch = find_subtree_switch(config, switch_id, host_switch_id);
-                network_connection_t* conn = find_downlink_to_switch(config, switch_id, subtree_switch);
+        pthread_mutex_lock(&pool->lock);
+        result.done = true;
+        pool->results[task] = result;
+        pthread_cond_broadcast(&pool->task_done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
 
-                if (conn) {
-                    entry->out_port = conn->my_port;
-                    entry->out_qp = conn->my_qp;
-                    entry->next_hop_ip = ip_str_to_uint32(conn->peer_ip);
-                    entry->next_hop_port = conn->peer_port;
-                    entry->next_hop_qp = conn->peer_qp;
-                    mac_str_to_bytes(conn->peer_mac, entry->next_hop_mac);
-
-                    printf("  [Entry %u] 路由到子树Switch %u: host_ip=%08x -> next_hop=%s, port=%u, QP=%u\n",
-                           *entry_count, subtree_switch, host_ip, conn->peer_ip, entry->out_port, entry->out_qp);
-                }
-            }
+// 线程池构建全部交换机的路由表；结果与日志按交换机ID顺序收集
+static int build_tables_parallel(const routing_plan_t* plan, uint32_t jobs, routing_tables_t* tables) {
+    uint32_t switch_count = tables->table_count;
+    build_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.plan = plan;
+    pool.task_count = switch_count;
+    pool.window = jobs * 4;
+    pool.error_sink = yaml2fpga_error_sink;
+    pool.results = calloc(switch_count, sizeof(switch_build_result_t));
+    pthread_t* threads = calloc(jobs, sizeof(pthread_t));
+    build_worker_t* workers = calloc(jobs, sizeof(build_worker_t));
+
+    if (!pool.results || !threads || !workers) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        free(pool.results);
+        free(threads);
+        free(workers);
+        return -1;
+    }
 
-            (*entry_count)++;
+    uint32_t ready = 0;
+    while (ready < jobs && route_builder_init(&workers[ready].builder, plan->config) == 0) {
+        workers[ready].pool = &pool;
+        ready++;
+    }
+    if (ready < jobs) {
+        for (uint32_t t = 0; t < ready; t++) {
+            route_builder_free(&workers[t].builder);
         }
+        free(pool.results);
+        free(threads);
+        free(workers);
+        return -1;
+    }
 
-        free(all_host_ips);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.task_done, NULL);
+    pthread_cond_init(&pool.slot_free, NULL);
 
-    } else {
-        // ========== 非根交换机：直连主机 + 默认路由 ==========
-        printf("  类型: 非根交换机 - 生成直连主机表 + 默认路由\n");
+    uint32_t started = 0;
+    while (started < jobs && pthread_create(&threads[started], NULL, build_worker, &workers[started]) == 0) {
+        started++;
+    }
 
-        // 收集所有Host
-        uint32_t* all_host_ips = NULL;
-        uint32_t total_hosts = 0;
-        if (collect_all_hosts(config, &all_host_ips, &total_hosts) != 0) {
-            return -1;
-        }
+    int status = started > 0 ? 0 : -1;
+    if (status != 0) {
+        LOG_ERROR("错误: 无法创建工作线程\n");
+    }
 
-        // 统计直连主机数量
-        uint32_t direct_host_count = 0;
-        for (uint32_t i = 0; i < total_hosts; i++) {
-            uint32_t host_switch_id = find_host_attached_switch(config, all_host_ips[i]);
-            if (host_switch_id == switch_id) {
-                direct_host_count++;
-            }
+    // 按交换机ID顺序等待结果并输出日志
+    for (uint32_t i = 0; i < switch_count && status == 0; i++) {
+        pthread_mutex_lock(&pool.lock);
+        while (!pool.results[i].done) {
+            pthread_cond_wait(&pool.task_done, &pool.lock);
         }
+        switch_build_result_t result = pool.results[i];
+        memset(&pool.results[i], 0, sizeof(switch_build_result_t));
+        pool.consumed = i + 1;
+        pthread_cond_broadcast(&pool.slot_free);
+        pthread_mutex_unlock(&pool.lock);
+
+        if (result.log_buf) {
+            fwrite(result.log_buf, 1, result.log_len, stdout);
+        }
+        free(result.log_buf);
 
-        // 分配内存：直连主机 + 1条默认路由
-        uint32_t table_size = direct_host_count + 1;
-        *dest_table = malloc(sizeof(fpga_dest_entry_t) * table_size);
-        if (!*dest_table) {
-            fprintf(stderr, "错误: 内存分配失败\n");
-            free(all_host_ips);
-            return -1;
+        if (result.status != 0) {
+            LOG_ERROR("错误: 构建Switch %u路由表失败\n", i + 1);
+            status = -1;
         }
-        memset(*dest_table, 0, sizeof(fpga_dest_entry_t) * table_size);
+        tables->tables[i] = result.table;
+    }
 
-        *entry_count = 0;
+    pthread_mutex_lock(&pool.lock);
+    pool.abort = true;
+    pthread_cond_broadcast(&pool.slot_free);
+    pthread_mutex_unlock(&pool.lock);
 
-        // 添加直连主机条目
-        for (uint32_t i = 0; i < total_hosts; i++) {
-            uint32_t host_ip = all_host_ips[i];
-            uint32_t host_switch_id = find_host_attached_switch(config, host_ip);
+    for (uint32_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
 
-            if (host_switch_id == switch_id) {
-                fpga_dest_entry_t* entry = &(*dest_table)[*entry_count];
+    // 出错提前结束时释放尚未消费的日志；各线程arena中的表存储统一移交给 tables
+    for (uint32_t i = 0; i < switch_count; i++) {
+        free(pool.results[i].log_buf);
+    }
+    for (uint32_t t = 0; t < jobs; t++) {
+        topo_arena_merge(&tables->arena, &workers[t].builder.arena);
+        route_builder_free(&workers[t].builder);
+    }
 
-                entry->dst_ip = host_ip;
-                entry->valid = 1;
-                entry->is_direct_host = 1;
-                entry->is_default_route = 0;
+    pthread_cond_destroy(&pool.slot_free);
+    pthread_cond_destroy(&pool.task_done);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.results);
+    free(threads);
+    free(workers);
+    return status;
+}
 
-                network_connection_t* conn = find_host_connection(config, switch_id, host_ip);
-                if (conn) {
-                    entry->out_port = conn->my_port;
-                    entry->out_qp = conn->my_qp;
-                    entry->next_hop_ip = ip_str_to_uint32(conn->peer_ip);
-                    entry->next_hop_port = conn->peer_port;
-                    entry->next_hop_qp = conn->peer_qp;
-                    mac_str_to_bytes(conn->peer_mac, entry->next_hop_mac);
-
-                    printf("  [Entry %u] 直连Host: %s -> port=%u, QP=%u\n",
-                           *entry_count, conn->peer_ip, entry->out_port, entry->out_qp);
-                }
+// ============ 构建全部交换机的路由表 ============
+// jobs > 1 时各交换机路由表在线程池中并行构建，结果与日志仍按交换机ID顺序收集，
+// 与单线程运行逐字节一致
+int build_all_routing_tables(const topology_config_t* config,
+                             const generate_options_t* options,
+                             routing_tables_t* tables) {
+    uint32_t jobs = (options && options->jobs > 1) ? options->jobs : 1;
+    uint32_t switch_count = config->switch_count;
+    int status = 0;
 
-                (*entry_count)++;
-            }
-        }
+    memset(tables, 0, sizeof(routing_tables_t));
 
-        // 添加默认路由条目（向上转发）
-        fpga_dest_entry_t* default_entry = &(*dest_table)[*entry_count];
-        default_entry->dst_ip = 0xFFFFFFFF;  // 特殊标记：默认路由
-        default_entry->valid = 1;
-        default_entry->is_direct_host = 0;
-        default_entry->is_default_route = 1;
+    routing_plan_t plan;
+    if (routing_plan_build(config, &plan) != 0) {
+        return -1;
+    }
 
-        network_connection_t* uplink = find_uplink_connection(config, switch_id);
-        if (uplink) {
-            default_entry->out_port = uplink->my_port;
-            default_entry->out_qp = uplink->my_qp;
-            default_entry->next_hop_ip = ip_str_to_uint32(uplink->peer_ip);
-            default_entry->next_hop_port = uplink->peer_port;
-            default_entry->next_hop_qp = uplink->peer_qp;
-            mac_str_to_bytes(uplink->peer_mac, default_entry->next_hop_mac);
-
-            printf("  [Entry %u] 默认路由(向上): next_hop=%s, port=%u, QP=%u\n",
-                   *entry_count, uplink->peer_ip, default_entry->out_port, default_entry->out_qp);
-        } else {
-            fprintf(stderr, "错误: 非根交换机 %u 没有找到上行连接\n", switch_id);
-            free(*dest_table);
-            free(all_host_ips);
-            return -1;
+    tables->tables = calloc(switch_count + 1, sizeof(switch_table_t));
+    if (!tables->tables) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        routing_plan_free(&plan);
+        return -1;
+    }
+    tables->table_count = switch_count;
+    tables->plan_lookups = plan.lookups;
+
+    if (jobs > switch_count) {
+        jobs = switch_count ? switch_count : 1;
+    }
+
+    if (jobs == 1) {
+        route_builder_t builder;
+        status = route_builder_init(&builder, config);
+        for (uint32_t sw_id = 1; sw_id <= switch_count && status == 0; sw_id++) {
+            if (routing_plan_emit_table(&plan, sw_id, &builder, &tables->tables[sw_id - 1], stdout) != 0) {
+                LOG_ERROR("错误: 构建Switch %u路由表失败\n", sw_id);
+                status = -1;
+            }
         }
+        topo_arena_merge(&tables->arena, &builder.arena);
+        route_builder_free(&builder);
+    } else {
+        status = build_tables_parallel(&plan, jobs, tables);
+    }
 
-        (*entry_count)++;
-        free(all_host_ips);
+    routing_plan_free(&plan);
+    if (status != 0) {
+        free_routing_tables(tables);
     }
+    return status;
+}
 
-    printf("Switch %u 路由表构建完成，共 %u 条目\n", switch_id, *entry_count);
-    return 0;
+void free_routing_tables(routing_tables_t* tables) {
+    if (!tables) {
+        return;
+    }
+    free(tables->tables);
+    topo_arena_free(&tables->arena);
+    memset(tables, 0, sizeof(routing_tables_t));
 }
 
 // ============ 生成二进制文件（包含所有交换机的路由表）============
+// 先在内存中构建全部路由表，按最终大小一次性序列化到单个缓冲区，
+// 再写入临时文件、fsync 后原子替换目标文件，磁盘上不会出现写了一半的镜像
+// options->format 非 bin 时输出对应的ROM初始化文本（hex/coe/mif）
 int generate_unified_routing_binary(const topology_config_t* config,
-                                     const char* output_filename) {
-    FILE* fp = fopen(output_filename, "wb");
-    if (!fp) {
-        fprintf(stderr, "错误: 无法创建文件 %s\n", output_filename);
+                                     const char* output_filename,
+                                     const generate_options_t* options) {
+    uint32_t image_version = (options && options->image_version) ? options->image_version : 1;
+    run_stats_t* stats = options ? options->stats : NULL;
+
+    if (image_version != 1 && image_version != FPGA_IMAGE_VERSION) {
+        LOG_ERROR("错误: 不支持的镜像版本 %u\n", image_version);
+        return -1;
+    }
+
+    LOG_INFO("\n开始生成统一路由表二进制文件...\n");
+
+    double t_route = stats_now_ms();
+    routing_tables_t tables;
+    if (build_all_routing_tables(config, options, &tables) != 0) {
+        return -1;
+    }
+    if (stats) {
+        stats->route_ms = stats_now_ms() - t_route;
+    }
+
+    int result = write_routing_tables(&tables, output_filename, options);
+    free_routing_tables(&tables);
+    return result;
+}
+
+// ============ 增量更新流 ============
+// 读取上一版镜像，把新路由表按旧槽位排布，并生成两者的差异
+static int build_delta_stream(routing_tables_t* tables, const generate_options_t* options,
+                              uint8_t** delta, size_t* delta_size) {
+    uint8_t* prev = NULL;
+    size_t prev_size = 0;
+    routing_tables_t old_tables = {0};
+    uint32_t prev_version = 0;
+
+    if (read_file_all(options->prev_image, &prev, &prev_size) != 0) {
+        return -1;
+    }
+    if (parse_routing_image(prev, prev_size, &old_tables, &prev_version) != 0) {
+        LOG_ERROR("错误: 无法解析上一版镜像 %s\n", options->prev_image);
+        free(prev);
         return -1;
     }
+    free(prev);
 
-    printf("\n开始生成统一路由表二进制文件...\n");
+    LOG_INFO("\n增量更新流 (相对 %s):\n", options->prev_image);
+    int result = build_routing_delta(&old_tables, tables, delta, delta_size);
+    free_routing_tables(&old_tables);
+    return result;
+}
+
+// 把增量更新流写入 delta_file，输出格式与主镜像一致（bin 或文本ROM）
+static int write_delta_file(const uint8_t* delta, size_t delta_size, const generate_options_t* options) {
+    const fpga_delta_header_t* header = (const fpga_delta_header_t*)delta;
+    char* text = NULL;
+    size_t text_len = 0;
+    int result = 0;
+
+    if (options->format != IMAGE_FORMAT_BIN) {
+        result = format_image_text(delta, delta_size, options->format, &text, &text_len);
+    }
+    if (result == 0) {
+        result = text ? write_file_atomic(options->delta_file, text, text_len)
+                      : write_file_atomic(options->delta_file, delta, delta_size);
+    }
+    if (result == 0) {
+        LOG_INFO("增量更新流生成完成: %s (%u个交换机, %zu字节)\n", options->delta_file,
+                 header->switch_count, text ? text_len : delta_size);
+    }
+    free(text);
+    return result;
+}
 
-    // 为每个交换机生成并写入路由表
-    for (uint32_t sw_id = 1; sw_id <= config->switch_count; sw_id++) {
-        fpga_dest_entry_t* dest_table = NULL;
-        uint32_t entry_count = 0;
+// ============ 输出已构建的路由表 ============
+// 按 options 的镜像版本和输出格式序列化并原子写入文件（完整生成与增量更新共用）
+// 指定 compress、hash_buckets、slot_map 或 delta_file 时路由表会先被聚合或重新排布，因此 tables 会被修改
+int write_routing_tables(routing_tables_t* tables,
+                         const char* output_filename,
+                         const generate_options_t* options) {
+    uint32_t image_version = (options && options->image_version) ? options->image_version : 1;
+    run_stats_t* stats = options ? options->stats : NULL;
+    double t_serialize = stats_now_ms();
+
+    if (options && options->compress && compress_routing_tables(tables) != 0) {
+        return -1;
+    }
 
-        // 构建路由表
-        if (build_unified_routing_table(config, sw_id, &dest_table, &entry_count) != 0) {
-            fprintf(stderr, "错误: 构建Switch %u路由表失败\n", sw_id);
-            fclose(fp);
+    // 哈希查找表：条目按桶号排布（不与聚合、槽位映射和增量流同时使用）
+    if (options && options->hash_buckets &&
+        (place_hash_tables(tables, options->hash_buckets) != 0 ||
+         check_hash_capacity(options->hash_buckets, options->bram_kb) != 0)) {
+        return -1;
+    }
+
+    // 先按持久化的槽位映射排布，再（若指定）相对上一版镜像排布并输出增量流
+    if (options && options->slot_map) {
+        routing_tables_t slot_map;
+        if (load_slot_map(options->slot_map, &slot_map) != 0) {
+            return -1;
+        }
+        int placed = place_routing_tables(&slot_map, tables);
+        free_routing_tables(&slot_map);
+        if (placed != 0) {
             return -1;
         }
+    }
+    uint8_t* delta = NULL;
+    size_t delta_size = 0;
+    if (options && options->delta_file && build_delta_stream(tables, options, &delta, &delta_size) != 0) {
+        return -1;
+    }
 
-        // 写入表头
-        fpga_dest_table_header_t header;
-        header.magic = 0x44455354;  // "DEST"
-        header.entry_count = entry_count;
-        header.switch_id = sw_id;
-        header.reserved = 0;
+    // 容量检查放在排布之后（空洞也占地址），溢出时镜像和增量流都不写出
+    if (options && options->max_entries &&
+        check_table_capacity(tables, options->max_entries, options->bram_kb) != 0) {
+        free(delta);
+        return -1;
+    }
+    if (delta) {
+        int written = write_delta_file(delta, delta_size, options);
+        free(delta);
+        if (written != 0) {
+            return -1;
+        }
+    }
 
-        fwrite(&header, sizeof(fpga_dest_table_header_t), 1, fp);
+    // 各表计数由构建线程独立累计，这里在单线程中汇总
+    if (stats) {
+        stats->tables = tables->table_count;
+        stats->lookups = tables->plan_lookups;
+        stats->entries = 0;
+        for (uint32_t i = 0; i < tables->table_count; i++) {
+            stats->lookups += tables->tables[i].lookups;
+            stats->entries += tables->tables[i].entry_count;
+        }
+    }
 
-        // 写入表条目
-        fwrite(dest_table, sizeof(fpga_dest_entry_t), entry_count, fp);
+    size_t image_size = routing_image_size(tables, image_version);
+    uint8_t* image = malloc(image_size ? image_size : 1);
+    if (!image) {
+        LOG_ERROR("错误: 内存分配失败 (%zu字节)\n", image_size);
+        return -1;
+    }
+
+    serialize_routing_image(tables, image_version, image, image_size);
 
-        printf("已写入Switch %u的路由表: %u条目, %zu字节\n",
-               sw_id, entry_count, sizeof(header) + entry_count * sizeof(fpga_dest_entry_t));
+    // 文本格式直接由内存镜像生成，不再经过中间 .bin 文件
+    char* text = NULL;
+    size_t text_len = 0;
+    int result = 0;
+    if (options && options->format != IMAGE_FORMAT_BIN) {
+        result = format_image_text(image, image_size, options->format, &text, &text_len);
+    }
+    double t_write = stats_now_ms();
 
-        free(dest_table);
+    if (result == 0) {
+        if (text) {
+            result = write_file_atomic(output_filename, text, text_len);
+        } else {
+            result = write_file_atomic(output_filename, image, image_size);
+            text_len = image_size;
+        }
+    }
+    free(text);
+    free(image);
+    if (result != 0) {
+        return -1;
     }
 
-    fclose(fp);
-    printf("\n统一路由表二进制文件生成完成: %s\n", output_filename);
+    if (stats) {
+        stats->serialize_ms = t_write - t_serialize;
+        stats->write_ms = stats_now_ms() - t_write;
+        stats->bytes_written = text_len;
+    }
+
+    LOG_INFO("\n统一路由表二进制文件生成完成: %s (%zu字节)\n", output_filename, text_len);
+
+    // 镜像写入成功后才更新槽位映射，保证映射与最新镜像一致
+    if (options && options->slot_map) {
+        if (save_slot_map(options->slot_map, tables) != 0) {
+            return -1;
+        }
+        LOG_INFO("槽位映射已更新: %s\n", options->slot_map);
+    }
     return 0;
 }
 
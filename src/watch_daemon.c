@@ -0,0 +1,386 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include <errno.h>
+#include <libgen.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// ============ 常驻模式（--watch）============
+// 拓扑和已发布的路由表常驻内存。inotify 监视YAML文件所在目录（编辑器常以改名方式
+// 替换文件），文件变化后等待 debounce_ms 内不再有新变化才重新生成：新拓扑与内存中的
+// 旧拓扑比较，只重建受影响的交换机（结构变化时完整重建），再原子替换输出镜像。
+// 新拓扑解析、构建或写出失败时保留旧状态，继续提供查询。
+//
+// 查询通过 Unix 域套接字（SOCK_STREAM），每个连接一条文本请求，应答后关闭：
+//   "STATUS\n"     -> "OK generation=<n> switches=<n> entries=<n>\n"
+//   "TABLE <id>\n" -> "OK <switch_id> <entry_count> <字节数>\n" + 打包好的32字节条目
+//   出错时          -> "ERR <原因>\n"
+// 应答的总是当前已发布镜像中的路由表。
+// 请求和应答都在事件循环中处理，客户端须在 WATCH_CLIENT_TIMEOUT_MS 内发完请求、读完应答，否则被断开。
+
+#define WATCH_REQUEST_MAX 128
+#define WATCH_CLIENT_TIMEOUT_MS 1000
+
+typedef struct {
+    const char* yaml_file;
+    const char* yaml_name;           // YAML文件名（不含目录），用于过滤目录事件
+    const char* output_file;
+    const generate_options_t* options;
+    topology_config_t config;        // 当前已发布的拓扑
+    routing_tables_t tables;         // 当前已发布的路由表
+    bool loaded;
+    uint32_t generation;             // 成功发布的次数
+} watch_state_t;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void watch_signal(int sig) {
+    (void)sig;
+    watch_stop = 1;
+}
+
+// 解析并校验YAML拓扑、建立索引
+static int load_yaml(const char* path, topology_config_t* config) {
+    int result = parse_yaml_topology(path, config);
+    if (result != SUCCESS) {
+        LOG_ERROR("错误: YAML解析失败 (错误码: %d)\n", result);
+        return -1;
+    }
+    if (validate_topology(config) != SUCCESS || build_topology_index(config) != 0) {
+        cleanup_topology(config);
+        return -1;
+    }
+    return 0;
+}
+
+// 重新生成：成功发布后替换常驻状态，失败时保留旧状态
+static int watch_regenerate(watch_state_t* state) {
+    double t_start = stats_now_ms();
+    topology_config_t config;
+    routing_tables_t tables;
+    int status;
+
+    if (load_yaml(state->yaml_file, &config) != 0) {
+        LOG_ERROR("错误: 拓扑 %s 无效，继续使用上一版 (第%u版)\n", state->yaml_file, state->generation);
+        return -1;
+    }
+
+    status = state->loaded ? rebuild_routing_tables(&state->config, &config, &state->tables, &tables) : 1;
+    if (status == 1) {
+        status = build_all_routing_tables(&config, state->options, &tables);
+    }
+    if (status == 0) {
+        status = write_routing_tables(&tables, state->output_file, state->options);
+        if (status != 0) {
+            free_routing_tables(&tables);
+        }
+    }
+    if (status != 0) {
+        LOG_ERROR("错误: 重新生成失败，继续使用上一版 (第%u版)\n", state->generation);
+        cleanup_topology(&config);
+        return -1;
+    }
+
+    if (state->loaded) {
+        free_routing_tables(&state->tables);
+        cleanup_topology(&state->config);
+    }
+    state->config = config;
+    state->tables = tables;
+    state->loaded = true;
+    state->generation++;
+    LOG_INFO("已发布第%u版: %s (%u个交换机, 耗时 %.1f ms)\n", state->generation,
+             state->output_file, tables.table_count, stats_now_ms() - t_start);
+    return 0;
+}
+
+// ============ 查询套接字 ============
+
+static int watch_listen(const char* socket_path) {
+    struct sockaddr_un addr;
+    struct stat st;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        LOG_ERROR("错误: 套接字路径过长: %s\n", socket_path);
+        return -1;
+    }
+    // 只清理残留的套接字文件，不覆盖其他类型的文件
+    if (lstat(socket_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            LOG_ERROR("错误: %s 已存在且不是套接字\n", socket_path);
+            return -1;
+        }
+        unlink(socket_path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LOG_ERROR("错误: 无法创建套接字: %s\n", strerror(errno));
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        LOG_ERROR("错误: 无法监听 %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 应答与读请求使用同样的超时：客户端不读取应答、套接字缓冲区写满时不能阻塞事件循环，
+// 超时返回 -1，由调用者断开该客户端
+static int send_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = data;
+    double deadline = stats_now_ms() + WATCH_CLIENT_TIMEOUT_MS;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            int remaining = (int)(deadline - stats_now_ms());
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            int ready = remaining > 0 ? poll(&pfd, 1, remaining) : 0;
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready <= 0) {
+                LOG_WARN("警告: 客户端 %d 毫秒内未读取应答，断开连接\n", WATCH_CLIENT_TIMEOUT_MS);
+                return -1;
+            }
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int send_line(int fd, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static int send_line(int fd, const char* fmt, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len <= 0) {
+        return -1;
+    }
+    return send_all(fd, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+}
+
+// 读取一行请求（不含换行），客户端超时或断开时返回 -1
+static int read_request(int fd, char* request, size_t size) {
+    size_t used = 0;
+    while (used + 1 < size) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, WATCH_CLIENT_TIMEOUT_MS) <= 0) {
+            return -1;
+        }
+        ssize_t n = recv(fd, request + used, size - 1 - used, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        used += (size_t)n;
+        request[used] = '\0';
+        char* end = strpbrk(request, "\r\n");
+        if (end) {
+            *end = '\0';
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void send_table(int fd, const watch_state_t* state, uint32_t switch_id) {
+    const switch_table_t* table = NULL;
+    for (uint32_t i = 0; i < state->tables.table_count; i++) {
+        if (state->tables.tables[i].switch_id == switch_id) {
+            table = &state->tables.tables[i];
+            break;
+        }
+    }
+    if (!table) {
+        send_line(fd, "ERR 没有Switch %u\n", switch_id);
+        return;
+    }
+
+    size_t size = sizeof(fpga_dest_entry_t) * table->entry_count;
+    uint8_t* entries = malloc(size ? size : 1);
+    if (!entries) {
+        send_line(fd, "ERR 内存分配失败\n");
+        return;
+    }
+    for (uint32_t i = 0; i < table->entry_count; i++) {
+        fpga_dest_entry_t entry;
+        route_table_pack(table, i, &entry);
+        memcpy(entries + sizeof(entry) * i, &entry, sizeof(entry));
+    }
+    if (send_line(fd, "OK %u %u %zu\n", table->switch_id, table->entry_count, size) == 0) {
+        send_all(fd, entries, size);
+    }
+    free(entries);
+}
+
+static void watch_serve_client(int listen_fd, const watch_state_t* state) {
+    char request[WATCH_REQUEST_MAX];
+    unsigned switch_id;
+    char tail;
+
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    if (read_request(fd, request, sizeof(request)) != 0) {
+        close(fd);
+        return;
+    }
+
+    if (!state->loaded) {
+        send_line(fd, "ERR 尚未生成路由表\n");
+    } else if (strcmp(request, "STATUS") == 0) {
+        uint64_t entries = 0;
+        for (uint32_t i = 0; i < state->tables.table_count; i++) {
+            entries += state->tables.tables[i].entry_count;
+        }
+        send_line(fd, "OK generation=%u switches=%u entries=%llu\n", state->generation,
+                  state->tables.table_count, (unsigned long long)entries);
+    } else if (sscanf(request, "TABLE %u %c", &switch_id, &tail) == 1) {
+        send_table(fd, state, switch_id);
+    } else {
+        send_line(fd, "ERR 未知请求\n");
+    }
+    close(fd);
+}
+
+// ============ 事件循环 ============
+
+// inotify 事件中是否有 YAML 文件本身的写入完成或改名替换
+static bool yaml_changed(int inotify_fd, const char* yaml_name) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+
+    for (;;) {
+        ssize_t len = read(inotify_fd, buf, sizeof(buf));
+        if (len <= 0) {
+            break;
+        }
+        for (char* p = buf; p < buf + len;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len > 0 && strcmp(event->name, yaml_name) == 0) {
+                changed = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+int run_watch_daemon(const char* yaml_file, const char* output_file,
+                     const generate_options_t* options, const char* socket_path,
+                     uint32_t debounce_ms) {
+    watch_state_t state;
+    char* dir_copy = strdup(yaml_file);
+    char* name_copy = strdup(yaml_file);
+    int inotify_fd = -1;
+    int listen_fd = -1;
+    int status = 0;
+
+    memset(&state, 0, sizeof(state));
+    state.yaml_file = yaml_file;
+    state.output_file = output_file;
+    state.options = options;
+    if (!dir_copy || !name_copy) {
+        LOG_ERROR("错误: 内存分配失败\n");
+        status = -1;
+    } else {
+        state.yaml_name = basename(name_copy);
+    }
+
+    if (status == 0) {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0 ||
+            inotify_add_watch(inotify_fd, dirname(dir_copy), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            LOG_ERROR("错误: 无法监视 %s: %s\n", yaml_file, strerror(errno));
+            status = -1;
+        }
+    }
+    if (status == 0) {
+        listen_fd = watch_listen(socket_path);
+        status = listen_fd < 0 ? -1 : 0;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = watch_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // 首次生成失败时仍然常驻，等待拓扑被修正
+    if (status == 0) {
+        LOG_INFO("常驻模式: 监视 %s，查询套接字 %s，防抖 %u ms\n", yaml_file, socket_path, debounce_ms);
+        watch_regenerate(&state);
+    }
+
+    double deadline = -1.0;          // 待执行的重新生成时间（<0 表示没有）
+    while (status == 0 && !watch_stop) {
+        struct pollfd fds[2] = {
+            { inotify_fd, POLLIN, 0 },
+            { listen_fd, POLLIN, 0 }
+        };
+        int timeout = -1;
+        if (deadline >= 0) {
+            double remaining = deadline - stats_now_ms();
+            timeout = remaining > 0 ? (int)remaining + 1 : 0;
+        }
+
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            LOG_ERROR("错误: poll 失败: %s\n", strerror(errno));
+            status = -1;
+            break;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN) && yaml_changed(inotify_fd, state.yaml_name)) {
+            // 每次新变化都推迟，连续保存只触发一次重新生成
+            deadline = stats_now_ms() + debounce_ms;
+        }
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            watch_serve_client(listen_fd, &state);
+        }
+        if (deadline >= 0 && stats_now_ms() >= deadline) {
+            deadline = -1.0;
+            LOG_INFO("\n检测到 %s 变化，重新生成...\n", yaml_file);
+            watch_regenerate(&state);
+        }
+    }
+
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(socket_path);
+    }
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+    if (state.loaded) {
+        free_routing_tables(&state.tables);
+        cleanup_topology(&state.config);
+    }
+    free(dir_copy);
+    free(name_copy);
+    if (status == 0) {
+        LOG_INFO("常驻模式结束 (共发布%u版)\n", state.generation);
+    }
+    return status;
+}
@@ -1,40 +1,196 @@
+#define _POSIX_C_SOURCE 200809L
 #include "../include/yaml2fpga.h"
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// ============ 键分派（按长度 + 首字节，无需拷贝键名）============
+
+typedef enum {
+    KEY_UNKNOWN = 0,
+    KEY_SWITCHES,
+    KEY_ID,
+    KEY_ROOT,
+    KEY_CONNECTIONS,
+    KEY_UP,
+    KEY_HOST_ID,
+    KEY_MY_IP,
+    KEY_MY_MAC,
+    KEY_MY_PORT,
+    KEY_MY_QP,
+    KEY_PEER_IP,
+    KEY_PEER_MAC,
+    KEY_PEER_PORT,
+    KEY_PEER_QP
+} topo_key_t;
+
+// 固定schema的键在 (长度, 区分字节) 上互不冲突，候选唯一后再用 memcmp 确认整个键
+static topo_key_t classify_key(const yaml_event_t* event) {
+    const char* k = (const char*)event->data.scalar.value;
+    size_t len = event->data.scalar.length;
+    const char* name;
+    topo_key_t key;
+
+    switch (len) {
+        case 2:  key = k[0] == 'u' ? KEY_UP : KEY_ID;                          name = k[0] == 'u' ? "up" : "id"; break;
+        case 4:  key = KEY_ROOT;                                               name = "root"; break;
+        case 5:  key = k[3] == 'i' ? KEY_MY_IP : KEY_MY_QP;                    name = k[3] == 'i' ? "my_ip" : "my_qp"; break;
+        case 6:  key = KEY_MY_MAC;                                             name = "my_mac"; break;
+        case 7:
+            switch (k[0] == 'p' ? k[5] : k[0]) {
+                case 'h': key = KEY_HOST_ID; name = "host_id"; break;
+                case 'm': key = KEY_MY_PORT; name = "my_port"; break;
+                case 'i': key = KEY_PEER_IP; name = "peer_ip"; break;
+                default:  key = KEY_PEER_QP; name = "peer_qp"; break;
+            }
+            break;
+        case 8:  key = k[0] == 'p' ? KEY_PEER_MAC : KEY_SWITCHES;              name = k[0] == 'p' ? "peer_mac" : "switches"; break;
+        case 9:  key = KEY_PEER_PORT;                                          name = "peer_port"; break;
+        case 11: key = KEY_CONNECTIONS;                                        name = "connections"; break;
+        default: return KEY_UNKNOWN;
+    }
+
+    return memcmp(k, name, len) == 0 ? key : KEY_UNKNOWN;
+}
+
+// ============ 标量解析（直接解码为二进制字段）============
 
 static int parse_bool(yaml_event_t* event, bool* value) {
     if (event->type == YAML_SCALAR_EVENT) {
-        char* scalar = (char*)event->data.scalar.value;
-        *value = (strcmp(scalar, "true") == 0 || strcmp(scalar, "1") == 0);
+        const char* scalar = (const char*)event->data.scalar.value;
+        size_t len = event->data.scalar.length;
+        *value = (len == 4 && memcmp(scalar, "true", 4) == 0) || (len == 1 && scalar[0] == '1');
         return SUCCESS;
     }
     return ERR_YAML_PARSE;
 }
 
+// 十进制无符号整数，遇到第一个非数字字符停止（与 strtoul 对本schema的行为一致）
 static int parse_uint32(yaml_event_t* event, uint32_t* value) {
     if (event->type == YAML_SCALAR_EVENT) {
-        *value = (uint32_t)strtoul((char*)event->data.scalar.value, NULL, 10);
+        const unsigned char* scalar = event->data.scalar.value;
+        size_t len = event->data.scalar.length;
+        uint32_t result = 0;
+        for (size_t i = 0; i < len && (unsigned)(scalar[i] - '0') < 10; i++) {
+            result = result * 10 + (uint32_t)(scalar[i] - '0');
+        }
+        *value = result;
         return SUCCESS;
     }
     return ERR_YAML_PARSE;
 }
 
-static int parse_string(yaml_event_t* event, char* dest, size_t max_len) {
-    if (event->type == YAML_SCALAR_EVENT) {
-        strncpy(dest, (char*)event->data.scalar.value, max_len - 1);
-        dest[max_len - 1] = '\0';
-        return SUCCESS;
+// ============ 地址解析（手写标量解析，替代sscanf）============
+
+// 十六进制字符 -> 0..15，非法字符返回 0x10 以上的值
+static inline unsigned hex_digit(unsigned char c) {
+    unsigned d = (unsigned)c - '0';
+    unsigned l = ((unsigned)c | 0x20) - 'a';
+    return d < 10 ? d : (l < 6 ? l + 10 : 0x100);
+}
+
+// 点分十进制IPv4 -> 主机序uint32，每段1~3位十进制且不超过255
+static int parse_ipv4(const char* str, size_t len, uint32_t* ip) {
+    uint32_t result = 0;
+    uint32_t octet = 0;
+    unsigned digits = 0;
+    unsigned dots = 0;
+    unsigned bad = (len < 7) | (len > 15);
+
+    for (size_t i = 0; i < len && !bad; i++) {
+        unsigned d = (unsigned)(unsigned char)str[i] - '0';
+        if (d < 10) {
+            octet = octet * 10 + d;
+            digits++;
+            bad |= (digits > 3) | (octet > 255);
+        } else {
+            bad |= (str[i] != '.') | (digits == 0);
+            result = (result << 8) | octet;
+            octet = 0;
+            digits = 0;
+            dots++;
+        }
     }
-    return ERR_YAML_PARSE;
+
+    bad |= (dots != 3) | (digits == 0);
+    if (bad) {
+        return ERR_INVALID_CONFIG;
+    }
+
+    *ip = (result << 8) | octet;
+    return SUCCESS;
+}
+
+// xx:xx:xx:xx:xx:xx -> 6字节（按书写顺序）
+static int parse_mac(const char* str, size_t len, uint8_t* mac) {
+    if (len != 17) {
+        return ERR_INVALID_CONFIG;
+    }
+
+    unsigned bad = 0;
+    for (int i = 0; i < 6; i++) {
+        unsigned hi = hex_digit((unsigned char)str[i * 3]);
+        unsigned lo = hex_digit((unsigned char)str[i * 3 + 1]);
+        bad |= (hi | lo) >> 4;
+        if (i < 5) {
+            bad |= (str[i * 3 + 2] != ':');
+        }
+        mac[i] = (uint8_t)((hi << 4) | (lo & 0xF));
+    }
+
+    return bad ? ERR_INVALID_CONFIG : SUCCESS;
+}
+
+static int parse_ip_field(yaml_event_t* event, const char* key, uint32_t* ip) {
+    if (event->type != YAML_SCALAR_EVENT ||
+        parse_ipv4((const char*)event->data.scalar.value, event->data.scalar.length, ip) != SUCCESS) {
+        LOG_ERROR("错误: 第%zu行: 字段 %s 的IP地址无效: '%s'\n",
+                  event->start_mark.line + 1, key,
+                  event->type == YAML_SCALAR_EVENT ? (const char*)event->data.scalar.value : "");
+        return ERR_INVALID_CONFIG;
+    }
+    return SUCCESS;
 }
 
-static int parse_connection(yaml_parser_t* parser, network_connection_t* conn) {
+static int parse_mac_field(yaml_event_t* event, const char* key, uint8_t* mac) {
+    if (event->type != YAML_SCALAR_EVENT ||
+        parse_mac((const char*)event->data.scalar.value, event->data.scalar.length, mac) != SUCCESS) {
+        LOG_ERROR("错误: 第%zu行: 字段 %s 的MAC地址无效: '%s'\n",
+                  event->start_mark.line + 1, key,
+                  event->type == YAML_SCALAR_EVENT ? (const char*)event->data.scalar.value : "");
+        return ERR_INVALID_CONFIG;
+    }
+    return SUCCESS;
+}
+
+static int parse_uint16(yaml_event_t* event, uint16_t* value) {
+    uint32_t temp = 0;
+    int result = parse_uint32(event, &temp);
+    *value = (uint16_t)temp;
+    return result;
+}
+
+// 读取下一个YAML事件并计数（用于 --stats）
+static int next_event(yaml_parser_t* parser, yaml_event_t* event, topology_config_t* config) {
+    if (!yaml_parser_parse(parser, event)) {
+        LOG_ERROR("错误: 第%zu行: YAML语法错误: %s\n", parser->problem_mark.line + 1,
+                  parser->problem ? parser->problem : "未知错误");
+        return 0;
+    }
+    config->yaml_event_count++;
+    return 1;
+}
+
+static int parse_connection(yaml_parser_t* parser, topology_config_t* config, network_connection_t* conn) {
     yaml_event_t event;
-    char key[64] = {0};
+    int result = SUCCESS;
     
     memset(conn, 0, sizeof(network_connection_t));
     
     while (1) {
-        if (!yaml_parser_parse(parser, &event)) {
+        if (!next_event(parser, &event, config)) {
             return ERR_YAML_PARSE;
         }
         
@@ -44,52 +200,85 @@ static int parse_connection(yaml_parser_t* parser, network_connection_t* conn) {
         }
         
         if (event.type == YAML_SCALAR_EVENT) {
-            strncpy(key, (char*)event.data.scalar.value, sizeof(key) - 1);
+            topo_key_t key = classify_key(&event);
             yaml_event_delete(&event);
             
-            if (!yaml_parser_parse(parser, &event)) {
+            if (!next_event(parser, &event, config)) {
                 return ERR_YAML_PARSE;
             }
             
-            if (strcmp(key, "up") == 0) {
-                bool temp_up = false;
-                parse_bool(&event, &temp_up);
-                conn->up = temp_up ? CONN_UP : CONN_DOWN;
-            } else if (strcmp(key, "host_id") == 0) {
-                parse_uint32(&event, &conn->host_id);
-            } else if (strcmp(key, "my_ip") == 0) {
-                parse_string(&event, conn->my_ip, MAX_IP_ADDR_LEN);
-            } else if (strcmp(key, "my_mac") == 0) {
-                parse_string(&event, conn->my_mac, MAX_MAC_ADDR_LEN);
-            } else if (strcmp(key, "my_port") == 0) {
-                parse_uint32(&event, (uint32_t*)&conn->my_port);
-            } else if (strcmp(key, "my_qp") == 0) {
-                parse_uint32(&event, (uint32_t*)&conn->my_qp);
-            } else if (strcmp(key, "peer_ip") == 0) {
-                parse_string(&event, conn->peer_ip, MAX_IP_ADDR_LEN);
-            } else if (strcmp(key, "peer_mac") == 0) {
-                parse_string(&event, conn->peer_mac, MAX_MAC_ADDR_LEN);
-            } else if (strcmp(key, "peer_port") == 0) {
-                parse_uint32(&event, (uint32_t*)&conn->peer_port);
-            } else if (strcmp(key, "peer_qp") == 0) {
-                parse_uint32(&event, (uint32_t*)&conn->peer_qp);
+            switch (key) {
+                case KEY_UP: {
+                    bool temp_up = false;
+                    parse_bool(&event, &temp_up);
+                    conn->up = temp_up ? CONN_UP : CONN_DOWN;
+                    break;
+                }
+                case KEY_HOST_ID:   parse_uint32(&event, &conn->host_id); break;
+                case KEY_MY_IP:     result = parse_ip_field(&event, "my_ip", &conn->my_ip); break;
+                case KEY_MY_MAC:    result = parse_mac_field(&event, "my_mac", conn->my_mac); break;
+                case KEY_MY_PORT:   parse_uint16(&event, &conn->my_port); break;
+                case KEY_MY_QP:     parse_uint16(&event, &conn->my_qp); break;
+                case KEY_PEER_IP:   result = parse_ip_field(&event, "peer_ip", &conn->peer_ip); break;
+                case KEY_PEER_MAC:  result = parse_mac_field(&event, "peer_mac", conn->peer_mac); break;
+                case KEY_PEER_PORT: parse_uint16(&event, &conn->peer_port); break;
+                case KEY_PEER_QP:   parse_uint16(&event, &conn->peer_qp); break;
+                default: break;
             }
         }
         
         yaml_event_delete(&event);
+
+        if (result != SUCCESS) {
+            return result;
+        }
     }
     
     return SUCCESS;
 }
 
-static int parse_switch(yaml_parser_t* parser, switch_config_t* switch_cfg) {
+// ============ 动态存储 ============
+
+// 在arena中追加一个交换机，容量按倍数增长
+static switch_config_t* append_switch(topology_config_t* config) {
+    if (config->switch_count == config->switch_capacity) {
+        uint32_t capacity = config->switch_capacity ? config->switch_capacity * 2 : 16;
+        switch_config_t* grown = topo_arena_grow(&config->arena, config->switches,
+                                                 sizeof(switch_config_t) * config->switch_capacity,
+                                                 sizeof(switch_config_t) * capacity);
+        if (!grown) {
+            return NULL;
+        }
+        config->switches = grown;
+        config->switch_capacity = capacity;
+    }
+    return &config->switches[config->switch_count];
+}
+
+// 在arena中追加一个连接，容量按倍数增长
+static network_connection_t* append_connection(topology_config_t* config) {
+    if (config->connection_count == config->connection_capacity) {
+        uint32_t capacity = config->connection_capacity ? config->connection_capacity * 2 : 64;
+        network_connection_t* grown = topo_arena_grow(&config->arena, config->connections,
+                                                      sizeof(network_connection_t) * config->connection_capacity,
+                                                      sizeof(network_connection_t) * capacity);
+        if (!grown) {
+            return NULL;
+        }
+        config->connections = grown;
+        config->connection_capacity = capacity;
+    }
+    return &config->connections[config->connection_count];
+}
+
+static int parse_switch(yaml_parser_t* parser, topology_config_t* config, switch_config_t* switch_cfg) {
     yaml_event_t event;
-    char key[64] = {0};
     
     memset(switch_cfg, 0, sizeof(switch_config_t));
+    switch_cfg->connection_offset = config->connection_count;
     
     while (1) {
-        if (!yaml_parser_parse(parser, &event)) {
+        if (!next_event(parser, &event, config)) {
             return ERR_YAML_PARSE;
         }
         
@@ -99,23 +288,25 @@ static int parse_switch(yaml_parser_t* parser, switch_config_t* switch_cfg) {
         }
         
         if (event.type == YAML_SCALAR_EVENT) {
-            strncpy(key, (char*)event.data.scalar.value, sizeof(key) - 1);
+            topo_key_t key = classify_key(&event);
             yaml_event_delete(&event);
             
-            if (!yaml_parser_parse(parser, &event)) {
+            if (!next_event(parser, &event, config)) {
                 return ERR_YAML_PARSE;
             }
             
-            if (strcmp(key, "id") == 0) {
+            if (key == KEY_ID) {
                 parse_uint32(&event, &switch_cfg->id);
-            } else if (strcmp(key, "root") == 0) {
+                yaml_event_delete(&event);
+            } else if (key == KEY_ROOT) {
                 parse_bool(&event, &switch_cfg->is_root);
-            } else if (strcmp(key, "connections") == 0) {
+                yaml_event_delete(&event);
+            } else if (key == KEY_CONNECTIONS) {
                 if (event.type == YAML_SEQUENCE_START_EVENT) {
                     yaml_event_delete(&event);
                     
                     while (1) {
-                        if (!yaml_parser_parse(parser, &event)) {
+                        if (!next_event(parser, &event, config)) {
                             return ERR_YAML_PARSE;
                         }
                         
@@ -127,17 +318,27 @@ static int parse_switch(yaml_parser_t* parser, switch_config_t* switch_cfg) {
                         if (event.type == YAML_MAPPING_START_EVENT) {
                             yaml_event_delete(&event);
                             
-                            if (switch_cfg->connection_count >= MAX_CONNECTIONS_PER_SWITCH) {
+                            network_connection_t* conn = append_connection(config);
+                            if (!conn) {
+                                LOG_ERROR("错误: 内存分配失败\n");
                                 return ERR_INVALID_CONFIG;
                             }
                             
-                            parse_connection(parser, &switch_cfg->connections[switch_cfg->connection_count]);
+                            int result = parse_connection(parser, config, conn);
+                            if (result != SUCCESS) {
+                                return result;
+                            }
+                            config->connection_count++;
                             switch_cfg->connection_count++;
                         } else {
                             yaml_event_delete(&event);
                         }
                     }
+                } else {
+                    yaml_event_delete(&event);
                 }
+            } else {
+                yaml_event_delete(&event);
             }
         } else {
             yaml_event_delete(&event);
@@ -147,27 +348,13 @@ static int parse_switch(yaml_parser_t* parser, switch_config_t* switch_cfg) {
     return SUCCESS;
 }
 
-int parse_yaml_topology(const char* filename, topology_config_t* config) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        return ERR_FILE_NOT_FOUND;
-    }
-    
-    yaml_parser_t parser;
-    if (!yaml_parser_initialize(&parser)) {
-        fclose(file);
-        return ERR_YAML_PARSE;
-    }
-    
-    yaml_parser_set_input_file(&parser, file);
+// 顶层事件循环：读取 switches 序列
+static int parse_topology_events(yaml_parser_t* parser, topology_config_t* config) {
     yaml_event_t event;
-    char key[64] = {0};
     int result = SUCCESS;
     
-    memset(config, 0, sizeof(topology_config_t));
-    
     while (1) {
-        if (!yaml_parser_parse(&parser, &event)) {
+        if (!next_event(parser, &event, config)) {
             result = ERR_YAML_PARSE;
             break;
         }
@@ -178,11 +365,11 @@ int parse_yaml_topology(const char* filename, topology_config_t* config) {
         }
         
         if (event.type == YAML_SCALAR_EVENT) {
-            strncpy(key, (char*)event.data.scalar.value, sizeof(key) - 1);
+            topo_key_t key = classify_key(&event);
             yaml_event_delete(&event);
             
-            if (strcmp(key, "switches") == 0) {
-                if (!yaml_parser_parse(&parser, &event)) {
+            if (key == KEY_SWITCHES) {
+                if (!next_event(parser, &event, config)) {
                     result = ERR_YAML_PARSE;
                     break;
                 }
@@ -191,7 +378,7 @@ int parse_yaml_topology(const char* filename, topology_config_t* config) {
                     yaml_event_delete(&event);
                     
                     while (1) {
-                        if (!yaml_parser_parse(&parser, &event)) {
+                        if (!next_event(parser, &event, config)) {
                             result = ERR_YAML_PARSE;
                             break;
                         }
@@ -204,32 +391,124 @@ int parse_yaml_topology(const char* filename, topology_config_t* config) {
                         if (event.type == YAML_MAPPING_START_EVENT) {
                             yaml_event_delete(&event);
                             
-                            if (config->switch_count >= MAX_SWITCHES) {
+                            switch_config_t* switch_cfg = append_switch(config);
+                            if (!switch_cfg) {
+                                LOG_ERROR("错误: 内存分配失败\n");
                                 result = ERR_INVALID_CONFIG;
                                 break;
                             }
                             
-                            parse_switch(&parser, &config->switches[config->switch_count]);
+                            result = parse_switch(parser, config, switch_cfg);
+                            if (result != SUCCESS) {
+                                break;
+                            }
                             config->switch_count++;
                         } else {
                             yaml_event_delete(&event);
                         }
                     }
+                } else {
+                    yaml_event_delete(&event);
+                }
+
+                if (result != SUCCESS) {
+                    break;
                 }
-            } else {
-                yaml_event_delete(&event);
             }
         } else {
             yaml_event_delete(&event);
         }
     }
     
+    return result;
+}
+
+// 从内存缓冲区解析拓扑（缓冲区在解析期间须保持有效）
+int parse_yaml_topology_buffer(const char* data, size_t len, topology_config_t* config) {
+    yaml_parser_t parser;
+
+    memset(config, 0, sizeof(topology_config_t));
+    if (!yaml_parser_initialize(&parser)) {
+        return ERR_YAML_PARSE;
+    }
+
+    yaml_parser_set_input_string(&parser, (const unsigned char*)data, len);
+    int result = parse_topology_events(&parser, config);
+    yaml_parser_delete(&parser);
+
+    if (result != SUCCESS) {
+        cleanup_topology(config);
+    }
+    return result;
+}
+
+// 从文件解析拓扑：普通文件整体 mmap 后交给 libyaml 直接读取内存，
+// 无法映射的输入（管道、空文件等）退回 stdio 读取
+int parse_yaml_topology(const char* filename, topology_config_t* config) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            close(fd);
+            posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            int result = parse_yaml_topology_buffer(data, (size_t)st.st_size, config);
+            munmap(data, (size_t)st.st_size);
+            return result;
+        }
+    }
+
+    FILE* file = fdopen(fd, "r");
+    if (!file) {
+        close(fd);
+        return ERR_FILE_NOT_FOUND;
+    }
+    
+    yaml_parser_t parser;
+    memset(config, 0, sizeof(topology_config_t));
+    if (!yaml_parser_initialize(&parser)) {
+        fclose(file);
+        return ERR_YAML_PARSE;
+    }
+    
+    yaml_parser_set_input_file(&parser, file);
+    int result = parse_topology_events(&parser, config);
     yaml_parser_delete(&parser);
     fclose(file);
+
+    if (result != SUCCESS) {
+        cleanup_topology(config);
+    }
     
     return result;
 }
-// 打印拓扑摘要
+
+// 基本拓扑验证：至少一个交换机，且有且仅有一个根交换机
+int validate_topology(const topology_config_t* config) {
+    if (!config || config->switch_count == 0) {
+        LOG_ERROR("错误: 拓扑中没有交换机\n");
+        return ERR_INVALID_CONFIG;
+    }
+
+    int root_count = 0;
+    for (uint32_t i = 0; i < config->switch_count; i++) {
+        if (config->switches[i].is_root) {
+            root_count++;
+        }
+    }
+
+    if (root_count != 1) {
+        LOG_ERROR("错误: 必须有且仅有一个根交换机 (找到 %d 个)\n", root_count);
+        return ERR_INVALID_CONFIG;
+    }
+
+    return SUCCESS;
+}
+
 void print_topology_summary(const topology_config_t* config) {
     printf("=== 拓扑摘要 ===\n");
     printf("交换机数量: %u\n", config->switch_count);
@@ -258,6 +537,10 @@ void print_topology_summary(const topology_config_t* config) {
 // 清理拓扑配置
 void cleanup_topology(topology_config_t* config) {
     if (config) {
+        topo_arena_free(&config->arena);
+        if (config->mapping) {
+            munmap(config->mapping, config->mapping_size);
+        }
         memset(config, 0, sizeof(topology_config_t));
     }
 }
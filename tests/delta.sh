@@ -0,0 +1,49 @@
+#!/bin/sh
+# 增量更新流回归：生成新旧镜像和增量更新流，由 test_delta 回放并与完整生成比较
+# 同时在输出目录留下 tb_router_delta.v 使用的三个hex文件（v1镜像，make vtest 读取）
+# 用法: tests/delta.sh bin/yaml2fpga bin/gen_topology bin/test_delta 输出目录
+
+set -u
+YAML2FPGA=$1
+GEN_TOPOLOGY=$2
+TEST_DELTA=$3
+OUT=$4
+mkdir -p "$OUT" || exit 1
+
+# 3层、扇出4、每叶4个Host：根交换机正好64个条目，与 router_searcher 默认的 MAX_ENTRIES 一致
+"$GEN_TOPOLOGY" 3 4 4 "$OUT/old.yaml" 2>/dev/null || exit 1
+
+# 对最后一个叶交换机同时删除、修改和新增Host（与 incremental.sh 相同的连接块定位方式）
+FIRST_HOST=$(grep -n '      - up: false' "$OUT/old.yaml" | tail -n 4 | head -n 1 | cut -d: -f1)
+sed -n "${FIRST_HOST},$((FIRST_HOST + 9))p" "$OUT/old.yaml" |
+    sed -e 's/my_port: .*/my_port: 4900/' -e 's/peer_ip: .*/peer_ip: "10.200.0.2"/' > "$OUT/added.yaml"
+sed -e "${FIRST_HOST},$((FIRST_HOST + 9))d" \
+    -e "$((FIRST_HOST + 16))s/peer_ip: .*/peer_ip: \"10.200.0.1\"/" "$OUT/old.yaml" > "$OUT/new.yaml"
+cat "$OUT/added.yaml" >> "$OUT/new.yaml"
+
+failures=0
+for mode in "" "--image-version 2" "--image-version 2 --compress"; do
+    if ! $YAML2FPGA -q $mode "$OUT/old.yaml" "$OUT/old.bin" ||
+       ! $YAML2FPGA -q $mode --prev-image "$OUT/old.bin" --delta "$OUT/update.delta" \
+            "$OUT/new.yaml" "$OUT/new.bin" ||
+       ! $YAML2FPGA -q $mode "$OUT/new.yaml" "$OUT/full.bin"; then
+        echo "FAIL [$mode] 镜像或增量更新流生成失败"
+        failures=$((failures + 1))
+        continue
+    fi
+    if ! "$TEST_DELTA" "$OUT/old.bin" "$OUT/update.delta" "$OUT/new.bin" "$OUT/full.bin" >/dev/null; then
+        echo "FAIL [$mode] 增量更新流回放结果不一致"
+        failures=$((failures + 1))
+    fi
+done
+
+# tb_router_delta.v 的测试文件
+$YAML2FPGA -q "$OUT/old.yaml" "$OUT/old.bin" &&
+$YAML2FPGA -q --format=hex "$OUT/old.yaml" "$OUT/fpga_routing_old.hex" &&
+$YAML2FPGA -q --format=hex --prev-image "$OUT/old.bin" --delta "$OUT/fpga_routing.delta.hex" \
+    "$OUT/new.yaml" "$OUT/fpga_routing_new.hex" || failures=$((failures + 1))
+
+if [ $failures -ne 0 ]; then
+    exit 1
+fi
+echo "delta: 增量更新流回放后与新镜像逐字节相同、与完整生成转发结果相同 (v1/v2/--compress)"
@@ -0,0 +1,53 @@
+#!/bin/sh
+# 增量重建回归：--prev-topology/--prev-image 的输出必须与完整生成逐字节相同
+# 用 gen_topology 生成胖树，对最后一个叶交换机做修改/新增/删除Host三种改动，
+# 分别在 v1/v2 镜像、--compress、--hash-buckets 下比较
+# 用法: tests/incremental.sh bin/yaml2fpga bin/gen_topology
+
+set -u
+YAML2FPGA=$1
+GEN_TOPOLOGY=$2
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+"$GEN_TOPOLOGY" 3 6 6 "$WORK/base.yaml" 2>/dev/null || exit 1
+
+# 最后一个交换机是叶交换机，其下行连接都是Host；每个连接块为10行
+FIRST_HOST=$(grep -n '      - up: false' "$WORK/base.yaml" | tail -n 6 | head -n 1 | cut -d: -f1)
+
+# 修改Host：最后一个叶交换机的第一个Host换地址
+sed "$((FIRST_HOST + 6))s/peer_ip: .*/peer_ip: \"10.200.0.1\"/" "$WORK/base.yaml" > "$WORK/edit.yaml"
+# 删除Host：去掉该连接块
+sed "${FIRST_HOST},$((FIRST_HOST + 9))d" "$WORK/base.yaml" > "$WORK/remove.yaml"
+# 新增Host：在文件末尾（最后一个交换机）追加一个连接
+cp "$WORK/base.yaml" "$WORK/add.yaml"
+sed -n "${FIRST_HOST},$((FIRST_HOST + 9))p" "$WORK/base.yaml" |
+    sed -e 's/my_port: .*/my_port: 4900/' -e 's/peer_ip: .*/peer_ip: "10.200.0.2"/' >> "$WORK/add.yaml"
+
+failures=0
+for mode in "" "--image-version 2" "--compress" "--image-version 2 --compress" \
+            "--hash-buckets 512" "--image-version 2 --hash-buckets 512"; do
+    # 每种模式先完整生成一次作为上一版镜像
+    if ! $YAML2FPGA -q $mode "$WORK/base.yaml" "$WORK/base.bin"; then
+        echo "FAIL [$mode] 基础镜像生成失败"
+        failures=$((failures + 1))
+        continue
+    fi
+    for change in edit add remove; do
+        $YAML2FPGA -q $mode "$WORK/$change.yaml" "$WORK/full.bin" &&
+        $YAML2FPGA -q $mode --prev-topology "$WORK/base.yaml" --prev-image "$WORK/base.bin" \
+            "$WORK/$change.yaml" "$WORK/incr.bin"
+        if [ $? -ne 0 ] || ! cmp -s "$WORK/full.bin" "$WORK/incr.bin"; then
+            echo "FAIL [$mode] $change: 增量输出与完整生成不一致"
+            failures=$((failures + 1))
+        elif cmp -s "$WORK/base.bin" "$WORK/full.bin"; then
+            echo "FAIL [$mode] $change: 改动没有反映到镜像中"
+            failures=$((failures + 1))
+        fi
+    done
+done
+
+if [ $failures -ne 0 ]; then
+    exit 1
+fi
+echo "incremental: 增量重建与完整生成一致 (3种改动 x 6种模式)"
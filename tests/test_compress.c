@@ -0,0 +1,102 @@
+#include "test_util.h"
+
+// ============ 回归测试：前缀聚合不改变转发结果 ============
+// 用法: test_compress [拓扑YAML]...
+// 对内置的合成胖树和命令行给出的拓扑各生成一份普通镜像和一份 --compress 镜像，
+// 用 y2f_lookup 在每个交换机上查询：普通表中的每个键、键 ±1..±KEY_NEIGHBORS 以及随机地址，
+// 两份镜像给出的转发结果（是否命中、转发方式、出端口和下一跳）必须相同
+
+#define KEY_NEIGHBORS  8
+#define RANDOM_QUERIES 4096
+
+static int compare_images(const char* name, const y2f_topology_t* topology) {
+    y2f_options_t options = {0};
+    uint8_t* plain_image = NULL;
+    uint8_t* packed_image = NULL;
+    size_t plain_size = 0;
+    size_t packed_size = 0;
+    y2f_lookup_t* plain = NULL;
+    y2f_lookup_t* packed = NULL;
+    y2f_error_t error;
+
+    if (build_test_image(topology, &options, NULL, &plain_image, &plain_size) != 0) {
+        return -1;
+    }
+    options.compress = 1;
+    if (build_test_image(topology, &options, NULL, &packed_image, &packed_size) != 0) {
+        free(plain_image);
+        return -1;
+    }
+
+    int status = 0;
+    if (y2f_lookup_open_buffer(plain_image, plain_size, &plain, &error) != Y2F_OK ||
+        y2f_lookup_open_buffer(packed_image, packed_size, &packed, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: 镜像加载失败: %s\n", error.message);
+        status = -1;
+    }
+
+    lookup_pair_t pair = {name, plain, packed, "普通表", "聚合表"};
+    uint64_t queries = 0;
+    uint32_t mismatches = 0;
+    uint32_t plain_entries = 0;
+    uint32_t packed_entries = 0;
+    uint64_t seed = 1;
+    for (uint32_t t = 0; status == 0 && t < y2f_lookup_switch_count(plain); t++) {
+        uint32_t switch_id;
+        uint32_t entry_count;
+        uint32_t packed_id;
+        uint32_t packed_count;
+        y2f_lookup_table_info(plain, t, &switch_id, &entry_count);
+        if (y2f_lookup_table_info(packed, t, &packed_id, &packed_count) != Y2F_OK || packed_id != switch_id) {
+            fprintf(stderr, "FAIL %s: 两份镜像的交换机不一致\n", name);
+            status = -1;
+            break;
+        }
+        plain_entries += entry_count;
+        packed_entries += packed_count;
+
+        mismatches += compare_switch(&pair, switch_id, KEY_NEIGHBORS, RANDOM_QUERIES, &seed, &queries);
+        if (mismatches > 16) {
+            break;
+        }
+    }
+
+    if (status == 0) {
+        printf("%-24s %6u %9u %9u %10llu %9u\n", name, y2f_lookup_switch_count(plain),
+               plain_entries, packed_entries, (unsigned long long)queries, mismatches);
+        status = mismatches == 0 ? 0 : -1;
+    }
+
+    y2f_lookup_close(packed);
+    y2f_lookup_close(plain);
+    free(packed_image);
+    free(plain_image);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    int status = 0;
+
+    printf("%-24s %6s %9s %9s %10s %9s\n", "topology", "sw", "entries", "packed", "queries", "mismatch");
+    for (size_t i = 0; i < test_fat_tree_count; i++) {
+        y2f_topology_t* topology = NULL;
+        char name[64];
+        fat_tree_name(&test_fat_trees[i], name, sizeof(name));
+        if (parse_fat_tree(&test_fat_trees[i], &topology) != 0) {
+            status = -1;
+            continue;
+        }
+        status |= compare_images(name, topology);
+        y2f_topology_free(topology);
+    }
+    for (int i = 1; i < argc; i++) {
+        y2f_topology_t* topology = NULL;
+        if (parse_topology_file(argv[i], &topology) != 0) {
+            status = -1;
+            continue;
+        }
+        status |= compare_images(argv[i], topology);
+        y2f_topology_free(topology);
+    }
+    return status == 0 ? 0 : 1;
+}
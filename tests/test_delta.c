@@ -0,0 +1,256 @@
+#include "yaml2fpga.h"
+#include "test_util.h"
+
+// ============ 回归测试：增量更新流回放 ============
+// 用法: test_delta 旧镜像 增量更新流 新镜像 完整生成的镜像（均为二进制）
+// 按控制面的方式把增量更新流逐条写入旧镜像的路由表（tb_router_delta.v 的C版本），然后检查：
+//   1. 回放结果与同一次生成输出的新镜像逐字节相同
+//   2. 回放结果与不带 --prev-image 完整生成的镜像转发结果相同（槽位不同，逐目的地比较）
+
+#define RANDOM_QUERIES 1024
+
+typedef struct {
+    uint32_t switch_id;
+    uint32_t entry_count;
+    uint8_t* entries;                // entry_count 个打包后的条目
+} replay_table_t;
+
+static void free_replay(replay_table_t* replay, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        free(replay[i].entries);
+    }
+    free(replay);
+}
+
+// 把旧镜像的每张表打包成硬件条目数组，作为回放的初始内容
+static replay_table_t* load_base_tables(const routing_tables_t* tables) {
+    replay_table_t* replay = calloc(tables->table_count + 1, sizeof(replay_table_t));
+    if (!replay) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < tables->table_count; i++) {
+        const switch_table_t* table = &tables->tables[i];
+        replay[i].switch_id = table->switch_id;
+        replay[i].entry_count = table->entry_count;
+        replay[i].entries = calloc(table->entry_count + 1, sizeof(fpga_dest_entry_t));
+        if (!replay[i].entries) {
+            free_replay(replay, i);
+            return NULL;
+        }
+        for (uint32_t e = 0; e < table->entry_count; e++) {
+            route_table_pack(table, e, (fpga_dest_entry_t*)replay[i].entries + e);
+        }
+    }
+    return replay;
+}
+
+// 逐段回放增量更新流：按段头调整表长后把每条写记录写入 addr
+static int apply_delta(replay_table_t* replay, uint32_t table_count, const uint8_t* delta, size_t size) {
+    fpga_delta_header_t header;
+    size_t pos = sizeof(header);
+
+    if (size < sizeof(header)) {
+        fprintf(stderr, "FAIL: 增量更新流过短\n");
+        return -1;
+    }
+    memcpy(&header, delta, sizeof(header));
+    if (header.magic != FPGA_DELTA_MAGIC || header.version != FPGA_DELTA_VERSION) {
+        fprintf(stderr, "FAIL: 增量更新流文件头无效\n");
+        return -1;
+    }
+
+    for (uint32_t s = 0; s < header.switch_count; s++) {
+        fpga_delta_switch_t section;
+        if (size - pos < sizeof(section)) {
+            fprintf(stderr, "FAIL: 增量更新流在第%u段截断\n", s);
+            return -1;
+        }
+        memcpy(&section, delta + pos, sizeof(section));
+        pos += sizeof(section);
+        if ((size - pos) / sizeof(fpga_delta_write_t) < section.write_count) {
+            fprintf(stderr, "FAIL: Switch %u 的写记录截断\n", section.switch_id);
+            return -1;
+        }
+
+        replay_table_t* table = NULL;
+        for (uint32_t i = 0; i < table_count; i++) {
+            if (replay[i].switch_id == section.switch_id) {
+                table = &replay[i];
+            }
+        }
+        if (!table) {
+            fprintf(stderr, "FAIL: 增量更新流中的 Switch %u 不在旧镜像中\n", section.switch_id);
+            return -1;
+        }
+
+        // 表变长时新地址的初始内容为全0（BRAM中的空条目）
+        uint8_t* grown = realloc(table->entries, sizeof(fpga_dest_entry_t) * (section.entry_count + 1));
+        if (!grown) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            return -1;
+        }
+        if (section.entry_count > table->entry_count) {
+            memset(grown + sizeof(fpga_dest_entry_t) * table->entry_count, 0,
+                   sizeof(fpga_dest_entry_t) * (section.entry_count - table->entry_count));
+        }
+        table->entries = grown;
+        uint32_t old_count = table->entry_count;
+        table->entry_count = section.entry_count;
+
+        for (uint32_t w = 0; w < section.write_count; w++) {
+            fpga_delta_write_t write;
+            memcpy(&write, delta + pos, sizeof(write));
+            pos += sizeof(write);
+            // 表缩短时，旧表尾部的有效条目也要失效
+            if (write.addr >= (old_count > table->entry_count ? old_count : table->entry_count)) {
+                fprintf(stderr, "FAIL: Switch %u 的写记录地址 %u 越界\n", section.switch_id, write.addr);
+                return -1;
+            }
+            if (write.addr < table->entry_count) {
+                memcpy(table->entries + sizeof(fpga_dest_entry_t) * write.addr, &write.entry,
+                       sizeof(fpga_dest_entry_t));
+            }
+        }
+    }
+    if (pos != size) {
+        fprintf(stderr, "FAIL: 增量更新流末尾有多余数据\n");
+        return -1;
+    }
+    return 0;
+}
+
+// 回放结果按新镜像的版本序列化
+static int serialize_replay(const replay_table_t* replay, uint32_t table_count, uint32_t image_version,
+                            uint8_t** image, size_t* image_size) {
+    routing_tables_t tables;
+    memset(&tables, 0, sizeof(tables));
+    tables.tables = calloc(table_count + 1, sizeof(switch_table_t));
+    if (!tables.tables) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < table_count; i++) {
+        tables.table_count = i + 1;
+        if (route_table_from_entries(&tables.tables[i], &tables.arena,
+                                     replay[i].entries, replay[i].entry_count) != 0) {
+            free_routing_tables(&tables);
+            return -1;
+        }
+        tables.tables[i].switch_id = replay[i].switch_id;
+    }
+
+    *image_size = routing_image_size(&tables, image_version);
+    *image = malloc(*image_size ? *image_size : 1);
+    if (*image) {
+        serialize_routing_image(&tables, image_version, *image, *image_size);
+    }
+    free_routing_tables(&tables);
+    return *image ? 0 : -1;
+}
+
+// 查询两份镜像中每张表的全部键（含旧镜像中已删除的目的地）和随机地址
+static int compare_with_full(const uint8_t* replayed_image, size_t replayed_size,
+                             const uint8_t* full_image, size_t full_size,
+                             const routing_tables_t* old_tables) {
+    y2f_lookup_t* replayed = NULL;
+    y2f_lookup_t* full = NULL;
+    y2f_error_t error;
+
+    if (y2f_lookup_open_buffer(replayed_image, replayed_size, &replayed, &error) != Y2F_OK ||
+        y2f_lookup_open_buffer(full_image, full_size, &full, &error) != Y2F_OK) {
+        fprintf(stderr, "FAIL: 镜像加载失败: %s\n", error.message);
+        y2f_lookup_close(replayed);
+        return -1;
+    }
+
+    uint32_t mismatches = 0;
+    uint32_t switch_count = y2f_lookup_switch_count(full);
+    if (y2f_lookup_switch_count(replayed) != switch_count) {
+        fprintf(stderr, "FAIL: 回放结果有%u个交换机，完整生成有%u个\n",
+                y2f_lookup_switch_count(replayed), switch_count);
+        mismatches++;
+    }
+
+    lookup_pair_t pair = {"delta", full, replayed, "完整生成", "回放"};
+    uint64_t queries = 0;
+    uint64_t seed = 1;
+    for (uint32_t t = 0; mismatches == 0 && t < switch_count; t++) {
+        uint32_t switch_id;
+        uint32_t entry_count;
+        y2f_lookup_table_info(full, t, &switch_id, &entry_count);
+        mismatches += compare_switch(&pair, switch_id, 0, RANDOM_QUERIES, &seed, &queries);
+        for (uint32_t i = 0; i < old_tables->table_count; i++) {
+            const switch_table_t* table = &old_tables->tables[i];
+            for (uint32_t e = 0; table->switch_id == switch_id && e < table->entry_count; e++) {
+                mismatches += compare_query(&pair, switch_id, table->dst_ip[e]);
+            }
+        }
+    }
+
+    y2f_lookup_close(full);
+    y2f_lookup_close(replayed);
+    return mismatches == 0 ? 0 : -1;
+}
+
+int main(int argc, char* argv[]) {
+    uint8_t* files[4] = {NULL, NULL, NULL, NULL};
+    size_t sizes[4] = {0, 0, 0, 0};
+    routing_tables_t old_tables;
+    uint32_t old_version;
+    uint32_t new_version;
+    int status = 0;
+
+    if (argc != 5) {
+        fprintf(stderr, "用法: %s 旧镜像 增量更新流 新镜像 完整生成的镜像\n", argv[0]);
+        return 1;
+    }
+    yaml2fpga_log_level = LOG_LEVEL_QUIET;
+    for (int i = 0; i < 4; i++) {
+        if (read_file_all(argv[i + 1], &files[i], &sizes[i]) != 0) {
+            status = -1;
+        }
+    }
+    if (status != 0 || parse_routing_image(files[0], sizes[0], &old_tables, &old_version) != 0) {
+        for (int i = 0; i < 4; i++) {
+            free(files[i]);
+        }
+        return 1;
+    }
+
+    // 新镜像只用于取得版本号，回放结果按同一版本序列化后逐字节比较
+    routing_tables_t new_tables;
+    replay_table_t* replay = load_base_tables(&old_tables);
+    uint8_t* replayed_image = NULL;
+    size_t replayed_size = 0;
+    if (!replay || parse_routing_image(files[2], sizes[2], &new_tables, &new_version) != 0) {
+        status = -1;
+    } else {
+        free_routing_tables(&new_tables);
+    }
+
+    if (status == 0 && (apply_delta(replay, old_tables.table_count, files[1], sizes[1]) != 0 ||
+                        serialize_replay(replay, old_tables.table_count, new_version,
+                                         &replayed_image, &replayed_size) != 0)) {
+        status = -1;
+    }
+    if (status == 0 && (replayed_size != sizes[2] || memcmp(replayed_image, files[2], sizes[2]) != 0)) {
+        fprintf(stderr, "FAIL: 回放结果与新镜像 %s 不一致\n", argv[3]);
+        status = -1;
+    }
+    if (status == 0 && compare_with_full(replayed_image, replayed_size, files[3], sizes[3], &old_tables) != 0) {
+        status = -1;
+    }
+    if (status == 0) {
+        printf("delta: %s 回放到 %s 后与 %s 逐字节相同，与完整生成的 %s 转发结果相同\n",
+               argv[2], argv[1], argv[3], argv[4]);
+    }
+
+    free(replayed_image);
+    if (replay) {
+        free_replay(replay, old_tables.table_count);
+    }
+    free_routing_tables(&old_tables);
+    for (int i = 0; i < 4; i++) {
+        free(files[i]);
+    }
+    return status == 0 ? 0 : 1;
+}
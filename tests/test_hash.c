@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include "test_util.h"
+
+// ============ 回归测试：哈希查找表（--hash-buckets）============
+// 用法: test_hash [-o 测试文件目录] [拓扑YAML]...
+//   1. 放不下的表：超过 HASH_MAX_KICKS 次踢出后 place_hash_table 报错，库返回 Y2F_ERR_CAPACITY
+//   2. 排布：每个条目都在 route_hash_bucket 算出的两个桶之一，默认路由在 2N
+//   3. 查找：哈希镜像与普通镜像对每个键、键 ±1..±KEY_NEIGHBORS 和随机地址的转发结果相同
+// 指定 -o 时为 tb_router_hash.v 写出哈希镜像（hex）和若干交换机的期望结果
+
+#define KEY_NEIGHBORS  8
+#define RANDOM_QUERIES 2048
+
+// tb_router_hash.v 的测试拓扑和桶数（与测试平台的默认参数一致）
+#define FIXTURE_BUCKETS 128
+#define FIXTURE_RANDOM  64
+static const fat_tree_params_t fixture_tree = {3, 4, 4};
+static const uint32_t fixture_switches[] = {1, 4, 21};
+
+static uint32_t bucket_bits_of(uint32_t buckets) {
+    uint32_t bits = 0;
+    while ((1u << bits) < buckets) {
+        bits++;
+    }
+    return bits;
+}
+
+// ============ 放不下的表 ============
+
+// 2x2 个桶放5个精确匹配键：必然在踢出上限处失败
+static int test_kick_limit(void) {
+    routing_tables_t tables;
+    switch_table_t* table;
+    uint32_t kicks = 0;
+
+    memset(&tables, 0, sizeof(tables));
+    tables.tables = calloc(1, sizeof(switch_table_t));
+    if (!tables.tables || route_table_alloc(&tables.tables[0], &tables.arena, 5, 1) != 0) {
+        free_routing_tables(&tables);
+        return -1;
+    }
+    tables.table_count = 1;
+    table = &tables.tables[0];
+    table->switch_id = 1;
+    table->entry_count = 5;
+    table->action_count = 1;
+    memset(&table->actions[0], 0, sizeof(route_action_t));
+    for (uint32_t i = 0; i < 5; i++) {
+        table->dst_ip[i] = 0x0A000001u + i;
+        table->action_id[i] = 0;
+        table->flags[i] = ROUTE_FLAG_VALID;
+        table->wildcard[i] = 0;
+    }
+
+    // 收集错误说明而不打印到stderr
+    error_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    pthread_mutex_init(&sink.lock, NULL);
+    yaml2fpga_error_sink = &sink;
+    int result = place_hash_table(table, &tables.arena, 2, &kicks);
+    yaml2fpga_error_sink = NULL;
+    pthread_mutex_destroy(&sink.lock);
+
+    int status = 0;
+    if (result == 0) {
+        fprintf(stderr, "FAIL: 5个键放入了 2x2 个桶\n");
+        status = -1;
+    } else if (kicks < HASH_MAX_KICKS) {
+        fprintf(stderr, "FAIL: 放不下时只踢出了%u次，未到上限%u\n", kicks, HASH_MAX_KICKS);
+        status = -1;
+    } else if (sink.count == 0 || !strstr(sink.message, "--hash-buckets")) {
+        fprintf(stderr, "FAIL: 放不下时没有给出增大 --hash-buckets 的提示\n");
+        status = -1;
+    } else if (table->entry_count != 5 || table->dst_ip[4] != 0x0A000005u) {
+        fprintf(stderr, "FAIL: 排布失败后路由表被修改\n");
+        status = -1;
+    }
+    free_routing_tables(&tables);
+    return status;
+}
+
+// 通过库接口：桶数不足时返回 Y2F_ERR_CAPACITY 和说明
+static int test_capacity_error(const y2f_topology_t* topology) {
+    y2f_options_t options = {0};
+    y2f_tables_t* tables = NULL;
+    y2f_error_t error;
+
+    options.hash_buckets = 2;
+    int result = y2f_tables_build(topology, &options, &tables, &error);
+    y2f_tables_free(tables);
+    if (result != Y2F_ERR_CAPACITY || !strstr(error.message, "--hash-buckets")) {
+        fprintf(stderr, "FAIL: 桶数不足时返回 %d (%s)，期望 Y2F_ERR_CAPACITY\n", result, error.message);
+        return -1;
+    }
+    return 0;
+}
+
+// ============ 排布与查找 ============
+
+static int build_image(const y2f_topology_t* topology, uint32_t buckets, uint32_t format,
+                       y2f_tables_t** tables, uint8_t** image, size_t* image_size) {
+    y2f_options_t options = {0};
+    options.hash_buckets = buckets;
+    options.format = format;
+    return build_test_image(topology, &options, tables, image, image_size);
+}
+
+// 每个有效条目都在它的两个桶之一，默认路由只在 2N
+static uint32_t check_placement(const char* name, const y2f_tables_t* tables, uint32_t buckets) {
+    uint32_t bits = bucket_bits_of(buckets);
+    uint32_t errors = 0;
+    fpga_dest_entry_t* entries = malloc(sizeof(fpga_dest_entry_t) * (buckets * 2 + 1));
+    if (!entries) {
+        return 1;
+    }
+
+    for (uint32_t t = 0; t < y2f_tables_count(tables) && errors == 0; t++) {
+        uint32_t switch_id;
+        uint32_t entry_count;
+        size_t required;
+        y2f_table_info(tables, t, &switch_id, &entry_count);
+        if (entry_count != buckets * 2 + 1 ||
+            y2f_table_entries(tables, t, entries, sizeof(fpga_dest_entry_t) * entry_count, &required, NULL) != Y2F_OK) {
+            fprintf(stderr, "FAIL %s: Switch %u 有%u个条目，期望%u\n", name, switch_id, entry_count, buckets * 2 + 1);
+            errors++;
+            break;
+        }
+        for (uint32_t a = 0; a < entry_count; a++) {
+            const fpga_dest_entry_t* entry = &entries[a];
+            bool ok;
+            if (!entry->valid) {
+                continue;
+            }
+            if (a == buckets * 2) {
+                ok = entry->is_default_route;
+            } else if (a < buckets) {
+                ok = !entry->is_default_route && route_hash_bucket(entry->dst_ip, 0, bits) == a;
+            } else {
+                ok = !entry->is_default_route && route_hash_bucket(entry->dst_ip, 1, bits) == a - buckets;
+            }
+            if (!ok) {
+                fprintf(stderr, "FAIL %s: Switch %u 地址%u的条目 0x%08x 不在它的桶中\n",
+                        name, switch_id, a, entry->dst_ip);
+                errors++;
+            }
+        }
+    }
+    free(entries);
+    return errors;
+}
+
+static int compare_images(const char* name, const y2f_topology_t* topology) {
+    uint32_t buckets = HASH_BUCKETS_MIN;
+    while (buckets < HASH_BUCKETS_MAX && buckets < y2f_topology_host_count(topology) * 2) {
+        buckets <<= 1;
+    }
+
+    y2f_tables_t* plain_tables = NULL;
+    y2f_tables_t* hash_tables = NULL;
+    uint8_t* plain_image = NULL;
+    uint8_t* hash_image = NULL;
+    size_t plain_size = 0;
+    size_t hash_size = 0;
+    if (build_image(topology, 0, Y2F_FORMAT_BIN, &plain_tables, &plain_image, &plain_size) != 0) {
+        return -1;
+    }
+    if (build_image(topology, buckets, Y2F_FORMAT_BIN, &hash_tables, &hash_image, &hash_size) != 0) {
+        y2f_tables_free(plain_tables);
+        free(plain_image);
+        return -1;
+    }
+
+    uint32_t mismatches = check_placement(name, hash_tables, buckets);
+    y2f_lookup_t* plain = NULL;
+    y2f_lookup_t* hashed = NULL;
+    y2f_error_t error;
+    uint64_t queries = 0;
+    uint64_t seed = 1;
+    if (y2f_lookup_open_buffer(plain_image, plain_size, &plain, &error) != Y2F_OK ||
+        y2f_lookup_open_buffer(hash_image, hash_size, &hashed, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: 镜像加载失败: %s\n", error.message);
+        mismatches++;
+    }
+
+    lookup_pair_t pair = {name, plain, hashed, "普通表", "哈希表"};
+    for (uint32_t t = 0; mismatches == 0 && t < y2f_lookup_switch_count(plain); t++) {
+        uint32_t switch_id;
+        uint32_t entry_count;
+        y2f_lookup_table_info(plain, t, &switch_id, &entry_count);
+        mismatches += compare_switch(&pair, switch_id, KEY_NEIGHBORS, RANDOM_QUERIES, &seed, &queries);
+    }
+
+    printf("%-24s %6u %8u %10llu %9u\n", name, y2f_tables_count(hash_tables), buckets,
+           (unsigned long long)queries, mismatches);
+    y2f_lookup_close(hashed);
+    y2f_lookup_close(plain);
+    y2f_tables_free(hash_tables);
+    y2f_tables_free(plain_tables);
+    free(hash_image);
+    free(plain_image);
+    return mismatches == 0 ? 0 : -1;
+}
+
+// ============ tb_router_hash.v 的测试文件 ============
+// hash_expect_<id>.hex：首字为查询数，之后每条查询8个字
+//   [0] dst_ip
+//   [1] bit0 found, bit1 is_default_route, bit2 is_direct_host, bit3 is_broadcast
+//   [2] out_port | out_qp << 16
+//   [3] next_hop_ip
+//   [4] next_hop_port | next_hop_qp << 16
+//   [5] next_hop_mac[31:0]   [6] next_hop_mac[47:32]
+//   [7] 第0路桶号 | 第1路桶号 << 16（C端 route_hash_bucket，与RTL的 hash_bucket 比较）
+// 期望结果来自普通（CAM布局）镜像，与哈希排布无关
+
+static void write_expect_word(FILE* out, uint32_t word) {
+    fprintf(out, "%08x\n", word);
+}
+
+static void write_query(FILE* out, const y2f_lookup_t* plain, uint32_t switch_id, uint32_t dst_ip) {
+    y2f_route_t route;
+    uint32_t bits = bucket_bits_of(FIXTURE_BUCKETS);
+    y2f_lookup(plain, switch_id, dst_ip, &route);
+    write_expect_word(out, dst_ip);
+    write_expect_word(out, route.found | (route.is_default_route << 1) |
+                           (route.is_direct_host << 2) | (route.is_broadcast << 3));
+    write_expect_word(out, route.out_port | ((uint32_t)route.out_qp << 16));
+    write_expect_word(out, route.next_hop_ip);
+    write_expect_word(out, route.next_hop_port | ((uint32_t)route.next_hop_qp << 16));
+    write_expect_word(out, (uint32_t)route.next_hop_mac[0] | ((uint32_t)route.next_hop_mac[1] << 8) |
+                           ((uint32_t)route.next_hop_mac[2] << 16) | ((uint32_t)route.next_hop_mac[3] << 24));
+    write_expect_word(out, (uint32_t)route.next_hop_mac[4] | ((uint32_t)route.next_hop_mac[5] << 8));
+    write_expect_word(out, route_hash_bucket(dst_ip, 0, bits) | (route_hash_bucket(dst_ip, 1, bits) << 16));
+}
+
+static int write_file(const char* dir, const char* name, const void* data, size_t len) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* out = fopen(path, "wb");
+    if (!out || fwrite(data, 1, len, out) != len) {
+        fprintf(stderr, "错误: 无法写入 %s\n", path);
+        if (out) {
+            fclose(out);
+        }
+        return -1;
+    }
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+// 每个交换机查询：全部键（命中）、键+1（多数未命中）和随机地址
+static int write_fixtures(const char* dir, const y2f_topology_t* topology) {
+    y2f_tables_t* plain_tables = NULL;
+    y2f_tables_t* hash_tables = NULL;
+    uint8_t* plain_image = NULL;
+    uint8_t* hash_text = NULL;
+    size_t plain_size = 0;
+    size_t hash_text_size = 0;
+    y2f_lookup_t* plain = NULL;
+    y2f_error_t error;
+    int status = 0;
+
+    if (build_image(topology, 0, Y2F_FORMAT_BIN, &plain_tables, &plain_image, &plain_size) != 0) {
+        return -1;
+    }
+    if (build_image(topology, FIXTURE_BUCKETS, Y2F_FORMAT_HEX, &hash_tables, &hash_text, &hash_text_size) != 0 ||
+        write_file(dir, "fpga_routing_hash.hex", hash_text, hash_text_size) != 0 ||
+        y2f_lookup_open_buffer(plain_image, plain_size, &plain, &error) != Y2F_OK) {
+        status = -1;
+    }
+
+    uint64_t seed = 7;
+    for (size_t s = 0; status == 0 && s < sizeof(fixture_switches) / sizeof(fixture_switches[0]); s++) {
+        uint32_t switch_id = fixture_switches[s];
+        uint32_t index = switch_id - 1;
+        uint32_t entry_id;
+        uint32_t entry_count;
+        char path[4096];
+        if (y2f_lookup_table_info(plain, index, &entry_id, &entry_count) != Y2F_OK || entry_id != switch_id) {
+            fprintf(stderr, "错误: 测试拓扑中没有 Switch %u\n", switch_id);
+            status = -1;
+            break;
+        }
+        snprintf(path, sizeof(path), "%s/hash_expect_%u.hex", dir, switch_id);
+        FILE* out = fopen(path, "w");
+        if (!out) {
+            fprintf(stderr, "错误: 无法写入 %s\n", path);
+            status = -1;
+            break;
+        }
+        write_expect_word(out, entry_count * 2 + FIXTURE_RANDOM);
+        for (uint32_t e = 0; e < entry_count; e++) {
+            y2f_route_t entry;
+            y2f_lookup_entry(plain, switch_id, e, &entry);
+            write_query(out, plain, switch_id, entry.dst_ip);
+            write_query(out, plain, switch_id, entry.dst_ip + 1);
+        }
+        for (uint32_t q = 0; q < FIXTURE_RANDOM; q++) {
+            write_query(out, plain, switch_id, random_query_ip(&seed, q));
+        }
+        if (fclose(out) != 0) {
+            status = -1;
+        }
+    }
+
+    y2f_lookup_close(plain);
+    y2f_tables_free(hash_tables);
+    y2f_tables_free(plain_tables);
+    free(hash_text);
+    free(plain_image);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    const char* fixture_dir = NULL;
+    int argi = 1;
+    int status = 0;
+
+    if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+        fixture_dir = argv[2];
+        argi = 3;
+    }
+    yaml2fpga_log_level = LOG_LEVEL_QUIET;
+
+    status |= test_kick_limit();
+
+    printf("%-24s %6s %8s %10s %9s\n", "topology", "sw", "buckets", "queries", "mismatch");
+    for (size_t i = 0; i < test_fat_tree_count; i++) {
+        y2f_topology_t* topology = NULL;
+        char name[64];
+        fat_tree_name(&test_fat_trees[i], name, sizeof(name));
+        if (parse_fat_tree(&test_fat_trees[i], &topology) != 0) {
+            status = -1;
+            continue;
+        }
+        status |= compare_images(name, topology);
+        status |= test_capacity_error(topology);
+        y2f_topology_free(topology);
+    }
+    for (int i = argi; i < argc; i++) {
+        y2f_topology_t* topology = NULL;
+        if (parse_topology_file(argv[i], &topology) != 0) {
+            status = -1;
+            continue;
+        }
+        status |= compare_images(argv[i], topology);
+        y2f_topology_free(topology);
+    }
+
+    if (fixture_dir) {
+        y2f_topology_t* topology = NULL;
+        if (parse_fat_tree(&fixture_tree, &topology) != 0 || write_fixtures(fixture_dir, topology) != 0) {
+            status = -1;
+        }
+        y2f_topology_free(topology);
+    }
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#define _POSIX_C_SOURCE 200809L
+#include "yaml2fpga.h"
+#include "test_util.h"
+
+const fat_tree_params_t test_fat_trees[] = {
+    {2, 2, 5},       // 10 Host
+    {2, 10, 10},     // 100 Host
+    {3, 10, 10},     // 1000 Host
+};
+const size_t test_fat_tree_count = sizeof(test_fat_trees) / sizeof(test_fat_trees[0]);
+
+// ============ 查询与比较 ============
+
+uint32_t random_query_ip(uint64_t* seed, uint32_t q) {
+    uint64_t r = synth_random(seed);
+    return (q & 1) ? (uint32_t)r : (0x0A000000u | (uint32_t)(r & 0xFFFF));
+}
+
+int same_forwarding(const y2f_route_t* a, const y2f_route_t* b) {
+    return a->found == b->found &&
+           a->is_direct_host == b->is_direct_host &&
+           a->is_broadcast == b->is_broadcast &&
+           a->is_default_route == b->is_default_route &&
+           a->out_port == b->out_port &&
+           a->out_qp == b->out_qp &&
+           a->next_hop_ip == b->next_hop_ip &&
+           a->next_hop_port == b->next_hop_port &&
+           a->next_hop_qp == b->next_hop_qp &&
+           memcmp(a->next_hop_mac, b->next_hop_mac, sizeof(a->next_hop_mac)) == 0;
+}
+
+uint32_t compare_query(const lookup_pair_t* pair, uint32_t switch_id, uint32_t dst_ip) {
+    y2f_route_t a;
+    y2f_route_t b;
+    if (y2f_lookup(pair->expected, switch_id, dst_ip, &a) != Y2F_OK ||
+        y2f_lookup(pair->actual, switch_id, dst_ip, &b) != Y2F_OK || !same_forwarding(&a, &b)) {
+        fprintf(stderr, "FAIL %s: Switch %u, " IP_FMT ": %s found=%u port=%u next_hop=0x%08x, "
+                        "%s found=%u port=%u next_hop=0x%08x (条目%u/%u, 通配%u位)\n",
+                pair->name, switch_id, IP_ARGS(dst_ip),
+                pair->expected_label, a.found, a.out_port, a.next_hop_ip,
+                pair->actual_label, b.found, b.out_port, b.next_hop_ip,
+                a.entry_addr, b.entry_addr, b.prefix_wildcard);
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t compare_switch(const lookup_pair_t* pair, uint32_t switch_id, uint32_t key_neighbors,
+                        uint32_t random_queries, uint64_t* seed, uint64_t* queries) {
+    uint32_t mismatches = 0;
+    uint32_t entry_count = 0;
+
+    for (uint32_t t = 0; t < y2f_lookup_switch_count(pair->expected); t++) {
+        uint32_t id;
+        uint32_t count;
+        y2f_lookup_table_info(pair->expected, t, &id, &count);
+        if (id == switch_id) {
+            entry_count = count;
+        }
+    }
+    // 每个键及其两侧的邻居地址（聚合前缀和哈希桶的边界附近）
+    for (uint32_t e = 0; e < entry_count; e++) {
+        y2f_route_t entry;
+        y2f_lookup_entry(pair->expected, switch_id, e, &entry);
+        for (int32_t d = -(int32_t)key_neighbors; d <= (int32_t)key_neighbors; d++) {
+            mismatches += compare_query(pair, switch_id, entry.dst_ip + (uint32_t)d);
+            (*queries)++;
+        }
+    }
+    for (uint32_t q = 0; q < random_queries; q++) {
+        mismatches += compare_query(pair, switch_id, random_query_ip(seed, q));
+        (*queries)++;
+    }
+    return mismatches;
+}
+
+// ============ 镜像与拓扑来源 ============
+
+int build_test_image(const y2f_topology_t* topology, const y2f_options_t* options,
+                     y2f_tables_t** tables, uint8_t** image, size_t* image_size) {
+    y2f_tables_t* built = NULL;
+    y2f_error_t error;
+
+    if (y2f_tables_build(topology, options, &built, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: 路由表构建失败: %s\n", error.message);
+        return -1;
+    }
+    y2f_image_serialize(built, options, NULL, 0, image_size, &error);
+    *image = malloc(*image_size ? *image_size : 1);
+    int result = *image ? y2f_image_serialize(built, options, *image, *image_size, image_size, &error)
+                        : Y2F_ERR_NOMEM;
+    if (result != Y2F_OK) {
+        fprintf(stderr, "错误: 镜像序列化失败: %s\n", error.message);
+        free(*image);
+        *image = NULL;
+        y2f_tables_free(built);
+        return -1;
+    }
+    if (tables) {
+        *tables = built;
+    } else {
+        y2f_tables_free(built);
+    }
+    return 0;
+}
+
+int parse_fat_tree(const fat_tree_params_t* params, y2f_topology_t** topology) {
+    char* data = NULL;
+    size_t len = 0;
+    y2f_error_t error;
+    FILE* out = open_memstream(&data, &len);
+
+    if (!out) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    int result = write_fat_tree_yaml(out, params);
+    if (fclose(out) != 0 || result != 0 ||
+        y2f_topology_parse(data, len, topology, &error) != Y2F_OK) {
+        fprintf(stderr, "错误: 拓扑生成失败\n");
+        free(data);
+        return -1;
+    }
+    free(data);
+    return 0;
+}
+
+int parse_topology_file(const char* path, y2f_topology_t** topology) {
+    uint8_t* data = NULL;
+    size_t len = 0;
+    y2f_error_t error;
+
+    if (read_file_all(path, &data, &len) != 0) {
+        return -1;
+    }
+    int result = y2f_topology_parse((const char*)data, len, topology, &error);
+    free(data);
+    if (result != Y2F_OK) {
+        fprintf(stderr, "错误: %s 解析失败: %s\n", path, error.message);
+        return -1;
+    }
+    return 0;
+}
+
+void fat_tree_name(const fat_tree_params_t* params, char* name, size_t size) {
+    snprintf(name, size, "fat-tree %u/%u/%u", params->depth, params->fanout, params->hosts_per_leaf);
+}
@@ -0,0 +1,49 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "libyaml2fpga.h"
+#include "topology_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============ 回归测试的公共部分 ============
+// 拓扑来源、镜像生成和两份镜像之间的转发结果比较；各测试程序只保留自己的检查
+
+// 内置的合成胖树（10、100、1000个Host）
+extern const fat_tree_params_t test_fat_trees[];
+extern const size_t test_fat_tree_count;
+
+// 比较的两份镜像：expected 为参照，name 和两个标签用于失败信息
+typedef struct {
+    const char* name;
+    const y2f_lookup_t* expected;
+    const y2f_lookup_t* actual;
+    const char* expected_label;
+    const char* actual_label;
+} lookup_pair_t;
+
+// 第 q 个随机查询地址：偶数次落在拓扑的 10.0.0.0/16 内，奇数次为任意地址
+uint32_t random_query_ip(uint64_t* seed, uint32_t q);
+
+// 只比较转发结果；命中条目的地址、键和通配位数在不同排布下本来就不同
+int same_forwarding(const y2f_route_t* a, const y2f_route_t* b);
+
+// 在一个交换机上比较一次查询，返回不一致的次数（0或1）
+uint32_t compare_query(const lookup_pair_t* pair, uint32_t switch_id, uint32_t dst_ip);
+
+// 比较参照镜像中该交换机的每个键、键 ±key_neighbors 以及 random_queries 个随机地址，
+// 返回不一致的次数，queries 累加查询数
+uint32_t compare_switch(const lookup_pair_t* pair, uint32_t switch_id, uint32_t key_neighbors,
+                        uint32_t random_queries, uint64_t* seed, uint64_t* queries);
+
+// 按 options 构建并序列化；tables 为 NULL 时构建的表随即释放，image 由调用者 free
+int build_test_image(const y2f_topology_t* topology, const y2f_options_t* options,
+                     y2f_tables_t** tables, uint8_t** image, size_t* image_size);
+
+// 解析内存中生成的胖树或YAML文件
+int parse_fat_tree(const fat_tree_params_t* params, y2f_topology_t** topology);
+int parse_topology_file(const char* path, y2f_topology_t** topology);
+void fat_tree_name(const fat_tree_params_t* params, char* name, size_t size);
+
+#endif // TEST_UTIL_H